@@ -0,0 +1,642 @@
+#pragma once
+#include "finite-field.hpp"
+#include "gf1-ntt.hpp"
+#include "identities.hpp"
+#include "matrix.hpp"
+#include "polynomial-gcd.hpp"
+#include "polynomial.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace cherry {
+
+// The addition chain in Itoh-Tsujii inversion. For a in GF(p^n) with n at
+// least 2, this is a^(p + p^2 + ... + p^(n - 1)), built with O(log n)
+// multiplications from b_k = a^(1 + p + ... + p^(k - 1)), using
+// b_2k = b_k (b_k)^(p^k) and b_(k + 1) = a (b_k)^p. frobenius(x, k) has to
+// give x^(p^k).
+template<typename T, typename Multiply, typename Frobenius>
+T itoh_tsujii_chain(const T& a, size_t n, Multiply multiply, Frobenius frobenius) {
+	T b = a;
+	size_t k = 1;
+	size_t target = n - 1;
+	int top_bit = std::bit_width(target) - 1;
+	for (int bit = top_bit - 1; bit >= 0; bit--) {
+		b = multiply(b, frobenius(b, k));
+		k *= 2;
+		if ((target >> bit) & 1) {
+			b = multiply(a, frobenius(b, 1));
+			k++;
+		}
+	}
+	return frobenius(b, 1);
+}
+
+// Everything about GF(p^n) that only depends on the irreducible polynomial.
+// There's exactly one context per (monic) irreducible polynomial for the
+// whole program, so elements only need to keep a pointer to it, and two
+// elements are in the same field exactly when their context pointers match.
+template<uint32_t p>
+class Field_Context {
+public:
+	using Coeffs = std::vector<GF1<p>>;
+
+	// pow only reads the exponent in base p up to here, since it needs a
+	// table of p powers.
+	static constexpr uint32_t frobenius_pow_max_p = 64;
+
+	// Contexts get built the first time a polynomial shows up and stick
+	// around until the program ends. Scaling the polynomial doesn't change
+	// the field, so all its multiples share a context.
+	//
+	// They never get freed, since elements only hold a raw pointer and
+	// there's no telling when the last one is gone. That's nothing for a
+	// handful of fields, but a program that goes through lots of different
+	// polynomials keeps every one of their contexts (and their n x n
+	// matrices) around.
+	static const Field_Context<p> * get(const Polynomial<GF1<p>>& irreducible) {
+		static std::mutex mutex;
+		static std::map<std::vector<uint64_t>, std::unique_ptr<Field_Context<p>>> contexts;
+		Coeffs monic = make_monic(irreducible);
+		std::vector<uint64_t> key;
+		key.reserve(monic.size());
+		for (const auto& coeff : monic) {
+			key.push_back(coeff.get_val());
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		auto& context = contexts[key];
+		if (!context) {
+			context.reset(new Field_Context<p>(std::move(monic)));
+		}
+		return context.get();
+	}
+
+	// n, as in GF(p^n).
+	size_t degree() const {
+		return modulus.size() - 1;
+	}
+
+	// p^n - 1, the order of the multiplicative group, or 0 if it doesn't fit
+	// in 64 bits.
+	uint64_t multiplicative_order_bound() const {
+		unsigned __int128 order = 1;
+		for (size_t i = 0; i < degree(); i++) {
+			order *= p;
+			if (order > UINT64_MAX) {
+				return 0;
+			}
+		}
+		return static_cast<uint64_t>(order - 1);
+	}
+
+	// The irreducible polynomial made monic, from lowest degree to highest.
+	const Coeffs& get_modulus() const {
+		return modulus;
+	}
+
+	Polynomial<GF1<p>> get_irreducible() const {
+		return modulus;
+	}
+
+	// The companion matrix GF_Mat calls lambda.
+	const Matrix<GF1<p>>& get_companion() const {
+		return companion;
+	}
+
+	const Matrix<GF1<p>>& get_identity() const {
+		return identity;
+	}
+
+	// Row i is x^(n + i) mod the modulus for i < n - 1, which is everything a
+	// product of two reduced polynomials needs to get reduced in one pass.
+	const std::vector<Coeffs>& get_reduction_table() const {
+		return reduction_table;
+	}
+
+	// Row i is x^(p^i) mod the modulus for i < n.
+	const std::vector<Coeffs>& get_frobenius_powers() const {
+		return frobenius_powers;
+	}
+
+	// Entry i is Tr(x^i) for i < n, so the trace of any element is a dot
+	// product with its coefficients.
+	const Coeffs& get_traces() const {
+		return traces;
+	}
+
+	// a * b mod the modulus for reduced a and b, the slow and simple way.
+	Coeffs mul_mod(const Coeffs& a, const Coeffs& b) const {
+		size_t n = degree();
+		Coeffs product(2 * n - 1, GF1<p>{0});
+		for (size_t i = 0; i < n; i++) {
+			for (size_t j = 0; j < n; j++) {
+				product[i + j] += a[i] * b[j];
+			}
+		}
+		reduce(product);
+		return product;
+	}
+
+	// Any polynomial mod the modulus, by Horner's rule.
+	Coeffs reduce_poly(const Polynomial<GF1<p>>& vals) const {
+		size_t n = degree();
+		Coeffs out(n, GF1<p>{0});
+		for (size_t i = vals.degree(); i <= vals.degree(); i--) {
+			GF1<p> top = out[n - 1];
+			for (size_t j = n - 1; j > 0; j--) {
+				out[j] = out[j - 1] - top * modulus[j];
+			}
+			out[0] = vals[i] - top * modulus[0];
+		}
+		return out;
+	}
+
+	// The inverse of a reduced polynomial mod the modulus, from inverse_mod,
+	// so big fields get the half GCD.
+	Coeffs inv_mod(const Coeffs& a) const {
+		Coeffs out = inverse_mod(Polynomial<GF1<p>>{ a }, get_irreducible()).to_vector();
+		out.resize(degree(), GF1<p>{0});
+		return out;
+	}
+
+	// a^(p^k). The Frobenius map is linear over GF(p), so this is a few
+	// matrix-vector products, one per bit of k mod n.
+	Coeffs frobenius(Coeffs a, uint64_t k = 1) const {
+		const std::vector<std::vector<Coeffs>>& levels = get_frobenius_maps();
+		k %= degree();
+		for (size_t level = 0; k > 0; level++, k >>= 1) {
+			if (k & 1) {
+				a = apply_map(levels[level], a);
+			}
+		}
+		return a;
+	}
+
+	// a^pow for reduced a. For small p, the exponent gets read in base p,
+	// so every digit costs a Frobenius map and at most one multiplication
+	// instead of log2(p) squarings.
+	Coeffs pow(const Coeffs& a, uint64_t pow) const {
+		size_t n = degree();
+		Coeffs one_v(n, GF1<p>{0});
+		one_v[0] = GF1<p>{1};
+		if (std::all_of(a.begin(), a.end(), [](const GF1<p>& c) { return c == GF1<p>{0}; })) {
+			return pow == 0 ? one_v : a;
+		}
+		uint64_t order = multiplicative_order_bound();
+		if (order != 0) {
+			pow %= order;
+		}
+		if (p > frobenius_pow_max_p || pow < p) {
+			return pow_binary(a, pow);
+		}
+		std::vector<Coeffs> table{ one_v, a };
+		for (uint32_t d = 2; d < p; d++) {
+			table.push_back(mul_mod(table.back(), a));
+		}
+		std::vector<uint32_t> digits;
+		while (pow > 0) {
+			digits.push_back(static_cast<uint32_t>(pow % p));
+			pow /= p;
+		}
+		const std::vector<Coeffs>& frobenius_map = get_frobenius_maps()[0];
+		Coeffs out = table[digits.back()];
+		for (size_t i = digits.size() - 1; i-- > 0;) {
+			out = apply_map(frobenius_map, out);
+			if (digits[i] != 0) {
+				out = mul_mod(out, table[digits[i]]);
+			}
+		}
+		return out;
+	}
+
+	// Itoh-Tsujii inversion. With r = 1 + p + ... + p^(n - 1), a^r is the norm
+	// of a, which is in GF(p), so a^-1 = a^(r - 1) / a^r, and
+	// itoh_tsujii_chain gives a^(r - 1).
+	Coeffs inv_itoh_tsujii(const Coeffs& a) const {
+		size_t n = degree();
+		if (std::all_of(a.begin(), a.end(), [](const GF1<p>& c) { return c == GF1<p>{0}; })) {
+			throw std::domain_error(
+				"Trying to take the multiplicative inverse of "
+				"the additive identity (i.e. dividing by zero)."
+			);
+		}
+		if (n == 1) {
+			return { cherry::inv(a[0]) };
+		}
+		Coeffs almost = itoh_tsujii_chain(a, n,
+			[this](const Coeffs& x, const Coeffs& y) { return mul_mod(x, y); },
+			[this](const Coeffs& x, uint64_t k) { return frobenius(x, k); }
+		);
+		GF1<p> norm = mul_mod(almost, a)[0];
+		GF1<p> norm_inv = cherry::inv(norm);
+		for (auto& coeff : almost) {
+			coeff *= norm_inv;
+		}
+		return almost;
+	}
+
+	// Tr(a) = a + a^p + ... + a^(p^(n - 1)), for a with at most n
+	// coefficients. The trace is linear, so this is just the dot product
+	// with get_traces().
+	GF1<p> trace(const Coeffs& a) const {
+		Accumulator<GF1<p>> sum;
+		for (size_t i = 0; i < a.size() && i < traces.size(); i++) {
+			sum.add_product(a[i], traces[i]);
+		}
+		return sum.result();
+	}
+
+	// N(a) = a a^p ... a^(p^(n - 1)), for a with at most n coefficients. If
+	// the modulus m has roots r_i, then N(a) = a(r_1) ... a(r_n), which is
+	// the resultant of m and a, and the Euclidean algorithm gets that in
+	// O(n^2) operations in GF(p) without ever multiplying in GF(p^n), using
+	//
+	//     res(f, g) = (-1)^(deg f deg g) lead(g)^(deg f - deg r) res(g, r)
+	//
+	// where r = f mod g.
+	GF1<p> norm(const Coeffs& a) const {
+		Coeffs f{ modulus };
+		Coeffs g{ a };
+		trim(g);
+		GF1<p> out{1};
+		while (true) {
+			if (g.empty()) {
+				return GF1<p>{0};
+			}
+			size_t f_degree = f.size() - 1;
+			size_t g_degree = g.size() - 1;
+			GF1<p> lead = g.back();
+			if (g_degree == 0) {
+				return out * lead.pow_u(static_cast<uint32_t>(f_degree));
+			}
+			GF1<p> lead_inv = cherry::inv(lead);
+			while (f.size() >= g.size()) {
+				size_t shift = f.size() - g.size();
+				GF1<p> factor = f.back() * lead_inv;
+				for (size_t i = 0; i < g.size(); i++) {
+					f[shift + i] -= factor * g[i];
+				}
+				trim(f);
+			}
+			size_t r_degree = f.empty() ? 0 : f.size() - 1;
+			if (f_degree % 2 == 1 && g_degree % 2 == 1) {
+				out = -out;
+			}
+			if (!f.empty()) {
+				out *= lead.pow_u(static_cast<uint32_t>(f_degree - r_degree));
+			}
+			std::swap(f, g);
+		}
+	}
+
+	// Whether a is in GF(p^d), the subfield fixed by x -> x^(p^d). d has to
+	// divide n.
+	bool is_in_subfield(const Coeffs& a, size_t d) const {
+		size_t n = degree();
+		check_subfield_degree(d);
+		if (d == n) {
+			return true;
+		}
+		if (d == 1) {
+			return std::all_of(a.begin() + std::min<size_t>(a.size(), 1), a.end(), [](const GF1<p>& c) { return c == GF1<p>{0}; });
+		}
+		Coeffs padded{ a };
+		padded.resize(n, GF1<p>{0});
+		return frobenius(padded, d) == padded;
+	}
+
+	// GF(p^d) as a field of its own, with the modulus of some element b that
+	// generates it, along with what it takes to write elements of GF(p^d) in
+	// terms of 1, b, ..., b^(d - 1).
+	struct Subfield {
+		Polynomial<GF1<p>> modulus;
+		// b^i in GF(p^n).
+		std::vector<Coeffs> powers;
+		// If a = c_0 + c_1 b + ..., then c = sum over k of a[pivots[k]] solve[k].
+		std::vector<size_t> pivots;
+		std::vector<Coeffs> solve;
+	};
+
+	// Built the first time each d gets asked for.
+	const Subfield& get_subfield(size_t d) const {
+		check_subfield_degree(d);
+		std::lock_guard<std::mutex> lock(subfields_mutex);
+		auto& subfield = subfields[d];
+		if (!subfield) {
+			subfield = build_subfield(d);
+		}
+		return *subfield;
+	}
+
+	// The coefficients of a in GF(p^d) over get_subfield(d).modulus.
+	Coeffs to_subfield(const Coeffs& a, size_t d) const {
+		if (!is_in_subfield(a, d)) {
+			throw std::domain_error("This element isn't in the subfield.");
+		}
+		const Subfield& subfield = get_subfield(d);
+		Coeffs out(d, GF1<p>{0});
+		for (size_t k = 0; k < d; k++) {
+			GF1<p> c = subfield.pivots[k] < a.size() ? a[subfield.pivots[k]] : GF1<p>{0};
+			if (c == GF1<p>{0}) {
+				continue;
+			}
+			for (size_t i = 0; i < d; i++) {
+				out[i] += c * subfield.solve[k][i];
+			}
+		}
+		return out;
+	}
+
+	// The other way around, from coefficients over get_subfield(d).modulus
+	// back to GF(p^n).
+	Coeffs from_subfield(const Coeffs& c, size_t d) const {
+		const Subfield& subfield = get_subfield(d);
+		Coeffs out(degree(), GF1<p>{0});
+		for (size_t i = 0; i < c.size() && i < d; i++) {
+			for (size_t j = 0; j < out.size(); j++) {
+				out[j] += c[i] * subfield.powers[i][j];
+			}
+		}
+		return out;
+	}
+
+	// Reduces a polynomial with at most 2n - 1 coefficients in place using
+	// the reduction table, leaving n coefficients.
+	void reduce(Coeffs& product) const {
+		size_t n = degree();
+		for (size_t i = n; i < product.size(); i++) {
+			const GF1<p> top = product[i];
+			if (top == GF1<p>{0}) {
+				continue;
+			}
+			const Coeffs& row = reduction_table[i - n];
+			for (size_t j = 0; j < n; j++) {
+				product[j] += top * row[j];
+			}
+		}
+		product.resize(n, GF1<p>{0});
+	}
+private:
+	Field_Context(Coeffs monic) :
+		modulus(std::move(monic)),
+		companion(GF1<p>{0}, degree()),
+		identity(GF1<p>{0}, degree())
+	{
+		size_t n = degree();
+		companion.to_nilpotent_diag(1);
+		for (size_t i = 0; i < n; i++) {
+			companion(n - i - 1, 0) = -modulus[i];
+		}
+		identity.to_identity();
+
+		// x^n = -(m_0 + ... + m_{n - 1} x^{n - 1}), and each row after that
+		// is the one before times x.
+		Coeffs power(n);
+		for (size_t i = 0; i < n; i++) {
+			power[i] = -modulus[i];
+		}
+		for (size_t i = 0; i + 1 < n; i++) {
+			reduction_table.push_back(power);
+			GF1<p> top = power[n - 1];
+			for (size_t j = n - 1; j > 0; j--) {
+				power[j] = power[j - 1] - top * modulus[j];
+			}
+			power[0] = -(top * modulus[0]);
+		}
+
+		// x^(p^(i + 1)) = (x^(p^i))^p.
+		Coeffs x(n, GF1<p>{0});
+		if (n > 1) {
+			x[1] = GF1<p>{1};
+		} else {
+			x[0] = -modulus[0];
+		}
+		frobenius_powers.push_back(x);
+		for (size_t i = 1; i < n; i++) {
+			frobenius_powers.push_back(pow_binary(frobenius_powers.back(), p));
+		}
+
+		// Tr(x^k) is the sum of the kth powers of the roots of the modulus,
+		// so Newton's identities give
+		//
+		//     Tr(x^k) = -(k m_(n - k) + sum over 0 < i < k of m_(n - i) Tr(x^(k - i))).
+		traces.push_back(GF1<p>{n % p});
+		for (size_t k = 1; k < n; k++) {
+			GF1<p> sum = GF1<p>{k % p} * modulus[n - k];
+			for (size_t i = 1; i < k; i++) {
+				sum += modulus[n - i] * traces[k - i];
+			}
+			traces.push_back(-sum);
+		}
+	}
+
+	void check_subfield_degree(size_t d) const {
+		if (d == 0 || degree() % d != 0) {
+			throw std::invalid_argument("GF(p^d) is only a subfield of GF(p^n) when d divides n.");
+		}
+	}
+
+	// b is the trace of a random element down to GF(p^d), which is in
+	// GF(p^d) and usually generates it, which it does exactly when
+	// b^(p^(d / r)) isn't b for every prime r dividing d. Then its modulus
+	// is (X - b)(X - b^p)...(X - b^(p^(d - 1))), and row reducing 1, b, ...,
+	// b^(d - 1) picks out d coefficients that are enough to find the rest.
+	std::unique_ptr<Subfield> build_subfield(size_t d) const {
+		size_t n = degree();
+		std::vector<size_t> prime_factors;
+		for (size_t r = 2, left = d; left > 1; r++) {
+			if (left % r == 0) {
+				prime_factors.push_back(r);
+				while (left % r == 0) {
+					left /= r;
+				}
+			}
+		}
+		uint64_t seed = 0x9e3779b97f4a7c15;
+		Coeffs b;
+		while (true) {
+			Coeffs c(n);
+			for (auto& coeff : c) {
+				coeff = GF1<p>{next_random(seed) % p};
+			}
+			b = c;
+			for (size_t j = 1; j < n / d; j++) {
+				Coeffs conjugate = frobenius(c, j * d);
+				for (size_t i = 0; i < n; i++) {
+					b[i] += conjugate[i];
+				}
+			}
+			if (std::all_of(prime_factors.begin(), prime_factors.end(), [&](size_t r) { return !(frobenius(b, d / r) == b); })) {
+				break;
+			}
+		}
+
+		auto out = std::make_unique<Subfield>();
+		Coeffs one_v(n, GF1<p>{0});
+		one_v[0] = GF1<p>{1};
+		// The modulus, with coefficients in GF(p^n) until the end.
+		std::vector<Coeffs> product{ one_v };
+		Coeffs conjugate = b;
+		for (size_t i = 0; i < d; i++) {
+			std::vector<Coeffs> next(product.size() + 1, Coeffs(n, GF1<p>{0}));
+			for (size_t j = 0; j < product.size(); j++) {
+				Coeffs term = mul_mod(product[j], conjugate);
+				for (size_t k = 0; k < n; k++) {
+					next[j + 1][k] += product[j][k];
+					next[j][k] -= term[k];
+				}
+			}
+			product = std::move(next);
+			conjugate = frobenius(conjugate, 1);
+		}
+		std::vector<GF1<p>> modulus_coeffs;
+		for (const auto& coeff : product) {
+			modulus_coeffs.push_back(coeff[0]);
+		}
+		out->modulus = modulus_coeffs;
+
+		out->powers.push_back(one_v);
+		for (size_t i = 1; i < d; i++) {
+			out->powers.push_back(mul_mod(out->powers.back(), b));
+		}
+		// Gauss-Jordan on the powers, keeping track of the row operations.
+		std::vector<Coeffs> rows{ out->powers };
+		std::vector<Coeffs> ops(d, Coeffs(d, GF1<p>{0}));
+		for (size_t i = 0; i < d; i++) {
+			ops[i][i] = GF1<p>{1};
+		}
+		size_t column = 0;
+		for (size_t k = 0; k < d; k++, column++) {
+			size_t pivot = k;
+			while (true) {
+				for (pivot = k; pivot < d && rows[pivot][column] == GF1<p>{0}; pivot++) {}
+				if (pivot < d) {
+					break;
+				}
+				column++;
+			}
+			std::swap(rows[k], rows[pivot]);
+			std::swap(ops[k], ops[pivot]);
+			GF1<p> scale = cherry::inv(rows[k][column]);
+			for (auto& c : rows[k]) {
+				c *= scale;
+			}
+			for (auto& c : ops[k]) {
+				c *= scale;
+			}
+			for (size_t i = 0; i < d; i++) {
+				GF1<p> factor = rows[i][column];
+				if (i == k || factor == GF1<p>{0}) {
+					continue;
+				}
+				for (size_t j = 0; j < n; j++) {
+					rows[i][j] -= factor * rows[k][j];
+				}
+				for (size_t j = 0; j < d; j++) {
+					ops[i][j] -= factor * ops[k][j];
+				}
+			}
+			out->pivots.push_back(column);
+		}
+		out->solve = std::move(ops);
+		return out;
+	}
+
+	// Level j is the matrix of a -> a^(p^(2^j)), stored as its columns. They
+	// take O(n^3 log n) to build, so they only get built when they're needed.
+	const std::vector<std::vector<Coeffs>>& get_frobenius_maps() const {
+		std::call_once(frobenius_maps_built, [this]() {
+			size_t n = degree();
+			Coeffs x(n, GF1<p>{0});
+			x[0] = GF1<p>{1};
+			Coeffs x_to_p = pow_binary(frobenius_powers[0], p);
+			std::vector<Coeffs> columns{ x };
+			for (size_t i = 1; i < n; i++) {
+				columns.push_back(mul_mod(columns.back(), x_to_p));
+			}
+			frobenius_maps.push_back(std::move(columns));
+			for (size_t level = 1; (size_t{1} << level) < n; level++) {
+				const std::vector<Coeffs>& previous = frobenius_maps.back();
+				std::vector<Coeffs> next;
+				next.reserve(n);
+				for (const auto& column : previous) {
+					next.push_back(apply_map(previous, column));
+				}
+				frobenius_maps.push_back(std::move(next));
+			}
+		});
+		return frobenius_maps;
+	}
+
+	Coeffs apply_map(const std::vector<Coeffs>& columns, const Coeffs& a) const {
+		size_t n = degree();
+		Coeffs out(n, GF1<p>{0});
+		for (size_t i = 0; i < n; i++) {
+			if (a[i] == GF1<p>{0}) {
+				continue;
+			}
+			for (size_t j = 0; j < n; j++) {
+				out[j] += a[i] * columns[i][j];
+			}
+		}
+		return out;
+	}
+
+	static Coeffs make_monic(const Polynomial<GF1<p>>& irreducible) {
+		size_t degree = irreducible.degree();
+		while (degree > 0 && irreducible[degree] == GF1<p>{0}) {
+			degree--;
+		}
+		if (degree == 0) {
+			throw std::invalid_argument("An irreducible polynomial has to have degree at least 1.");
+		}
+		GF1<p> lead_inv = cherry::inv(irreducible[degree]);
+		Coeffs out;
+		out.reserve(degree + 1);
+		for (size_t i = 0; i <= degree; i++) {
+			out.push_back(irreducible[i] * lead_inv);
+		}
+		return out;
+	}
+
+	static void trim(Coeffs& coeffs) {
+		while (!coeffs.empty() && coeffs.back() == GF1<p>{0}) {
+			coeffs.pop_back();
+		}
+	}
+
+	Coeffs pow_binary(const Coeffs& base, uint64_t pow) const {
+		Coeffs out(degree(), GF1<p>{0});
+		out[0] = GF1<p>{1};
+		Coeffs square{ base };
+		while (pow > 0) {
+			if (pow & 1) {
+				out = mul_mod(out, square);
+			}
+			pow >>= 1;
+			if (pow > 0) {
+				square = mul_mod(square, square);
+			}
+		}
+		return out;
+	}
+
+	Coeffs modulus;
+	Matrix<GF1<p>> companion;
+	Matrix<GF1<p>> identity;
+	std::vector<Coeffs> reduction_table;
+	std::vector<Coeffs> frobenius_powers;
+	Coeffs traces;
+	mutable std::once_flag frobenius_maps_built;
+	mutable std::vector<std::vector<Coeffs>> frobenius_maps;
+	mutable std::mutex subfields_mutex;
+	mutable std::map<size_t, std::unique_ptr<Subfield>> subfields;
+};
+
+}
@@ -3,10 +3,13 @@
 #include "division-ring.hpp"
 #include "identities.hpp"
 #include "remove-v-tables.hpp"
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <stdexcept>
 #include <type_traits>
 #include <string>
+#include <vector>
 
 namespace cherry {
 
@@ -26,19 +29,207 @@ namespace cherry {
 		>::type \
 	>::type
 
+// GF1<p> keeps a table of every inverse for primes up to this size so that
+// division is a single load.
+#ifndef GF1_INVERSE_TABLE_LIMIT
+#define GF1_INVERSE_TABLE_LIMIT 65536
+#endif
+
+// Tables for primes up to this size get built at compile time. Anything
+// bigger costs the compiler a few seconds per instantiation, so those tables
+// get built the first time something gets inverted instead.
+#ifndef GF1_CONSTEXPR_INVERSE_TABLE_LIMIT
+#define GF1_CONSTEXPR_INVERSE_TABLE_LIMIT 4096
+#endif
+
+// Modular exponentiation that works for any 64-bit modulus, used for the
+// Miller-Rabin test below.
+constexpr uint64_t pow_mod_64(uint64_t base, uint64_t pow, uint64_t mod) {
+	uint64_t out = 1 % mod;
+	base %= mod;
+	while (pow > 0) {
+		if (pow & 1) {
+			out = static_cast<uint64_t>(static_cast<unsigned __int128>(out) * base % mod);
+		}
+		base = static_cast<uint64_t>(static_cast<unsigned __int128>(base) * base % mod);
+		pow >>= 1;
+	}
+	return out;
+}
+
+// Trial division by numbers of the form 6k +/- 1. For a 32-bit number, that's
+// about 22000 steps, which the compiler gets through without noticing. Past
+// 32 bits, it switches to Miller-Rabin with the first twelve primes as bases,
+// which is known to be exact for every 64-bit number.
+constexpr bool is_prime(uint64_t n) {
+	if (n < 2) {
+		return false;
+	}
+	if (n < 4) {
+		return true;
+	}
+	if (n % 2 == 0 || n % 3 == 0) {
+		return false;
+	}
+	if (n <= UINT32_MAX) {
+		for (uint64_t i = 5; i * i <= n; i += 6) {
+			if (n % i == 0 || n % (i + 2) == 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+	uint64_t d = n - 1;
+	int s = 0;
+	while (d % 2 == 0) {
+		d /= 2;
+		s++;
+	}
+	for (uint64_t a : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+		uint64_t x = pow_mod_64(a, d, n);
+		if (x == 1 || x == n - 1) {
+			continue;
+		}
+		bool composite = true;
+		for (int r = 1; r < s && composite; r++) {
+			x = static_cast<uint64_t>(static_cast<unsigned __int128>(x) * x % n);
+			composite = x != n - 1;
+		}
+		if (composite) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Reduction policies for GF1<p>. Each one decides how a representative is
+// stored and how the product of two representatives gets brought back into
+// [0, p). All three keep their representatives in [0, p), so addition and
+// subtraction look the same no matter which policy you pick.
+//
+// Modulo_Reduction is the hardware % and stores the value as is.
+template<uint32_t p>
+struct Modulo_Reduction {
+	static constexpr uint64_t to_repr(uint64_t v) {
+		return v % p;
+	}
+
+	static constexpr uint64_t from_repr(uint64_t v) {
+		return v;
+	}
+
+	// v < 2p
+	static constexpr uint64_t reduce_sum(uint64_t v) {
+		return v % p;
+	}
+
+	// v < p^2
+	static constexpr uint64_t reduce_product(uint64_t v) {
+		return v % p;
+	}
+};
+
+// Barrett_Reduction also stores the value as is, but replaces the divide with
+// a multiplication by a reciprocal computed at compile time. If the product of
+// two representatives fits in 32 bits, we only need a 64-bit multiply.
+template<uint32_t p>
+struct Barrett_Reduction {
+	static constexpr unsigned int shift = p <= UINT16_MAX ? 32 : 64;
+
+	static constexpr uint64_t reciprocal = shift == 32
+		? (uint64_t{1} << 32) / p
+		: UINT64_MAX / p;
+
+	static constexpr uint64_t to_repr(uint64_t v) {
+		return v % p;
+	}
+
+	static constexpr uint64_t from_repr(uint64_t v) {
+		return v;
+	}
+
+	static constexpr uint64_t reduce_sum(uint64_t v) {
+		return v >= p ? v - p : v;
+	}
+
+	static constexpr uint64_t reduce_product(uint64_t v) {
+		uint64_t q;
+		if constexpr (shift == 32) {
+			q = (v * reciprocal) >> 32;
+		} else {
+			q = static_cast<uint64_t>(
+				(static_cast<unsigned __int128>(v) * reciprocal) >> 64
+			);
+		}
+		// The reciprocal is rounded down, so q is at most one too small.
+		return reduce_sum(v - q * p);
+	}
+};
+
+// Montgomery_Reduction stores a * 2^32 mod p instead of a, which means the
+// conversion only happens when you construct an element or read its value
+// back out. Every product in between is reduced with two multiplies and a
+// shift. It needs p to be odd.
 template<uint32_t p>
-class GF1 COLON_IN_CLASS_INHERITANCE DIVISION_RING(GF1<p>) {
+struct Montgomery_Reduction {
+	static_assert(p % 2 == 1, "Montgomery reduction needs an odd modulus.");
+
+	// -p^-1 mod 2^32 isn't needed because we use the signed variant, which
+	// subtracts m p instead of adding it and so can't overflow 64 bits.
+	static constexpr uint32_t p_inv = [] {
+		uint32_t x = p;
+		for (int i = 0; i < 5; i++) {
+			x *= 2 - p * x;
+		}
+		return x;
+	}();
+
+	static constexpr uint64_t r_mod_p = (uint64_t{1} << 32) % p;
+	static constexpr uint64_t r2_mod_p = r_mod_p * r_mod_p % p;
+
+	// v < p 2^32
+	static constexpr uint64_t redc(uint64_t v) {
+		uint32_t m = static_cast<uint32_t>(v) * p_inv;
+		uint64_t v_hi = v >> 32;
+		uint64_t mp_hi = (static_cast<uint64_t>(m) * p) >> 32;
+		return v_hi >= mp_hi ? v_hi - mp_hi : v_hi - mp_hi + p;
+	}
+
+	static constexpr uint64_t to_repr(uint64_t v) {
+		return redc(v % p * r2_mod_p);
+	}
+
+	static constexpr uint64_t from_repr(uint64_t v) {
+		return redc(v);
+	}
+
+	static constexpr uint64_t reduce_sum(uint64_t v) {
+		return v >= p ? v - p : v;
+	}
+
+	static constexpr uint64_t reduce_product(uint64_t v) {
+		return redc(v);
+	}
+};
+
+template<uint32_t p, template<uint32_t> typename Reduction = Modulo_Reduction>
+class GF1 COLON_IN_CLASS_INHERITANCE DIVISION_RING(GF1<p COMMA Reduction>) {
+	static_assert(is_prime(p), "GF1<p> is only a field when p is prime.");
 public:
-	GF1(uint64_t v) : val(v % p) {}
+	using GF1s = GF1<p, Reduction>;
+	using Reduction_Policy = Reduction<p>;
+
+	GF1(uint64_t v) : val(Reduction_Policy::to_repr(v)) {}
 	GF1() : val{0} {}
 
-	GF1<p> operator+(const GF1<p>& other) const OVERRIDE {
-		return (val + other.val) % p;
+	GF1s operator+(const GF1s& other) const OVERRIDE {
+		return from_repr(Reduction_Policy::reduce_sum(val + other.val));
 	}
 
-	GF1<p>& operator+=(const GF1<p>& other) OVERRIDE {
-		val += other.val;
-		val %= p;									// Ol' Reliable
+	GF1s& operator+=(const GF1s& other) OVERRIDE {
+		val = Reduction_Policy::reduce_sum(val + other.val);
+		// Tried for Modulo_Reduction:
+		// val %= p;									// Ol' Reliable
 		// val -= p & -(val >= p);						// Fastest, but may not
 		// 												   be for larger ints
 		// const MAX_TYPE(p) diff[]{ 0, p };			// Trash
@@ -50,69 +241,86 @@ public:
 		return *this;
 	}
 
-	GF1<p> operator-() const OVERRIDE {
-		return p - val;
+	GF1s operator-() const OVERRIDE {
+		return from_repr(Reduction_Policy::reduce_sum(p - val));
 	}
 
 	void negate() OVERRIDE {
-		val = p - val;
+		val = Reduction_Policy::reduce_sum(p - val);
 	}
 
-	GF1<p> operator-(const GF1<p>& other) const OVERRIDE {
-		return 2 * p + val - other.val;
+	GF1s operator-(const GF1s& other) const OVERRIDE {
+		return from_repr(Reduction_Policy::reduce_sum(p + val - other.val));
 	}
 
-	GF1<p>& operator-=(const GF1<p>& other) OVERRIDE {
-		val += p - other.val;
-		val %= p;
+	GF1s& operator-=(const GF1s& other) OVERRIDE {
+		val = Reduction_Policy::reduce_sum(p + val - other.val);
 		// val -= p & -(val >= p);
 		return *this;
 	}
 
-	GF1<p> operator*(const GF1<p>& other) const OVERRIDE {
-		return val * other.val;
+	GF1s operator*(const GF1s& other) const OVERRIDE {
+		return from_repr(
+			Reduction_Policy::reduce_product(static_cast<uint64_t>(val) * other.val)
+		);
 	}
 
-	GF1<p>& operator*=(const GF1<p>& other) OVERRIDE {
-		val *= other.val;
-		val %= p;
+	GF1s& operator*=(const GF1s& other) OVERRIDE {
+		val = Reduction_Policy::reduce_product(static_cast<uint64_t>(val) * other.val);
 		return *this;
 	}
 
-	GF1<p> operator/(const GF1<p>& other) const OVERRIDE {
-		return *this * (other^-1);
+	GF1s operator/(const GF1s& other) const OVERRIDE {
+		return *this * other.inv();
 	}
 
-	GF1<p>& operator/=(const GF1<p>& other) OVERRIDE {
-		*this *= (other^-1);
+	GF1s& operator/=(const GF1s& other) OVERRIDE {
+		*this *= other.inv();
 		return *this;
 	}
 
-	GF1<p> inv() const OVERRIDE {
-		return (*this)^-1;
+	GF1s inv() const OVERRIDE {
+		if constexpr (has_inverse_table) {
+			if (val == 0) {
+				throw std::domain_error(
+					"Trying to take the multiplicative inverse of "
+					"the additive identity (i.e. dividing by zero)."
+				);
+			}
+			return from_repr(inverse_of_repr(val));
+		} else {
+			return (*this)^-1;
+		}
 	}
 
-	GF1<p> operator^(int pow) const OVERRIDE {
+	GF1s operator^(int pow) const OVERRIDE {
 		if (pow < 0 && val == 0) {
 			throw std::domain_error(
 				"Trying to take the multiplicative inverse of "
 				"the additive identity (i.e. dividing by zero)."
 			);
 		}
-		pow %= p - 1;
-		if (pow < 0) {
-			pow += p;
+		if constexpr (has_inverse_table) {
+			if (pow < 0) {
+				return inv().pow_u(static_cast<uint32_t>(-static_cast<int64_t>(pow) % (p - 1)));
+			}
 		}
-		return pow_u(pow);
+		// Has to be done in signed arithmetic, otherwise pow gets converted
+		// to unsigned before the modulo and negative powers come out wrong.
+		int64_t reduced = pow % static_cast<int64_t>(p - 1);
+		if (reduced < 0) {
+			reduced += p - 1;
+		}
+		return pow_u(static_cast<uint32_t>(reduced));
 	}
 
-	GF1<p> pow_u(uint32_t pow) const OVERRIDE {
-		if (val <= 1) {
-			return val;
+	GF1s pow_u(uint32_t pow) const OVERRIDE {
+		if (val == 0 || val == one_repr) {
+			return *this;
 		}
 		pow %= p - 1;
-		GF1<p> out = 1;
-		GF1<p> val_pow = val;
+		GF1s out = 1;
+		GF1s val_pow = *this;
 		while (pow > 0) {
 			if (pow & 1) {
 				out *= val_pow;
@@ -124,42 +332,145 @@ public:
 	}
 
 	uint64_t get_val() const {
+		return Reduction_Policy::from_repr(val);
+	}
+
+	// The value as it's stored, which is only different from get_val() for
+	// Montgomery_Reduction.
+	uint64_t get_repr() const {
 		return val;
 	}
 
-	bool operator==(const GF1<p>& other) const {
+	static GF1s from_repr(uint64_t repr) {
+		GF1s out;
+		out.val = static_cast<MAX_TYPE(p)>(repr);
+		return out;
+	}
+
+	bool operator==(const GF1s& other) const {
 		return val == other.val;
 	}
 
 	std::string to_string() const {
-		return std::to_string(static_cast<uint64_t>(val));
+		return std::to_string(get_val());
 	}
 
 	explicit operator std::string() const {
 		return to_string();
 	}
 public:
-	static GF1<p> member_zero(const void * other_data = nullptr) {
+	static GF1s member_zero(const void * other_data = nullptr) {
 		(void)other_data;
 		return 0;
 	}
 
-	static GF1<p> member_one(const void * other_data = nullptr) {
+	static GF1s member_one(const void * other_data = nullptr) {
 		(void)other_data;
 		return 1;
 	}
 private:
+	static constexpr MAX_TYPE(p) one_repr = Reduction_Policy::to_repr(1);
+	static constexpr bool has_inverse_table = p <= GF1_INVERSE_TABLE_LIMIT;
+
+	// Indexed by representation rather than by value so that it works for
+	// every reduction policy without converting in or out. The inverses come
+	// from inv(i) = -(p / i) inv(p mod i), which only needs one pass. by_value
+	// and by_repr both have to hold p zeros.
+	template<typename By_Value, typename By_Repr>
+	static constexpr void fill_inverse_table(By_Value& by_value, By_Repr& by_repr) {
+		by_value[1] = 1;
+		for (uint64_t i = 2; i < p; i++) {
+			by_value[i] = (p - p / i) * by_value[p % i] % p;
+		}
+		for (uint64_t i = 1; i < p; i++) {
+			by_repr[Reduction_Policy::to_repr(i)] = Reduction_Policy::to_repr(by_value[i]);
+		}
+	}
+
+	static constexpr std::array<MAX_TYPE(p), p> build_inverse_table() {
+		std::array<uint64_t, p> by_value{};
+		std::array<MAX_TYPE(p), p> by_repr{};
+		fill_inverse_table(by_value, by_repr);
+		return by_repr;
+	}
+
+	// Anything the compiler could evaluate on its own, it tries to, even
+	// outside a constant expression, so the tables built at runtime go on
+	// the heap.
+	static std::vector<MAX_TYPE(p)> build_inverse_table_at_runtime() {
+		std::vector<uint64_t> by_value(p, 0);
+		std::vector<MAX_TYPE(p)> by_repr(p, 0);
+		fill_inverse_table(by_value, by_repr);
+		return by_repr;
+	}
+
+	static MAX_TYPE(p) inverse_of_repr(MAX_TYPE(p) repr) {
+		if constexpr (p <= GF1_CONSTEXPR_INVERSE_TABLE_LIMIT) {
+			static constexpr std::array<MAX_TYPE(p), p> table = build_inverse_table();
+			return table[repr];
+		} else {
+			static const std::vector<MAX_TYPE(p)> table = build_inverse_table_at_runtime();
+			return table[repr];
+		}
+	}
+
 	MAX_TYPE(p) val;
 };
 
-template<uint32_t p>
-std::ostream& operator<<(std::ostream& s, const GF1<p>& value) {
+template<uint32_t p, template<uint32_t> typename Reduction>
+std::ostream& operator<<(std::ostream& s, const GF1<p, Reduction>& value) {
 	s << value.get_val();
 	return s;
 }
 
+// Adds up products of representatives without reducing them, and only
+// reduces when the next product could overflow. MAX_TYPE already guarantees
+// that a single product fits in 64 bits, so for p < 2^16 that's every 2^32
+// terms, i.e. never in practice. When fewer than 64 products would fit, the
+// sum is kept in 128 bits instead.
+template<uint32_t p, template<uint32_t> typename Reduction = Modulo_Reduction>
+class GF1_Accumulator {
+public:
+	using GF1s = GF1<p, Reduction>;
+	static constexpr uint64_t max_product = static_cast<uint64_t>(p - 1) * (p - 1);
+	static constexpr bool wide = max_product > UINT64_MAX / 64;
+	using Sum_Type = std::conditional_t<wide, unsigned __int128, uint64_t>;
+	// How many products we can add to something already reduced mod p.
+	static constexpr uint64_t max_terms = wide
+		? UINT64_MAX
+		: (UINT64_MAX - (p - 1)) / std::max<uint64_t>(max_product, 1);
+
+	// The initial value gets multiplied by one so that it carries the same
+	// factor as every other product, which matters for Montgomery form.
+	GF1_Accumulator(const GF1s& initial = 0) {
+		add_product(initial, 1);
+	}
+
+	void add_product(const GF1s& a, const GF1s& b) {
+		sum += static_cast<uint64_t>(a.get_repr()) * b.get_repr();
+		if (++terms == max_terms) {
+			sum %= p;
+			terms = 0;
+		}
+	}
+
+	GF1s result() const {
+		return GF1s::from_repr(
+			Reduction<p>::reduce_product(static_cast<uint64_t>(sum % p))
+		);
+	}
+private:
+	Sum_Type sum = 0;
+	uint64_t terms = 0;
+};
+
+template<uint32_t p, template<uint32_t> typename Reduction>
+struct Accumulator_For<GF1<p, Reduction>> {
+	using type = GF1_Accumulator<p, Reduction>;
+};
+
 class GF_Mat_Base;
-template<uint32_t p>
+template<uint32_t p, typename Tag = void>
 class GF_Mat;
 
 template<uint32_t p, typename Repr = GF_Mat<p>>
@@ -258,12 +569,59 @@ public:
 		return out;
 	}
 
+	// this^(p^k), for representations that have a cheap Frobenius map.
+	GFs frobenius(uint64_t k = 1) const {
+		GFs out{ *this };
+		out.val = val.frobenius(k);
+		return out;
+	}
+
 	GFs inv() const OVERRIDE {
 		GFs out{ *this };
 		out.val = out.val.inv();
 		return out;
 	}
 
+	// Tr(this) = this + this^p + ... + this^(p^(n - 1)), which is in GF(p).
+	// It's linear, so it only takes a dot product with the traces of the
+	// basis the field context keeps around, unless the representation has
+	// something even faster.
+	GF1<p> trace() const {
+		if constexpr (requires { val.trace(); }) {
+			return val.trace();
+		} else {
+			return val.get_context()->trace(coeffs());
+		}
+	}
+
+	// N(this) = this this^p ... this^(p^(n - 1)), which is in GF(p).
+	GF1<p> norm() const {
+		return val.get_context()->norm(coeffs());
+	}
+
+	// Whether this is in GF(p^d), for d dividing n.
+	bool is_in_subfield(size_t d) const {
+		return val.get_context()->is_in_subfield(coeffs(), d);
+	}
+
+	// This as an element of GF(p) for d = 1, or as an element of GF(p^d) over
+	// the modulus in the field context's get_subfield(d) otherwise. Throws a
+	// std::domain_error if this isn't in GF(p^d).
+	template<size_t d>
+	std::conditional_t<d == 1, GF1<p>, GF<p>> to_subfield() const {
+		const auto * context = val.get_context();
+		std::vector<GF1<p>> c = coeffs();
+		if constexpr (d == 1) {
+			if (!context->is_in_subfield(c, 1)) {
+				throw std::domain_error("This element isn't in GF(p).");
+			}
+			return c.empty() ? GF1<p>{0} : c[0];
+		} else {
+			Polynomial<GF1<p>> subfield_coeffs{ context->to_subfield(c, d) };
+			return GF<p>{context->get_subfield(d).modulus, subfield_coeffs};
+		}
+	}
+
 	const Repr& get_val() const {
 		return val;
 	}
@@ -294,6 +652,10 @@ public:
 		return GFs{irreducible_poly, one<Polynomial<GF1<p>>>()};
 	}
 private:
+	std::vector<GF1<p>> coeffs() const {
+		return val.to_poly().to_vector();
+	}
+
 	uint32_t order;
 	Repr val;
 };
@@ -312,3 +674,7 @@ std::ostream& operator<<(std::ostream& s, const GF<p, Repr>& value) {
 }
 
 }
+
+// Down here since it needs GF1, and Fast_Multiplier_For<GF1<p>> in
+// polynomial-multiply.hpp needs it wherever GF1 goes.
+#include "gf1-ntt.hpp"
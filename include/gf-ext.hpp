@@ -0,0 +1,466 @@
+#pragma once
+#include "finite-field.hpp"
+#include "gf1-ntt.hpp"
+#include "identities.hpp"
+#include "polynomial-gcd.hpp"
+#include "polynomial-multiply.hpp"
+#include "polynomial.hpp"
+#include "remove-v-tables.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cherry {
+
+// Something that tells apart base fields whose elements print the same, like
+// GF<5> with two different irreducible polynomials. Elements that have a
+// shared context or table use that, and everything else (GF1, GF2n) is
+// already a different type for every field.
+template<typename Base>
+const void * field_id(const Base& value) {
+	if constexpr (requires { value.get_val().get_context(); }) {
+		return value.get_val().get_context();
+	} else if constexpr (requires { value.get_val().get_table(); }) {
+		return value.get_val().get_table();
+	} else if constexpr (requires { value.get_context(); }) {
+		return value.get_context();
+	} else {
+		(void)value;
+		return nullptr;
+	}
+}
+
+// Everything about an extension of degree m of Base that only depends on its
+// modulus, which is an irreducible polynomial of degree m over Base. Like
+// Field_Context, there's one per (monic) modulus, so two elements are in the
+// same extension exactly when their context pointers match.
+//
+// Base can be anything that acts like a field and can be turned into a
+// std::string: GF1<p>, GF<p, Repr>, or another GF_Ext. Base elements can't
+// always be built from nothing (GF<p> needs its polynomial), so the context
+// takes zero and one from the leading coefficient of the monic modulus.
+//
+// When Base can be default constructed (GF1<p> and GF_Ext can), elements keep
+// their coefficients in a std::array, so a whole tower of them never touches
+// the heap.
+template<typename Base, size_t m>
+class Ext_Context {
+public:
+	static constexpr bool inline_storage = std::is_default_constructible_v<Base>;
+	using Coeffs = std::conditional_t<inline_storage, std::array<Base, m>, std::vector<Base>>;
+	using Poly_Coeffs = std::vector<Base>;
+
+	// Interned the same way as Field_Context::get, so a context is never
+	// freed once it's been made, and neither is the copy of the modulus it
+	// keeps.
+	static const Ext_Context<Base, m> * get(const Polynomial<Base>& modulus) {
+		static std::mutex mutex;
+		static std::map<std::pair<const void *, std::vector<std::string>>, std::unique_ptr<Ext_Context<Base, m>>> contexts;
+		Poly_Coeffs monic = make_monic(modulus);
+		std::vector<std::string> key;
+		key.reserve(monic.size());
+		for (const auto& coeff : monic) {
+			key.push_back(static_cast<std::string>(coeff));
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		auto& context = contexts[{ field_id(monic.back()), key }];
+		if (!context) {
+			context.reset(new Ext_Context<Base, m>(std::move(monic)));
+		}
+		return context.get();
+	}
+
+	size_t degree() const {
+		return m;
+	}
+
+	// The modulus made monic, from lowest degree to highest.
+	const Poly_Coeffs& get_modulus() const {
+		return modulus;
+	}
+
+	Polynomial<Base> get_irreducible() const {
+		return modulus;
+	}
+
+	const Base& base_zero() const {
+		return zero_v;
+	}
+
+	const Base& base_one() const {
+		return one_v;
+	}
+
+	Coeffs zeros() const {
+		if constexpr (inline_storage) {
+			Coeffs out;
+			out.fill(zero_v);
+			return out;
+		} else {
+			return Coeffs(m, zero_v);
+		}
+	}
+
+	bool is_zero(const Coeffs& a) const {
+		for (const auto& coeff : a) {
+			if (!(coeff == zero_v)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Any polynomial over Base mod the modulus, by long division.
+	Coeffs reduce_poly(const Polynomial<Base>& vals) const {
+		Poly_Coeffs product = vals.to_vector();
+		if (product.size() < m) {
+			product.resize(m, zero_v);
+		}
+		reduce(product.data(), product.size());
+		return first_m(product.data());
+	}
+
+	// Reduces product[0 .. len) in place, leaving the result in the first m
+	// coefficients. Only the nonzero terms of the modulus cost anything, so
+	// a binomial like x^m - c only takes one multiplication per extra
+	// coefficient.
+	void reduce(Base * product, size_t len) const {
+		for (size_t i = len; i-- > m;) {
+			const Base top = product[i];
+			if (top == zero_v) {
+				continue;
+			}
+			for (size_t j : nonzero_terms) {
+				product[i - m + j] -= top * modulus[j];
+			}
+		}
+	}
+
+	// The product comes from Polynomial_Multiplier, so it's the schoolbook
+	// product (with delayed reduction for bases like GF1<p>) for the small
+	// degrees towers use, and Karatsuba and up past that.
+	Coeffs mul_mod(const Coeffs& a, const Coeffs& b) const {
+		if constexpr (inline_storage) {
+			std::array<Base, 2 * m - 1> product;
+			Polynomial_Multiplier<Base>::multiply(a.data(), m, b.data(), m, product.data());
+			reduce(product.data(), product.size());
+			return first_m(product.data());
+		} else {
+			Poly_Coeffs product(2 * m - 1, zero_v);
+			Polynomial_Multiplier<Base>::multiply(a.data(), m, b.data(), m, product.data());
+			reduce(product.data(), product.size());
+			return first_m(product.data());
+		}
+	}
+
+	// The inverse of a reduced polynomial mod the modulus, from inverse_mod,
+	// so big extensions get the half GCD.
+	Coeffs inv_mod(const Coeffs& a) const {
+		Polynomial<Base> inverse = inverse_mod(Polynomial<Base>{ Poly_Coeffs(a.begin(), a.end()) }, get_irreducible());
+		const auto& coeffs = inverse.get_coeffs();
+		Coeffs out = zeros();
+		std::copy(coeffs.begin(), coeffs.end(), out.begin());
+		return out;
+	}
+private:
+	Ext_Context(Poly_Coeffs monic) :
+		modulus(std::move(monic)),
+		zero_v(modulus.back() - modulus.back()),
+		one_v(modulus.back())
+	{
+		for (size_t j = 0; j < m; j++) {
+			if (!(modulus[j] == zero_v)) {
+				nonzero_terms.push_back(j);
+			}
+		}
+	}
+
+	static Poly_Coeffs make_monic(const Polynomial<Base>& modulus) {
+		const auto& coeffs = modulus.get_coeffs();
+		if (coeffs.size() != m + 1) {
+			throw std::invalid_argument("The modulus of an extension of degree m has to have degree m.");
+		}
+		const Base& lead = coeffs.back();
+		if (lead == lead - lead) {
+			throw std::invalid_argument("The modulus of an extension of degree m has to have degree m.");
+		}
+		Base lead_inv = cherry::inv(lead);
+		Poly_Coeffs out;
+		out.reserve(m + 1);
+		for (const auto& coeff : coeffs) {
+			out.push_back(coeff * lead_inv);
+		}
+		return out;
+	}
+
+	Coeffs first_m(const Base * product) const {
+		if constexpr (inline_storage) {
+			Coeffs out;
+			std::copy(product, product + m, out.begin());
+			return out;
+		} else {
+			return Coeffs(product, product + m);
+		}
+	}
+
+	Poly_Coeffs modulus;
+	Base zero_v;
+	Base one_v;
+	std::vector<size_t> nonzero_terms;
+};
+
+// An element of the extension of degree m of Base, stored as its m
+// coefficients mod the modulus, from lowest degree to highest. Since Base can
+// be another GF_Ext, this builds towers like GF(((p^2)^3)^2), where every
+// level multiplies over the level below it instead of doing one big product
+// over GF(p).
+//
+// zero and one take a pointer to the Ext_Context, since that's what has the
+// modulus. Tag works the same way it does for GF_Mat.
+template<typename Base, size_t m, typename Tag = void>
+class GF_Ext COLON_IN_CLASS_INHERITANCE DIVISION_RING(GF_Ext<Base COMMA m COMMA Tag>) {
+public:
+	using Context = Ext_Context<Base, m>;
+	using Coeffs = typename Context::Coeffs;
+
+	// Only there so that towers can keep GF_Exts in a std::array. Until
+	// something gets assigned to it, the element has no context, counts as
+	// zero, and throws from anything that needs the modulus.
+	GF_Ext() {}
+
+	GF_Ext(const Polynomial<Base>& modulus) : GF_Ext(Context::get(modulus)) {}
+
+	GF_Ext(const Polynomial<Base>& modulus, const Polynomial<Base>& vals) :
+		GF_Ext(Context::get(modulus), vals)
+	{}
+
+	explicit GF_Ext(const Context * ctx) :
+		context(ctx),
+		val(ctx->zeros())
+	{}
+
+	GF_Ext(const Context * ctx, const Polynomial<Base>& vals) :
+		context(ctx),
+		val(ctx->reduce_poly(vals))
+	{}
+
+	// Base sits inside the extension as the constants.
+	GF_Ext(const Context * ctx, const Base& constant) :
+		GF_Ext(ctx)
+	{
+		val[0] = constant;
+	}
+
+	GF_Ext operator+(const GF_Ext& other) const OVERRIDE {
+		GF_Ext out{ *this };
+		out += other;
+		return out;
+	}
+
+	GF_Ext& operator+=(const GF_Ext& other) OVERRIDE {
+		check_if_same_modulus(other);
+		for (size_t i = 0; i < m; i++) {
+			val[i] += other.val[i];
+		}
+		return *this;
+	}
+
+	GF_Ext operator-() const OVERRIDE {
+		GF_Ext out{ *this };
+		out.negate();
+		return out;
+	}
+
+	void negate() OVERRIDE {
+		for (auto& coeff : val) {
+			coeff.negate();
+		}
+	}
+
+	GF_Ext operator-(const GF_Ext& other) const OVERRIDE {
+		GF_Ext out{ *this };
+		out -= other;
+		return out;
+	}
+
+	GF_Ext& operator-=(const GF_Ext& other) OVERRIDE {
+		check_if_same_modulus(other);
+		for (size_t i = 0; i < m; i++) {
+			val[i] -= other.val[i];
+		}
+		return *this;
+	}
+
+	GF_Ext operator*(const GF_Ext& other) const OVERRIDE {
+		GF_Ext out{ *this };
+		out *= other;
+		return out;
+	}
+
+	GF_Ext& operator*=(const GF_Ext& other) OVERRIDE {
+		check_if_same_modulus(other);
+		val = checked_context()->mul_mod(val, other.val);
+		return *this;
+	}
+
+	GF_Ext operator*(const Base& other) const {
+		GF_Ext out{ *this };
+		out *= other;
+		return out;
+	}
+
+	GF_Ext& operator*=(const Base& other) {
+		for (auto& coeff : val) {
+			coeff *= other;
+		}
+		return *this;
+	}
+
+	GF_Ext operator/(const GF_Ext& other) const OVERRIDE {
+		return (*this) * other.inv();
+	}
+
+	GF_Ext& operator/=(const GF_Ext& other) OVERRIDE {
+		(*this) *= other.inv();
+		return *this;
+	}
+
+	GF_Ext operator^(int pow) const OVERRIDE {
+		if (pow < 0) {
+			return inv().pow_u(-static_cast<int64_t>(pow));
+		}
+		return pow_u(pow);
+	}
+
+	GF_Ext pow_u(uint64_t pow) const OVERRIDE {
+		GF_Ext out{ *this };
+		out.to_identity();
+		GF_Ext square{ *this };
+		while (pow > 0) {
+			if (pow & 1) {
+				out *= square;
+			}
+			pow >>= 1;
+			if (pow > 0) {
+				square *= square;
+			}
+		}
+		return out;
+	}
+
+	GF_Ext inv() const OVERRIDE {
+		GF_Ext out{ *this };
+		out.val = checked_context()->inv_mod(val);
+		return out;
+	}
+
+	void check_if_same_modulus(const GF_Ext& other) const {
+#ifdef FULL_FIELD_CHECKS
+		if (context == other.context || (context && other.context && same_field(context->get_modulus(), other.context->get_modulus()))) {
+			return;
+		}
+#else
+		if (!std::is_void_v<Tag> || context == other.context) {
+			return;
+		}
+#endif
+		throw std::domain_error("These two elements come from different moduli");
+	}
+
+	const Coeffs& get_val() const {
+		return val;
+	}
+
+	const Context * get_context() const {
+		return context;
+	}
+
+	Polynomial<Base> get_modulus() const {
+		return checked_context()->get_irreducible();
+	}
+
+	bool operator==(const GF_Ext& other) const {
+		return context == other.context && val == other.val;
+	}
+
+	bool is_zero() const {
+		return !context || context->is_zero(val);
+	}
+
+	void to_identity() {
+		const Context * ctx = checked_context();
+		std::fill(val.begin(), val.end(), ctx->base_zero());
+		val[0] = ctx->base_one();
+	}
+
+	Polynomial<Base> to_poly() const {
+		return std::vector<Base>(val.begin(), val.end());
+	}
+
+	// Prints like a Polynomial, from highest degree to lowest.
+	std::string to_string() const {
+		std::string out;
+		out += "(";
+		for (size_t i = m - 1; i > 0; i--) {
+			out += static_cast<std::string>(val[i]);
+			out += ", ";
+		}
+		out += static_cast<std::string>(val[0]);
+		out += ")";
+		return out;
+	}
+
+	explicit operator std::string() const {
+		return to_string();
+	}
+public:
+	static GF_Ext member_zero(const void * other_data) {
+		return GF_Ext{ static_cast<const Context *>(other_data) };
+	}
+
+	static GF_Ext member_one(const void * other_data) {
+		GF_Ext out{ static_cast<const Context *>(other_data) };
+		out.to_identity();
+		return out;
+	}
+private:
+	// The same moduli over the same base field, the way Ext_Context::get
+	// tells them apart.
+	static bool same_field(const std::vector<Base>& a, const std::vector<Base>& b) {
+		return field_id(a.back()) == field_id(b.back()) && a == b;
+	}
+
+	const Context * checked_context() const {
+		if (!context) {
+			throw std::domain_error("A default-constructed GF_Ext doesn't know its modulus.");
+		}
+		return context;
+	}
+
+	const Context * context = nullptr;
+	Coeffs val;
+};
+
+template<typename Base, size_t m, typename Tag>
+GF_Ext<Base, m, Tag> operator*(const Base& scalar, const GF_Ext<Base, m, Tag>& vector) {
+	GF_Ext<Base, m, Tag> out{ vector };
+	out *= scalar;
+	return out;
+}
+
+template<typename Base, size_t m, typename Tag>
+std::ostream& operator<<(std::ostream& s, const GF_Ext<Base, m, Tag>& value) {
+	s << value.to_string();
+	return s;
+}
+
+}
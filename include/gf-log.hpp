@@ -0,0 +1,507 @@
+#pragma once
+#include "field-context.hpp"
+#include "finite-field.hpp"
+#include "polynomial-gcd.hpp"
+#include "polynomial.hpp"
+#include "remove-v-tables.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// GF_Log<p> builds three tables with an entry for every element of the
+// field, so it refuses to work with fields bigger than this. At the default,
+// the tables for the biggest field take up about 12 MB.
+#ifndef GF_LOG_MAX_ORDER
+#define GF_LOG_MAX_ORDER (1 << 20)
+#endif
+
+namespace cherry {
+
+// The tables for a single field GF(p^n). Every nonzero element is g^k for a
+// primitive element g, so elements are stored as k, and multiplying is just
+// adding exponents. For adding elements, there's the Zech logarithm Z(k),
+// defined by g^Z(k) = 1 + g^k, which gives
+//
+//     g^a + g^b = g^a (1 + g^(b - a)) = g^(a + Z(b - a)).
+//
+// Elements are also numbered by their coefficients in base p (so the index
+// of c_0 + c_1 x + c_2 x^2 is c_0 + c_1 p + c_2 p^2), which is what the
+// tables use to go back and forth between logs and polynomials.
+template<uint32_t p>
+class GF_Log_Table {
+public:
+	// The log of zero, which doesn't really exist.
+	static constexpr uint32_t zero_log = UINT32_MAX;
+
+	// Tables get built the first time a field gets used and are shared by
+	// every element of that field until the program ends.
+	static const GF_Log_Table<p> * get(const Polynomial<GF1<p>>& irreducible) {
+		static std::mutex mutex;
+		static std::map<std::vector<uint64_t>, std::unique_ptr<GF_Log_Table<p>>> tables;
+		std::vector<uint64_t> key = monic_coeffs(irreducible);
+		std::lock_guard<std::mutex> lock(mutex);
+		auto& table = tables[key];
+		if (!table) {
+			table.reset(new GF_Log_Table<p>(key));
+		}
+		return table.get();
+	}
+
+	uint32_t get_order() const {
+		return q;
+	}
+
+	uint32_t get_degree() const {
+		return n;
+	}
+
+	uint32_t add(uint32_t a, uint32_t b) const {
+		if (a == zero_log) {
+			return b;
+		}
+		if (b == zero_log) {
+			return a;
+		}
+		uint32_t z = zech[b >= a ? b - a : b + (q - 1) - a];
+		if (z == zero_log) {
+			return zero_log;
+		}
+		return mod_order(a + z);
+	}
+
+	uint32_t negate(uint32_t a) const {
+		if (a == zero_log) {
+			return zero_log;
+		}
+		return mod_order(a + minus_one_log);
+	}
+
+	uint32_t mul(uint32_t a, uint32_t b) const {
+		if (a == zero_log || b == zero_log) {
+			return zero_log;
+		}
+		return mod_order(a + b);
+	}
+
+	uint32_t inv(uint32_t a) const {
+		if (a == zero_log) {
+			throw std::domain_error(
+				"Trying to take the multiplicative inverse of "
+				"the additive identity (i.e. dividing by zero)."
+			);
+		}
+		return a == 0 ? 0 : (q - 1) - a;
+	}
+
+	uint32_t pow(uint32_t a, int64_t power) const {
+		if (a == zero_log) {
+			if (power < 0) {
+				inv(a);
+			}
+			return power == 0 ? 0 : zero_log;
+		}
+		int64_t reduced = (static_cast<int64_t>(a) * (power % static_cast<int64_t>(q - 1))) % static_cast<int64_t>(q - 1);
+		if (reduced < 0) {
+			reduced += q - 1;
+		}
+		return static_cast<uint32_t>(reduced);
+	}
+
+	// The index of g^k, and the log of the element with a given index, for
+	// anything that wants to build its own tables on top of these.
+	uint32_t index_of(uint32_t k) const {
+		return exp[k];
+	}
+
+	uint32_t log_of_index(uint32_t index) const {
+		return log_of[index];
+	}
+
+	const Field_Context<p> * get_context() const {
+		return context;
+	}
+
+	// Tr(g^a), from the digits of its index and the traces of 1, x, x^2, ...
+	GF1<p> trace_of(uint32_t a) const {
+		if (a == zero_log) {
+			return GF1<p>{0};
+		}
+		uint32_t index = exp[a];
+		uint64_t sum = 0;
+		for (uint32_t i = 0; i < n; i++) {
+			sum += static_cast<uint64_t>(index % p) * traces[i];
+			index /= p;
+		}
+		return GF1<p>{sum % p};
+	}
+
+	uint32_t log_of_scalar(const GF1<p>& c) const {
+		return log_of[c.get_val()];
+	}
+
+	// Horner's rule with table lookups, so vals can have any degree.
+	uint32_t log_of_poly(const Polynomial<GF1<p>>& vals) const {
+		uint32_t out = zero_log;
+		for (size_t i = vals.degree(); i <= vals.degree(); i--) {
+			out = add(mul(out, x_log), log_of_scalar(vals[i]));
+		}
+		return out;
+	}
+
+	Polynomial<GF1<p>> to_poly(uint32_t a) const {
+		uint32_t index = a == zero_log ? 0 : exp[a];
+		std::vector<GF1<p>> coeffs;
+		coeffs.reserve(n);
+		for (uint32_t i = 0; i < n; i++) {
+			coeffs.emplace_back(index % p);
+			index /= p;
+		}
+		return coeffs;
+	}
+private:
+	GF_Log_Table(const std::vector<uint64_t>& modulus) :
+		n(static_cast<uint32_t>(modulus.size() - 1)),
+		q(compute_order(modulus))
+	{
+		std::vector<GF1<p>> monic;
+		for (uint64_t coeff : modulus) {
+			monic.emplace_back(coeff);
+		}
+		context = Field_Context<p>::get(monic);
+		check_irreducible();
+		exp.resize(q - 1);
+		log_of.resize(q);
+		find_primitive_element(modulus);
+		zech.resize(q - 1);
+		for (uint32_t k = 0; k < q - 1; k++) {
+			uint32_t index = exp[k];
+			uint32_t plus_one = index % p == p - 1 ? index - (p - 1) : index + 1;
+			zech[k] = log_of[plus_one];
+		}
+		minus_one_log = log_of[p - 1];
+		// For n = 1, x is -m_0.
+		x_log = log_of[n > 1 ? p : (p - modulus[0]) % p];
+		for (const auto& trace : context->get_traces()) {
+			traces.push_back(static_cast<uint32_t>(trace.get_val()));
+		}
+	}
+
+	static std::vector<uint64_t> monic_coeffs(const Polynomial<GF1<p>>& irreducible) {
+		size_t degree = irreducible.degree();
+		while (degree > 0 && irreducible[degree] == GF1<p>{0}) {
+			degree--;
+		}
+		if (degree == 0) {
+			throw std::invalid_argument("The irreducible polynomial for GF_Log has to have degree at least 1.");
+		}
+		GF1<p> lead_inv = cherry::inv(irreducible[degree]);
+		std::vector<uint64_t> out;
+		out.reserve(degree + 1);
+		for (size_t i = 0; i <= degree; i++) {
+			out.push_back((irreducible[i] * lead_inv).get_val());
+		}
+		return out;
+	}
+
+	static uint32_t compute_order(const std::vector<uint64_t>& modulus) {
+		uint64_t order = 1;
+		for (size_t i = 1; i < modulus.size(); i++) {
+			order *= p;
+			if (order > GF_LOG_MAX_ORDER) {
+				throw std::length_error(
+					"GF_Log only supports fields with up to GF_LOG_MAX_ORDER elements."
+				);
+			}
+		}
+		return static_cast<uint32_t>(order);
+	}
+
+	std::vector<uint32_t> to_digits(uint32_t index) const {
+		std::vector<uint32_t> out(n);
+		for (uint32_t i = 0; i < n; i++) {
+			out[i] = index % p;
+			index /= p;
+		}
+		return out;
+	}
+
+	uint32_t to_index(const std::vector<uint32_t>& digits) const {
+		uint32_t out = 0;
+		for (uint32_t i = n; i-- > 0;) {
+			out = out * p + digits[i];
+		}
+		return out;
+	}
+
+	// out = a * g mod the modulus, one power of x at a time. a gets
+	// clobbered.
+	void mul_digits(std::vector<uint32_t>& out, std::vector<uint32_t>& a, const std::vector<uint32_t>& g, uint32_t g_degree, const std::vector<uint64_t>& modulus) const {
+		std::fill(out.begin(), out.end(), 0);
+		for (uint32_t j = 0; j <= g_degree; j++) {
+			if (g[j] != 0) {
+				for (uint32_t i = 0; i < n; i++) {
+					out[i] = static_cast<uint32_t>((out[i] + static_cast<uint64_t>(a[i]) * g[j]) % p);
+				}
+			}
+			if (j == g_degree) {
+				break;
+			}
+			uint64_t top = a[n - 1];
+			for (uint32_t i = n - 1; i > 0; i--) {
+				a[i] = static_cast<uint32_t>((a[i - 1] + (p - modulus[i]) * top) % p);
+			}
+			a[0] = static_cast<uint32_t>(((p - modulus[0]) * top) % p);
+		}
+	}
+
+	// Ben-Or's test: the modulus is irreducible exactly when it shares no
+	// factor with x^(p^i) - x for i <= n / 2, since those are the products
+	// of every irreducible polynomial whose degree divides i.
+	void check_irreducible() const {
+		Polynomial<GF1<p>> x{{0, 1}};
+		for (uint32_t i = 1; 2 * i <= n; i++) {
+			Polynomial<GF1<p>> power{ context->get_frobenius_powers()[i] };
+			if (gcd(power - x, context->get_irreducible()).degree() > 0) {
+				throw std::invalid_argument(
+					"The polynomial for GF_Log has to be irreducible."
+				);
+			}
+		}
+	}
+
+	// Tries x, x + 1, x + 2, ... in order (or 2, 3, ... for n = 1), filling
+	// in the exp and log tables along the way, until one of them has order
+	// q - 1. The modulus is irreducible by now, so one of them does.
+	void find_primitive_element(const std::vector<uint64_t>& modulus) {
+		if (q == 2) {
+			exp[0] = 1;
+			log_of[0] = zero_log;
+			log_of[1] = 0;
+			return;
+		}
+		std::vector<uint32_t> power(n), scratch(n);
+		uint32_t first = n > 1 ? p : 2;
+		for (uint32_t candidate = first; candidate < q; candidate++) {
+			std::vector<uint32_t> g = to_digits(candidate);
+			uint32_t g_degree = n - 1;
+			while (g[g_degree] == 0) {
+				g_degree--;
+			}
+			std::fill(log_of.begin(), log_of.end(), zero_log);
+			std::fill(power.begin(), power.end(), 0);
+			power[0] = 1;
+			uint32_t k = 0;
+			for (; k < q - 1; k++) {
+				uint32_t index = to_index(power);
+				if (log_of[index] != zero_log || index == 0) {
+					break;
+				}
+				exp[k] = index;
+				log_of[index] = k;
+				scratch.swap(power);
+				mul_digits(power, scratch, g, g_degree, modulus);
+			}
+			if (k == q - 1 && to_index(power) == 1) {
+				return;
+			}
+		}
+		throw std::logic_error("GF_Log couldn't find a primitive element.");
+	}
+
+	uint32_t mod_order(uint32_t a) const {
+		return a >= q - 1 ? a - (q - 1) : a;
+	}
+
+	uint32_t n;
+	uint32_t q;
+	uint32_t minus_one_log;
+	uint32_t x_log;
+	std::vector<uint32_t> exp;
+	std::vector<uint32_t> log_of;
+	std::vector<uint32_t> zech;
+	const Field_Context<p> * context;
+	std::vector<uint32_t> traces;
+};
+
+// GF(p^n) stored as discrete logs, for fields small enough to have a table
+// entry for every element (see GF_LOG_MAX_ORDER). Multiplying, dividing and
+// raising to powers are integer arithmetic mod p^n - 1, and adding takes one
+// lookup in the Zech table. Use it as GF<p, GF_Log<p>>.
+template<uint32_t p>
+class GF_Log COLON_IN_CLASS_INHERITANCE DIVISION_RING(GF_Log<p>) {
+public:
+	using Table = GF_Log_Table<p>;
+
+	GF_Log() : table(nullptr), log(Table::zero_log) {}
+
+	GF_Log(const Polynomial<GF1<p>>& irreducible) :
+		table(Table::get(irreducible)),
+		log(Table::zero_log)
+	{}
+
+	GF_Log(const Polynomial<GF1<p>>& irreducible, const Polynomial<GF1<p>>& vals) :
+		table(Table::get(irreducible)),
+		log(table->log_of_poly(vals))
+	{}
+
+	GF_Log operator+(const GF_Log& other) const OVERRIDE {
+		GF_Log out{ *this };
+		out += other;
+		return out;
+	}
+
+	GF_Log& operator+=(const GF_Log& other) OVERRIDE {
+		check_if_same_field(other);
+		log = table->add(log, other.log);
+		return *this;
+	}
+
+	GF_Log operator-() const OVERRIDE {
+		GF_Log out{ *this };
+		out.negate();
+		return out;
+	}
+
+	// Zero (including a default-constructed element, which has no table)
+	// stays zero.
+	void negate() OVERRIDE {
+		if (log != Table::zero_log) {
+			log = table->negate(log);
+		}
+	}
+
+	GF_Log operator-(const GF_Log& other) const OVERRIDE {
+		GF_Log out{ *this };
+		out -= other;
+		return out;
+	}
+
+	GF_Log& operator-=(const GF_Log& other) OVERRIDE {
+		check_if_same_field(other);
+		log = table->add(log, table->negate(other.log));
+		return *this;
+	}
+
+	GF_Log operator*(const GF_Log& other) const OVERRIDE {
+		GF_Log out{ *this };
+		out *= other;
+		return out;
+	}
+
+	GF_Log& operator*=(const GF_Log& other) OVERRIDE {
+		check_if_same_field(other);
+		log = table->mul(log, other.log);
+		return *this;
+	}
+
+	GF_Log operator*(const GF1<p>& other) const {
+		GF_Log out{ *this };
+		out *= other;
+		return out;
+	}
+
+	GF_Log& operator*=(const GF1<p>& other) {
+		if (log != Table::zero_log) {
+			log = table->mul(log, table->log_of_scalar(other));
+		}
+		return *this;
+	}
+
+	GF_Log operator/(const GF_Log& other) const OVERRIDE {
+		return (*this) * other.inv();
+	}
+
+	GF_Log& operator/=(const GF_Log& other) OVERRIDE {
+		(*this) *= other.inv();
+		return *this;
+	}
+
+	GF_Log operator^(int pow) const OVERRIDE {
+		GF_Log out{ *this };
+		out.log = table->pow(log, pow);
+		return out;
+	}
+
+	GF_Log pow_u(uint32_t pow) const OVERRIDE {
+		GF_Log out{ *this };
+		out.log = table->pow(log, pow);
+		return out;
+	}
+
+	GF_Log inv() const OVERRIDE {
+		GF_Log out{ *this };
+		out.log = table->inv(log);
+		return out;
+	}
+
+	void check_if_same_field(const GF_Log& other) const {
+		if (table != other.table) {
+			throw std::domain_error("These two elements come from different irreducible polynomials");
+		}
+	}
+
+	// The power of the primitive element this is, or Table::zero_log for
+	// zero.
+	uint32_t get_log() const {
+		return log;
+	}
+
+	const Table * get_table() const {
+		return table;
+	}
+
+	const Field_Context<p> * get_context() const {
+		return table->get_context();
+	}
+
+	GF1<p> trace() const {
+		return table->trace_of(log);
+	}
+
+	bool operator==(const GF_Log& other) const {
+		return log == other.log && table == other.table;
+	}
+
+	void to_identity() {
+		log = 0;
+	}
+
+	Polynomial<GF1<p>> to_poly() const {
+		return table->to_poly(log);
+	}
+
+	std::string to_string() const {
+		return to_poly().to_string();
+	}
+
+	explicit operator std::string() const {
+		return to_string();
+	}
+public:
+	static GF_Log member_zero(const void * other_data) {
+		return { *static_cast<const Polynomial<GF1<p>>*>(other_data) };
+	}
+
+	static GF_Log member_one(const void * other_data) {
+		GF_Log out{ *static_cast<const Polynomial<GF1<p>>*>(other_data) };
+		out.to_identity();
+		return out;
+	}
+private:
+	const Table * table;
+	uint32_t log;
+};
+
+template<uint32_t p>
+std::ostream& operator<<(std::ostream& s, const GF_Log<p>& value) {
+	s << value.to_poly();
+	return s;
+}
+
+}
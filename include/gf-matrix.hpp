@@ -1,50 +1,41 @@
 #pragma once
+#include "field-context.hpp"
 #include "finite-field.hpp"
 #include "matrix.hpp"
 #include <algorithm>
-#include <memory>
 #include <stdexcept>
+#include <type_traits>
 
 namespace cherry {
 
 class GF_Mat_Base {};
 
-template<unsigned int p>
-class GF_Mat : DIVISION_RING(GF_Mat<p>) COMMA_IN_CLASS_INHERITANCE public GF_Mat_Base {
+// Elements only remember which field they're in through their context, so
+// checking that two elements are in the same field is a pointer comparison.
+// If you give GF_Mat a Tag, you're promising that every element with that
+// Tag uses the same irreducible polynomial, which makes mixing fields a type
+// error and skips the check entirely. Define FULL_FIELD_CHECKS to compare the
+// whole companion matrices no matter what, like GF_Mat used to.
+template<unsigned int p, typename Tag>
+class GF_Mat : DIVISION_RING(GF_Mat<p COMMA Tag>) COMMA_IN_CLASS_INHERITANCE public GF_Mat_Base {
 public:
 	GF_Mat() {}
-	GF_Mat(const Polynomial<GF1<p>>& irr) :
-	irreducible_poly_ptr{std::make_shared<Polynomial<GF1<p>>>(irr)},
-	val{
-		GF1<p>{0},
-		irr.degree(),
-		irreducible_poly_ptr
-	},
-	lambda{
-		GF1<p>{0},
-		irr.degree(),
-		irreducible_poly_ptr
-	}
-{
-		lambda.to_nilpotent_diag(1);
-		auto irreducible = irr;
-		irreducible *= cherry::inv(irreducible[irreducible.degree()]);
-		for (size_t i = 0; i < irreducible.degree(); i++) {
-			lambda(irreducible.degree() - i - 1, 0) = -irreducible[i];
-		}
-	}
+	GF_Mat(const Polynomial<GF1<p>>& irr) : GF_Mat(Field_Context<p>::get(irr)) {}
 
-	GF_Mat(const Polynomial<GF1<p>>& irreducible, const Polynomial<GF1<p>>& vals) : val{GF1<p>{0}, irreducible.degree()}, lambda{GF1<p>{0}, irreducible.degree()} {
-		lambda.to_nilpotent_diag(1);
-		for (size_t i = 0; i < irreducible.degree(); i++) {
-			lambda(irreducible.degree() - i - 1, 0) = -irreducible[i];
-		}
-		Matrix<GF1<p>> identity(GF1<p>(0), val.get_num_rows());
-		identity.to_identity();
-		for (size_t i = vals.degree(); i <= vals.degree(); i--) {
-			val *= lambda;
-			val += identity * vals[i];
+	GF_Mat(const Polynomial<GF1<p>>& irreducible, const Polynomial<GF1<p>>& vals) :
+		GF_Mat(Field_Context<p>::get(irreducible), vals)
+	{}
+
+	explicit GF_Mat(const Field_Context<p> * ctx) :
+		context{ctx},
+		val{
+			GF1<p>{0},
+			ctx->degree()
 		}
+	{}
+
+	GF_Mat(const Field_Context<p> * ctx, const Polynomial<GF1<p>>& vals) : GF_Mat(ctx) {
+		set_coeffs(context->reduce_poly(vals));
 	}
 
 	GF_Mat operator+(const GF_Mat& other) const OVERRIDE {
@@ -119,29 +110,50 @@ public:
 	}
 
 	GF_Mat operator^(int pow) const OVERRIDE {
+		if (pow < 0) {
+			return inv().pow_u(-static_cast<int64_t>(pow));
+		}
+		return pow_u(pow);
+	}
+
+	// Powers get taken on the polynomial, where the Frobenius map is cheap
+	// (see Field_Context::pow).
+	GF_Mat pow_u(uint64_t pow) const OVERRIDE {
 		GF_Mat out{*this};
-		out.val = out.val^pow;
+		out.set_coeffs(context->pow(to_poly_coeffs(), pow));
 		return out;
 	}
 
-	GF_Mat pow_u(unsigned int pow) const OVERRIDE {
+	// this^(p^k).
+	GF_Mat frobenius(uint64_t k = 1) const {
 		GF_Mat out{*this};
-		out.val = out.val.pow_u(pow);
+		out.set_coeffs(context->frobenius(to_poly_coeffs(), k));
 		return out;
 	}
 
+	// Inverting the polynomial with the extended Euclidean algorithm is a lot
+	// cheaper than inverting the matrix.
 	GF_Mat inv() const OVERRIDE {
 		GF_Mat out{*this};
-		out.val = out.val.inv();
+		out.set_coeffs(context->inv_mod(to_poly_coeffs()));
 		return out;
 	}
 
 	void check_if_same_polynomial(const GF_Mat& other) const {
-		if (lambda == other.lambda) {
+#ifdef FULL_FIELD_CHECKS
+		if (context == other.context || (
+			context && other.context
+			&& context->degree() == other.context->degree()
+			&& get_lambda() == other.get_lambda()
+		)) {
 			return;
-		} else {
-			throw std::domain_error("These two matrices come from different irreducible polynomials");
 		}
+#else
+		if (!std::is_void_v<Tag> || context == other.context) {
+			return;
+		}
+#endif
+		throw std::domain_error("These two matrices come from different irreducible polynomials");
 	}
 
 	const Matrix<GF1<p>>& get_val() const {
@@ -149,10 +161,14 @@ public:
 	}
 
 	const Matrix<GF1<p>>& get_lambda() const {
-		return lambda;
+		return context->get_companion();
 	}
 
-	bool operator==(const GF_Mat<p>& other) const {
+	const Field_Context<p> * get_context() const {
+		return context;
+	}
+
+	bool operator==(const GF_Mat& other) const {
 		return val == other.val;
 	}
 
@@ -165,7 +181,7 @@ public:
 	}
 
 	Polynomial<GF1<p>> get_lambda_poly() const {
-		return matrix_to_poly(lambda);
+		return matrix_to_poly(get_lambda());
 	}
 
 	std::string to_string() const {
@@ -175,12 +191,14 @@ public:
 		return out;
 	}
 public:
-	static GF_Mat<p> zero(const void * other_data) {
-		return { *static_cast<Polynomial<GF1<p>>*>(other_data) };
+	static GF_Mat zero(const void * other_data) {
+		return { *static_cast<const Polynomial<GF1<p>>*>(other_data) };
 	}
 
-	static GF_Mat<p> one(const void * other_data) {
-		return { *static_cast<Polynomial<GF1<p>>*>(other_data), { 1 } };
+	static GF_Mat one(const void * other_data) {
+		GF_Mat out{ *static_cast<const Polynomial<GF1<p>>*>(other_data) };
+		out.to_identity();
+		return out;
 	}
 
 	static Polynomial<GF1<p>> matrix_to_poly(const Matrix<GF1<p>>& mat) {
@@ -194,9 +212,36 @@ public:
 		return coeffs;
 	}
 private:
-	std::shared_ptr<void> irreducible_poly_ptr;
+	std::vector<GF1<p>> to_poly_coeffs() const {
+		size_t n = val.get_num_rows();
+		std::vector<GF1<p>> coeffs(n);
+		for (size_t i = 0; i < n; i++) {
+			coeffs[i] = val(n - i - 1, n - 1);
+		}
+		return coeffs;
+	}
+
+	// val = c_0 + c_1 lambda + ... + c_{n - 1} lambda^{n - 1}. Since
+	// lambda e_j = e_{j - 1}, the last column of val is just the coefficients
+	// and each column before it is lambda times the one after it, so this
+	// only takes O(n^2) instead of n matrix products.
+	void set_coeffs(const std::vector<GF1<p>>& coeffs) {
+		size_t n = val.get_num_rows();
+		const std::vector<GF1<p>>& modulus = context->get_modulus();
+		for (size_t i = 0; i < n; i++) {
+			val(n - i - 1, n - 1) = coeffs[i];
+		}
+		for (size_t col = n - 1; col > 0; col--) {
+			GF1<p> bottom = val(0, col);
+			for (size_t row = 0; row + 1 < n; row++) {
+				val(row, col - 1) = val(row + 1, col) - modulus[n - 1 - row] * bottom;
+			}
+			val(n - 1, col - 1) = -(modulus[0] * bottom);
+		}
+	}
+
+	const Field_Context<p> * context = nullptr;
 	Matrix<GF1<p>> val;
-	Matrix<GF1<p>> lambda;
 };
 
 template<typename T, std::enable_if_t<std::is_base_of_v<GF_Mat_Base, T>, bool> = true>
@@ -209,8 +254,8 @@ constexpr T one(const void * other_data = nullptr) {
 	return T::one(other_data);
 }
 
-template<unsigned int p>
-std::ostream& operator<<(std::ostream& s, const GF_Mat<p>& value) {
+template<unsigned int p, typename Tag>
+std::ostream& operator<<(std::ostream& s, const GF_Mat<p, Tag>& value) {
 	s << value.to_poly();
 	return s;
 }
@@ -0,0 +1,618 @@
+#pragma once
+#include "field-context.hpp"
+#include "finite-field.hpp"
+#include "gf-matrix.hpp"
+#include "gf-poly.hpp"
+#include "identities.hpp"
+#include "polynomial.hpp"
+#include "remove-v-tables.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace cherry {
+
+// A normal basis of GF(p^n) is one of the form b, b^p, b^(p^2), ...,
+// b^(p^(n - 1)) for some normal element b. Raising to the p is linear and
+// sends each basis element to the next one, so in this basis the Frobenius
+// map is just rotating the coordinates.
+//
+// Multiplying is where it costs something. With a_i and b_i the coordinates
+// of two elements, the coordinate l of their product is
+//
+//     sum over (i, j) of M_ij a_(i + l) b_(j + l)
+//
+// where M_ij is coordinate 0 of b^(p^i) b^(p^j) and the indices wrap around
+// mod n. M is sparse for a good choice of b, and an optimal normal basis
+// has only 2n - 1 nonzero entries, so the basis picks the normal element
+// with the fewest nonzero entries it can find.
+template<uint32_t p>
+class Normal_Basis {
+public:
+	using Coeffs = std::vector<GF1<p>>;
+
+	// How many normal elements get compared before settling for the best
+	// one so far. Each one costs O(n^3) to check.
+	static constexpr size_t max_candidates = 32;
+
+	// Random elements are normal often enough that not finding one after
+	// this many tries means the polynomial wasn't irreducible.
+	static constexpr size_t max_tries = 2048;
+
+	// Fields with at most this many elements get searched exhaustively.
+	static constexpr uint64_t exhaustive_search_max = 256;
+
+	// Bases get built the first time a field gets used and are shared by
+	// every element of that field until the program ends.
+	static const Normal_Basis<p> * get(const Field_Context<p> * context) {
+		static std::mutex mutex;
+		static std::map<const Field_Context<p> *, std::unique_ptr<Normal_Basis<p>>> bases;
+		std::lock_guard<std::mutex> lock(mutex);
+		auto& basis = bases[context];
+		if (!basis) {
+			basis.reset(new Normal_Basis<p>(context));
+		}
+		return basis.get();
+	}
+
+	const Field_Context<p> * get_context() const {
+		return context;
+	}
+
+	size_t degree() const {
+		return n;
+	}
+
+	// The normal element, in the polynomial basis.
+	const Coeffs& get_element() const {
+		return conjugates[0];
+	}
+
+	// The number of nonzero entries of M, which is what multiplying costs.
+	// It's at least 2n - 1, and a basis that gets there is optimal.
+	size_t complexity() const {
+		return products.size();
+	}
+
+	bool is_optimal() const {
+		return products.size() == 2 * n - 1;
+	}
+
+	// The trace of the normal element, which is nonzero. Every basis
+	// element has the same trace.
+	const GF1<p>& get_trace() const {
+		return trace;
+	}
+
+	Coeffs to_poly(const Coeffs& coords) const {
+		return apply(conjugates, coords);
+	}
+
+	Coeffs from_poly(const Coeffs& poly) const {
+		return apply(inverse, poly);
+	}
+
+	// The coordinates of c in GF(p), which are all c / Tr(b).
+	Coeffs scalar(const GF1<p>& c) const {
+		return Coeffs(n, c * trace_inv);
+	}
+
+	// Rotates coordinates k places, which is a^(p^k).
+	Coeffs frobenius(const Coeffs& a, uint64_t k = 1) const {
+		Coeffs out(n);
+		k %= n;
+		for (size_t i = 0; i < n; i++) {
+			out[(i + k) % n] = a[i];
+		}
+		return out;
+	}
+
+	Coeffs mul(const Coeffs& a, const Coeffs& b) const {
+		Coeffs out(n, GF1<p>{0});
+		for (size_t l = 0; l < n; l++) {
+			// M is stored row by row, so each row's sum only needs to get
+			// multiplied by a once.
+			Accumulator<GF1<p>> sum{GF1<p>{0}};
+			size_t k = 0;
+			while (k < products.size()) {
+				size_t i = std::get<0>(products[k]);
+				Accumulator<GF1<p>> row{GF1<p>{0}};
+				for (; k < products.size() && std::get<0>(products[k]) == i; k++) {
+					row.add_product(std::get<2>(products[k]), b[(std::get<1>(products[k]) + l) % n]);
+				}
+				sum.add_product(a[(i + l) % n], row.result());
+			}
+			out[l] = sum.result();
+		}
+		return out;
+	}
+private:
+	Normal_Basis(const Field_Context<p> * ctx) :
+		context(ctx),
+		n(ctx->degree())
+	{
+		size_t found = 0;
+		uint64_t order = context->multiplicative_order_bound();
+		// Small fields just get searched exhaustively, so they always end
+		// up with the best basis there is.
+		bool exhaustive = order != 0 && order <= exhaustive_search_max;
+		uint64_t seed = 0x9e3779b97f4a7c15;
+		// An optimal normal basis of type I exists exactly when n + 1 is
+		// prime and p generates the units mod n + 1, and its normal element
+		// is any primitive (n + 1)th root of unity.
+		if (order != 0 && has_type_one_basis()) {
+			for (size_t tries = 0; tries < max_tries && found == 0; tries++) {
+				Coeffs root = context->pow(random_element(seed), order / (n + 1));
+				if (!(root == scalar_one())) {
+					found += try_candidate(root);
+				}
+			}
+		}
+		if (exhaustive) {
+			for (uint64_t index = 1; index <= order && !is_optimal(); index++) {
+				found += try_candidate(element_at(index));
+			}
+		} else {
+			for (size_t tries = 0; tries < max_tries && found < max_candidates && !is_optimal(); tries++) {
+				found += try_candidate(random_element(seed));
+			}
+		}
+		if (found == 0) {
+			throw std::invalid_argument("Couldn't find a normal element, so the polynomial probably isn't irreducible.");
+		}
+		trace = GF1<p>{0};
+		for (const auto& conjugate : conjugates) {
+			trace += conjugate[0];
+		}
+		trace_inv = cherry::inv(trace);
+	}
+
+	// Keeps b if it's normal and beats the best basis so far. Returns
+	// whether b was normal.
+	bool try_candidate(const Coeffs& b) {
+		std::vector<Coeffs> b_conjugates{ b };
+		for (size_t i = 1; i < n; i++) {
+			b_conjugates.push_back(context->frobenius(b_conjugates.back(), 1));
+		}
+		std::vector<Coeffs> b_inverse;
+		if (!invert(b_conjugates, b_inverse)) {
+			return false;
+		}
+		// Row k of T is the coordinates of b b^(p^k), and since
+		// b^(p^i) b^(p^j) = (b b^(p^(j - i)))^(p^i), M_ij is T_(j - i, -i).
+		std::vector<Coeffs> t;
+		for (size_t k = 0; k < n; k++) {
+			t.push_back(apply(b_inverse, context->mul_mod(b, b_conjugates[k])));
+		}
+		std::vector<std::tuple<size_t, size_t, GF1<p>>> b_products;
+		for (size_t i = 0; i < n; i++) {
+			for (size_t j = 0; j < n; j++) {
+				const GF1<p>& entry = t[(j + n - i) % n][(n - i) % n];
+				if (!(entry == GF1<p>{0})) {
+					b_products.emplace_back(i, j, entry);
+				}
+			}
+		}
+		if (conjugates.empty() || b_products.size() < products.size()) {
+			conjugates = std::move(b_conjugates);
+			inverse = std::move(b_inverse);
+			products = std::move(b_products);
+		}
+		return true;
+	}
+
+	// columns are the columns of a matrix. Fills out the columns of its
+	// inverse with Gauss-Jordan, or returns false if it's singular.
+	bool invert(const std::vector<Coeffs>& columns, std::vector<Coeffs>& out) const {
+		// Row r of the augmented matrix is [A_r | I_r].
+		std::vector<Coeffs> rows(n, Coeffs(2 * n, GF1<p>{0}));
+		for (size_t r = 0; r < n; r++) {
+			for (size_t c = 0; c < n; c++) {
+				rows[r][c] = columns[c][r];
+			}
+			rows[r][n + r] = GF1<p>{1};
+		}
+		for (size_t c = 0; c < n; c++) {
+			size_t pivot = c;
+			while (pivot < n && rows[pivot][c] == GF1<p>{0}) {
+				pivot++;
+			}
+			if (pivot == n) {
+				return false;
+			}
+			std::swap(rows[pivot], rows[c]);
+			GF1<p> scale = cherry::inv(rows[c][c]);
+			for (auto& entry : rows[c]) {
+				entry *= scale;
+			}
+			for (size_t r = 0; r < n; r++) {
+				if (r == c || rows[r][c] == GF1<p>{0}) {
+					continue;
+				}
+				GF1<p> factor = rows[r][c];
+				for (size_t k = c; k < 2 * n; k++) {
+					rows[r][k] -= factor * rows[c][k];
+				}
+			}
+		}
+		out.assign(n, Coeffs(n));
+		for (size_t r = 0; r < n; r++) {
+			for (size_t c = 0; c < n; c++) {
+				out[c][r] = rows[r][n + c];
+			}
+		}
+		return true;
+	}
+
+	Coeffs apply(const std::vector<Coeffs>& columns, const Coeffs& a) const {
+		std::vector<Accumulator<GF1<p>>> sums(n, Accumulator<GF1<p>>{GF1<p>{0}});
+		for (size_t i = 0; i < n; i++) {
+			if (a[i] == GF1<p>{0}) {
+				continue;
+			}
+			for (size_t j = 0; j < n; j++) {
+				sums[j].add_product(a[i], columns[i][j]);
+			}
+		}
+		Coeffs out;
+		out.reserve(n);
+		for (auto& sum : sums) {
+			out.push_back(sum.result());
+		}
+		return out;
+	}
+
+	// The element whose coefficients are the digits of index in base p.
+	Coeffs element_at(uint64_t index) const {
+		Coeffs out(n, GF1<p>{0});
+		for (size_t i = 0; i < n && index > 0; i++) {
+			out[i] = GF1<p>{index % p};
+			index /= p;
+		}
+		return out;
+	}
+
+	// A deterministic stream of random elements, so every run picks the
+	// same basis.
+	Coeffs random_element(uint64_t& seed) const {
+		Coeffs out;
+		out.reserve(n);
+		for (size_t i = 0; i < n; i++) {
+			out.emplace_back(next_random(seed) % p);
+		}
+		return out;
+	}
+
+	Coeffs scalar_one() const {
+		Coeffs out(n, GF1<p>{0});
+		out[0] = GF1<p>{1};
+		return out;
+	}
+
+	bool has_type_one_basis() const {
+		uint64_t m = n + 1;
+		for (uint64_t d = 2; d * d <= m; d++) {
+			if (m % d == 0) {
+				return false;
+			}
+		}
+		// p has order n mod n + 1.
+		uint64_t power = 1;
+		for (size_t i = 1; i <= n; i++) {
+			power = power * (p % m) % m;
+			if (power == 1) {
+				return i == n;
+			}
+		}
+		return false;
+	}
+
+	const Field_Context<p> * context;
+	size_t n;
+	// b^(p^i) in the polynomial basis, which are the columns of the change
+	// of basis to the polynomial basis.
+	std::vector<Coeffs> conjugates;
+	// The columns of the change of basis from the polynomial basis.
+	std::vector<Coeffs> inverse;
+	// The nonzero entries (i, j, M_ij) of M, sorted by row.
+	std::vector<std::tuple<size_t, size_t, GF1<p>>> products;
+	GF1<p> trace;
+	GF1<p> trace_inv;
+};
+
+// GF(p^n) in a normal basis, so an element is its n coordinates with respect
+// to b, b^p, ..., b^(p^(n - 1)). Frobenius maps are rotations, which makes
+// this the representation to use when most of the work is raising things to
+// powers of p, and inverting takes O(log n) multiplications with
+// Itoh-Tsujii. Multiplying costs O(n^2) with an optimal normal basis and up
+// to O(n^3) without one, and converting to or from the polynomial basis is a
+// matrix-vector product. Use it as GF<p, GF_Normal<p>>. Tag works the same
+// way it does for GF_Mat.
+template<uint32_t p, typename Tag = void>
+class GF_Normal COLON_IN_CLASS_INHERITANCE DIVISION_RING(GF_Normal<p COMMA Tag>) {
+public:
+	using Coeffs = std::vector<GF1<p>>;
+
+	GF_Normal() {}
+
+	GF_Normal(const Polynomial<GF1<p>>& irreducible) : GF_Normal(Field_Context<p>::get(irreducible)) {}
+
+	// vals is a polynomial, like for every other representation.
+	GF_Normal(const Polynomial<GF1<p>>& irreducible, const Polynomial<GF1<p>>& vals) :
+		GF_Normal(Field_Context<p>::get(irreducible), vals)
+	{}
+
+	explicit GF_Normal(const Field_Context<p> * ctx) :
+		basis(Normal_Basis<p>::get(ctx)),
+		val(ctx->degree(), GF1<p>{0})
+	{}
+
+	GF_Normal(const Field_Context<p> * ctx, const Polynomial<GF1<p>>& vals) :
+		basis(Normal_Basis<p>::get(ctx)),
+		val(basis->from_poly(ctx->reduce_poly(vals)))
+	{}
+
+	explicit GF_Normal(const GF_Mat<p, Tag>& other) : GF_Normal(other.get_context(), other.to_poly()) {}
+
+	explicit GF_Normal(const GF_Poly<p, Tag>& other) : GF_Normal(other.get_context(), other.to_poly()) {}
+
+	// Builds an element straight from its coordinates in the normal basis.
+	static GF_Normal from_coords(const Field_Context<p> * ctx, const Coeffs& coords) {
+		GF_Normal out{ ctx };
+		if (coords.size() != out.val.size()) {
+			throw std::invalid_argument("An element of GF(p^n) needs exactly n coordinates.");
+		}
+		out.val = coords;
+		return out;
+	}
+
+	GF_Normal operator+(const GF_Normal& other) const OVERRIDE {
+		GF_Normal out{ *this };
+		out += other;
+		return out;
+	}
+
+	GF_Normal& operator+=(const GF_Normal& other) OVERRIDE {
+		check_if_same_polynomial(other);
+		for (size_t i = 0; i < val.size(); i++) {
+			val[i] += other.val[i];
+		}
+		return *this;
+	}
+
+	GF_Normal operator-() const OVERRIDE {
+		GF_Normal out{ *this };
+		out.negate();
+		return out;
+	}
+
+	void negate() OVERRIDE {
+		for (auto& coeff : val) {
+			coeff.negate();
+		}
+	}
+
+	GF_Normal operator-(const GF_Normal& other) const OVERRIDE {
+		GF_Normal out{ *this };
+		out -= other;
+		return out;
+	}
+
+	GF_Normal& operator-=(const GF_Normal& other) OVERRIDE {
+		check_if_same_polynomial(other);
+		for (size_t i = 0; i < val.size(); i++) {
+			val[i] -= other.val[i];
+		}
+		return *this;
+	}
+
+	GF_Normal operator*(const GF_Normal& other) const OVERRIDE {
+		GF_Normal out{ *this };
+		out *= other;
+		return out;
+	}
+
+	GF_Normal& operator*=(const GF_Normal& other) OVERRIDE {
+		check_if_same_polynomial(other);
+		val = basis->mul(val, other.val);
+		return *this;
+	}
+
+	GF_Normal operator*(const GF1<p>& other) const {
+		GF_Normal out{ *this };
+		out *= other;
+		return out;
+	}
+
+	GF_Normal& operator*=(const GF1<p>& other) {
+		for (auto& coeff : val) {
+			coeff *= other;
+		}
+		return *this;
+	}
+
+	GF_Normal operator/(const GF_Normal& other) const OVERRIDE {
+		return (*this) * other.inv();
+	}
+
+	GF_Normal& operator/=(const GF_Normal& other) OVERRIDE {
+		(*this) *= other.inv();
+		return *this;
+	}
+
+	GF_Normal operator^(int pow) const OVERRIDE {
+		if (pow < 0) {
+			return inv().pow_u(-static_cast<int64_t>(pow));
+		}
+		return pow_u(pow);
+	}
+
+	// Reads the exponent in base p for small p, since every digit only costs
+	// a rotation and at most one multiplication.
+	GF_Normal pow_u(uint64_t pow) const OVERRIDE {
+		GF_Normal out{ *this };
+		out.to_identity();
+		if (p > Field_Context<p>::frobenius_pow_max_p) {
+			GF_Normal square{ *this };
+			while (pow > 0) {
+				if (pow & 1) {
+					out *= square;
+				}
+				pow >>= 1;
+				if (pow > 0) {
+					square *= square;
+				}
+			}
+			return out;
+		}
+		std::vector<GF_Normal> table{ out, *this };
+		for (uint32_t d = 2; d < p; d++) {
+			table.push_back(table.back() * (*this));
+		}
+		std::vector<uint32_t> digits;
+		while (pow > 0) {
+			digits.push_back(static_cast<uint32_t>(pow % p));
+			pow /= p;
+		}
+		for (size_t i = digits.size(); i-- > 0;) {
+			out.val = basis->frobenius(out.val, 1);
+			if (digits[i] != 0) {
+				out *= table[digits[i]];
+			}
+		}
+		return out;
+	}
+
+	// this^(p^k), which is a rotation.
+	GF_Normal frobenius(uint64_t k = 1) const {
+		GF_Normal out{ *this };
+		out.val = basis->frobenius(val, k);
+		return out;
+	}
+
+	// Every basis element has the same trace, so this is just the sum of the
+	// coordinates times that.
+	GF1<p> trace() const {
+		GF1<p> sum{0};
+		for (const auto& c : val) {
+			sum += c;
+		}
+		return sum * basis->get_trace();
+	}
+
+	// Itoh-Tsujii through the same itoh_tsujii_chain as
+	// Field_Context::inv_itoh_tsujii, but every Frobenius map is free here.
+	GF_Normal inv() const OVERRIDE {
+		if (std::all_of(val.begin(), val.end(), [](const GF1<p>& c) { return c == GF1<p>{0}; })) {
+			throw std::domain_error(
+				"Trying to take the multiplicative inverse of "
+				"the additive identity (i.e. dividing by zero)."
+			);
+		}
+		// a^(p + ... + p^(n - 1)), and times a it's the norm of a, which is
+		// in GF(p), so all its coordinates are norm / Tr(basis element).
+		GF_Normal almost = val.size() > 1 ? itoh_tsujii_chain(*this, val.size(),
+			[](const GF_Normal& x, const GF_Normal& y) { return x * y; },
+			[](const GF_Normal& x, uint64_t k) { return x.frobenius(k); }
+		) : basis_one();
+		GF1<p> norm = basis->mul(almost.val, val)[0] * basis->get_trace();
+		almost *= cherry::inv(norm);
+		return almost;
+	}
+
+	void check_if_same_polynomial(const GF_Normal& other) const {
+#ifdef FULL_FIELD_CHECKS
+		if (basis == other.basis || (basis && other.basis && basis->get_context()->get_modulus() == other.basis->get_context()->get_modulus())) {
+			return;
+		}
+#else
+		if (!std::is_void_v<Tag> || basis == other.basis) {
+			return;
+		}
+#endif
+		throw std::domain_error("These two elements come from different irreducible polynomials");
+	}
+
+	// The coordinates in the normal basis.
+	const Coeffs& get_val() const {
+		return val;
+	}
+
+	const Normal_Basis<p> * get_basis() const {
+		return basis;
+	}
+
+	const Field_Context<p> * get_context() const {
+		return basis->get_context();
+	}
+
+	// The irreducible polynomial, made monic.
+	Polynomial<GF1<p>> get_modulus() const {
+		return get_context()->get_irreducible();
+	}
+
+	bool operator==(const GF_Normal& other) const {
+		return val == other.val;
+	}
+
+	void to_identity() {
+		val = basis->scalar(GF1<p>{1});
+	}
+
+	// The same element in the polynomial basis.
+	Polynomial<GF1<p>> to_poly() const {
+		return basis->to_poly(val);
+	}
+
+	GF_Mat<p, Tag> to_gf_mat() const {
+		return { get_context(), to_poly() };
+	}
+
+	GF_Poly<p, Tag> to_gf_poly() const {
+		return { get_context(), to_poly() };
+	}
+
+	// Prints the polynomial, so it matches the other representations.
+	std::string to_string() const {
+		return to_poly().to_string();
+	}
+
+	explicit operator std::string() const {
+		return to_string();
+	}
+public:
+	static GF_Normal member_zero(const void * other_data) {
+		return { *static_cast<const Polynomial<GF1<p>>*>(other_data) };
+	}
+
+	static GF_Normal member_one(const void * other_data) {
+		GF_Normal out{ *static_cast<const Polynomial<GF1<p>>*>(other_data) };
+		out.to_identity();
+		return out;
+	}
+private:
+	GF_Normal basis_one() const {
+		GF_Normal out{ *this };
+		out.to_identity();
+		return out;
+	}
+
+	const Normal_Basis<p> * basis = nullptr;
+	Coeffs val;
+};
+
+template<uint32_t p, typename Tag>
+std::ostream& operator<<(std::ostream& s, const GF_Normal<p, Tag>& value) {
+	s << value.to_poly();
+	return s;
+}
+
+}
@@ -0,0 +1,493 @@
+#pragma once
+#include "field-context.hpp"
+#include "finite-field.hpp"
+#include "gf-log.hpp"
+#include "polynomial.hpp"
+#include "remove-v-tables.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// GF_Packed<p, n> only works for fields with at most this many elements.
+#ifndef GF_PACKED_MAX_ORDER
+#define GF_PACKED_MAX_ORDER (1 << 16)
+#endif
+
+namespace cherry {
+
+// How GF_Packed<p, n> lays out the n coefficients of an element in a single
+// uint64_t. Each coefficient gets its own field of bits, wide enough to hold
+// the sum of two coefficients plus one guard bit on top, so adding two
+// elements is one integer addition, and the guard bits say which fields went
+// past p and need p taken back off:
+//
+//     s = a + b
+//     t = s + (2^w - p) in every field, so bit w of a field is set iff s >= p
+//     a + b = s - p * (guard bits of t >> w)
+//
+// For p = 2, the fields are single bits and adding is just xor.
+template<uint32_t p, uint32_t n>
+struct GF_Packed_Layout {
+	static constexpr uint64_t order() {
+		uint64_t out = 1;
+		for (uint32_t i = 0; i < n; i++) {
+			out *= p;
+		}
+		return out;
+	}
+
+	static constexpr uint64_t q = order();
+	static_assert(n >= 1, "GF_Packed needs n to be at least 1.");
+	static_assert(q <= GF_PACKED_MAX_ORDER, "GF_Packed only supports fields with up to GF_PACKED_MAX_ORDER elements.");
+
+	// Bits for the sum of two coefficients, and then the whole field with
+	// its guard bit.
+	static constexpr uint32_t value_bits = p == 2 ? 1 : std::bit_width(2 * static_cast<uint64_t>(p) - 2);
+	static constexpr uint32_t field_bits = p == 2 ? 1 : value_bits + 1;
+	static_assert(field_bits * n <= 64, "GF_Packed needs all n coefficients to fit in 64 bits.");
+
+	static constexpr uint64_t repeat(uint64_t field) {
+		uint64_t out = 0;
+		for (uint32_t i = 0; i < n; i++) {
+			out |= field << (i * field_bits);
+		}
+		return out;
+	}
+
+	static constexpr uint64_t all_p = repeat(p);
+	static constexpr uint64_t all_offset = p == 2 ? 0 : repeat((uint64_t{1} << value_bits) - p);
+	static constexpr uint64_t all_guards = p == 2 ? 0 : repeat(uint64_t{1} << value_bits);
+	static constexpr uint64_t field_mask = (uint64_t{1} << field_bits) - 1;
+
+	// Takes p off of every field that's at least p, for fields below 2p.
+	static constexpr uint64_t reduce(uint64_t s) {
+		uint64_t over = ((s + all_offset) & all_guards) >> value_bits;
+		return s - over * p;
+	}
+
+	static constexpr uint64_t add(uint64_t a, uint64_t b) {
+		if constexpr (p == 2) {
+			return a ^ b;
+		} else {
+			return reduce(a + b);
+		}
+	}
+
+	static constexpr uint64_t negate(uint64_t a) {
+		if constexpr (p == 2) {
+			return a;
+		} else {
+			return reduce(all_p - a);
+		}
+	}
+
+	static constexpr uint32_t digit(uint64_t a, uint32_t i) {
+		return static_cast<uint32_t>((a >> (i * field_bits)) & field_mask);
+	}
+};
+
+// Everything GF_Packed<p, n> needs to multiply in one field. It borrows the
+// log and exp tables from GF_Log_Table, but keeps exp in packed form, so a
+// product is two logs, one addition and one lookup.
+//
+// Going from packed form to the index GF_Log_Table uses (c_0 + c_1 p + ...)
+// takes one lookup per group of coefficients, where each group fits in
+// group_bits bits. For p = 2, packed form already is the index, and when a
+// single coefficient doesn't fit in group_bits, it just reads the digits.
+template<uint32_t p, uint32_t n>
+class GF_Packed_Table {
+public:
+	using Layout = GF_Packed_Layout<p, n>;
+	static constexpr uint32_t q = static_cast<uint32_t>(Layout::q);
+	static constexpr uint32_t zero_log = GF_Log_Table<p>::zero_log;
+	static constexpr uint32_t group_bits = 12;
+	static constexpr bool use_groups = p != 2 && Layout::field_bits <= group_bits;
+	static constexpr uint32_t group_size = use_groups ? group_bits / Layout::field_bits : 1;
+	static constexpr uint32_t num_groups = (n + group_size - 1) / group_size;
+
+	static const GF_Packed_Table<p, n> * get(const Polynomial<GF1<p>>& irreducible) {
+		static std::mutex mutex;
+		static std::map<const GF_Log_Table<p> *, std::unique_ptr<GF_Packed_Table<p, n>>> tables;
+		const GF_Log_Table<p> * logs = GF_Log_Table<p>::get(irreducible);
+		if (logs->get_degree() != n) {
+			throw std::invalid_argument("GF_Packed<p, n> needs an irreducible polynomial of degree n.");
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		auto& table = tables[logs];
+		if (!table) {
+			table.reset(new GF_Packed_Table<p, n>(logs));
+		}
+		return table.get();
+	}
+
+	// c_0 + c_1 p + ... + c_(n - 1) p^(n - 1).
+	uint32_t to_index(uint64_t a) const {
+		if constexpr (p == 2) {
+			return static_cast<uint32_t>(a);
+		} else if constexpr (use_groups) {
+			uint32_t out = 0;
+			for (uint32_t g = 0; g < num_groups; g++) {
+				uint64_t bits = (a >> (g * group_size * Layout::field_bits)) & group_mask;
+				out += group_index[g][bits];
+			}
+			return out;
+		} else {
+			uint32_t out = 0;
+			for (uint32_t i = n; i-- > 0;) {
+				out = out * p + Layout::digit(a, i);
+			}
+			return out;
+		}
+	}
+
+	static uint64_t from_index(uint32_t index) {
+		uint64_t out = 0;
+		for (uint32_t i = 0; i < n; i++) {
+			out |= static_cast<uint64_t>(index % p) << (i * Layout::field_bits);
+			index /= p;
+		}
+		return out;
+	}
+
+	uint32_t log_of(uint64_t a) const {
+		return logs[to_index(a)];
+	}
+
+	uint64_t exp_of(uint32_t k) const {
+		return exp[k];
+	}
+
+	const Field_Context<p> * get_context() const {
+		return context;
+	}
+
+	// The trace is linear, so it's a dot product of the coefficients with
+	// the traces of 1, x, x^2, ..., which for p = 2 is a parity.
+	GF1<p> trace(uint64_t a) const {
+		if constexpr (p == 2) {
+			return GF1<p>{static_cast<uint64_t>(std::popcount(a & trace_mask) & 1)};
+		} else {
+			uint64_t sum = 0;
+			for (uint32_t i = 0; i < n; i++) {
+				sum += static_cast<uint64_t>(Layout::digit(a, i)) * traces[i];
+			}
+			return GF1<p>{sum % p};
+		}
+	}
+
+	uint64_t mul(uint64_t a, uint64_t b) const {
+		if (a == 0 || b == 0) {
+			return 0;
+		}
+		return exp[mod_order(log_of(a) + log_of(b))];
+	}
+
+	uint64_t inv(uint64_t a) const {
+		if (a == 0) {
+			throw std::domain_error(
+				"Trying to take the multiplicative inverse of "
+				"the additive identity (i.e. dividing by zero)."
+			);
+		}
+		uint32_t log = log_of(a);
+		return exp[log == 0 ? 0 : (q - 1) - log];
+	}
+
+	uint64_t pow(uint64_t a, int64_t power) const {
+		if (a == 0) {
+			if (power < 0) {
+				inv(a);
+			}
+			return power == 0 ? exp[0] : 0;
+		}
+		int64_t reduced = (static_cast<int64_t>(log_of(a)) * (power % static_cast<int64_t>(q - 1))) % static_cast<int64_t>(q - 1);
+		if (reduced < 0) {
+			reduced += q - 1;
+		}
+		return exp[reduced];
+	}
+
+	uint64_t pow_u(uint64_t a, uint64_t power) const {
+		if (a == 0) {
+			return power == 0 ? exp[0] : 0;
+		}
+		return exp[static_cast<uint64_t>(log_of(a)) * (power % (q - 1)) % (q - 1)];
+	}
+private:
+	static constexpr uint64_t group_mask = (uint64_t{1} << (group_size * Layout::field_bits)) - 1;
+
+	GF_Packed_Table(const GF_Log_Table<p> * log_table) :
+		context(log_table->get_context())
+	{
+		for (uint32_t i = 0; i < n; i++) {
+			traces.push_back(static_cast<uint32_t>(context->get_traces()[i].get_val()));
+			trace_mask |= static_cast<uint64_t>(traces.back() & 1) << i;
+		}
+		exp.reserve(q - 1);
+		for (uint32_t k = 0; k + 1 < q; k++) {
+			exp.push_back(from_index(log_table->index_of(k)));
+		}
+		logs.reserve(q);
+		for (uint32_t index = 0; index < q; index++) {
+			logs.push_back(log_table->log_of_index(index));
+		}
+		if constexpr (use_groups) {
+			uint32_t place = 1;
+			for (uint32_t g = 0; g < num_groups; g++) {
+				uint32_t digits = std::min(group_size, n - g * group_size);
+				std::vector<uint32_t> table(group_mask + 1, 0);
+				for (uint64_t bits = 0; bits <= group_mask; bits++) {
+					uint32_t index = 0;
+					uint32_t digit_place = place;
+					for (uint32_t i = 0; i < digits; i++) {
+						uint64_t digit = (bits >> (i * Layout::field_bits)) & Layout::field_mask;
+						index += static_cast<uint32_t>(digit % p) * digit_place;
+						digit_place *= p;
+					}
+					table[bits] = index;
+				}
+				for (uint32_t i = 0; i < digits; i++) {
+					place *= p;
+				}
+				group_index.push_back(std::move(table));
+			}
+		}
+	}
+
+	uint32_t mod_order(uint32_t a) const {
+		return a >= q - 1 ? a - (q - 1) : a;
+	}
+
+	std::vector<uint64_t> exp;
+	std::vector<uint32_t> logs;
+	std::vector<std::vector<uint32_t>> group_index;
+	const Field_Context<p> * context;
+	std::vector<uint32_t> traces;
+	uint64_t trace_mask = 0;
+};
+
+// GF(p^n) for fields with up to GF_PACKED_MAX_ORDER elements, stored as a
+// single packed integer (see GF_Packed_Layout). Adding is a handful of
+// integer operations on every coefficient at once, multiplying goes through
+// log tables, and nothing ever touches the heap after the tables get built,
+// which makes it the one to use for sweeping over every element of a field.
+// Use it as GF<p, GF_Packed<p, n>>, where n is the degree of the irreducible
+// polynomial. Tag works the same way it does for GF_Mat.
+template<uint32_t p, uint32_t n, typename Tag = void>
+class GF_Packed COLON_IN_CLASS_INHERITANCE DIVISION_RING(GF_Packed<p COMMA n COMMA Tag>) {
+public:
+	using Layout = GF_Packed_Layout<p, n>;
+	using Table = GF_Packed_Table<p, n>;
+
+	GF_Packed() {}
+
+	GF_Packed(const Polynomial<GF1<p>>& irreducible) :
+		table(Table::get(irreducible))
+	{}
+
+	GF_Packed(const Polynomial<GF1<p>>& irreducible, const Polynomial<GF1<p>>& vals) :
+		table(Table::get(irreducible))
+	{
+		// Horner's rule, with x as an element. For n = 1, x is the root of
+		// the polynomial.
+		uint64_t x = n > 1
+			? Table::from_index(p)
+			: Table::from_index(static_cast<uint32_t>((-irreducible[0] * cherry::inv(irreducible[1])).get_val()));
+		for (size_t i = vals.degree(); i <= vals.degree(); i--) {
+			val = Layout::add(table->mul(val, x), Table::from_index(static_cast<uint32_t>(vals[i].get_val())));
+		}
+	}
+
+	// The element whose coefficients are the digits of index in base p,
+	// which is how the tests sweep over a whole field.
+	static GF_Packed from_index(const Table * table, uint32_t index) {
+		GF_Packed out;
+		out.table = table;
+		out.val = Table::from_index(index);
+		return out;
+	}
+
+	GF_Packed operator+(const GF_Packed& other) const OVERRIDE {
+		GF_Packed out{ *this };
+		out += other;
+		return out;
+	}
+
+	GF_Packed& operator+=(const GF_Packed& other) OVERRIDE {
+		check_if_same_field(other);
+		val = Layout::add(val, other.val);
+		return *this;
+	}
+
+	GF_Packed operator-() const OVERRIDE {
+		GF_Packed out{ *this };
+		out.negate();
+		return out;
+	}
+
+	void negate() OVERRIDE {
+		val = Layout::negate(val);
+	}
+
+	GF_Packed operator-(const GF_Packed& other) const OVERRIDE {
+		GF_Packed out{ *this };
+		out -= other;
+		return out;
+	}
+
+	GF_Packed& operator-=(const GF_Packed& other) OVERRIDE {
+		check_if_same_field(other);
+		val = Layout::add(val, Layout::negate(other.val));
+		return *this;
+	}
+
+	GF_Packed operator*(const GF_Packed& other) const OVERRIDE {
+		GF_Packed out{ *this };
+		out *= other;
+		return out;
+	}
+
+	GF_Packed& operator*=(const GF_Packed& other) OVERRIDE {
+		check_if_same_field(other);
+		val = table->mul(val, other.val);
+		return *this;
+	}
+
+	GF_Packed operator*(const GF1<p>& other) const {
+		GF_Packed out{ *this };
+		out *= other;
+		return out;
+	}
+
+	GF_Packed& operator*=(const GF1<p>& other) {
+		val = table->mul(val, Table::from_index(static_cast<uint32_t>(other.get_val())));
+		return *this;
+	}
+
+	GF_Packed operator/(const GF_Packed& other) const OVERRIDE {
+		return (*this) * other.inv();
+	}
+
+	GF_Packed& operator/=(const GF_Packed& other) OVERRIDE {
+		(*this) *= other.inv();
+		return *this;
+	}
+
+	GF_Packed operator^(int pow) const OVERRIDE {
+		GF_Packed out{ *this };
+		out.val = table->pow(val, pow);
+		return out;
+	}
+
+	GF_Packed pow_u(uint64_t pow) const OVERRIDE {
+		GF_Packed out{ *this };
+		out.val = table->pow_u(val, pow);
+		return out;
+	}
+
+	GF_Packed inv() const OVERRIDE {
+		GF_Packed out{ *this };
+		out.val = table->inv(val);
+		return out;
+	}
+
+	// x^(p^k), which only has to multiply the log by p^k.
+	GF_Packed frobenius(uint64_t k = 1) const {
+		uint64_t power = 1;
+		for (uint64_t i = 0; i < k % n; i++) {
+			power *= p;
+		}
+		GF_Packed out{ *this };
+		out.val = table->pow(val, static_cast<int64_t>(power));
+		return out;
+	}
+
+	void check_if_same_field(const GF_Packed& other) const {
+#ifdef FULL_FIELD_CHECKS
+		if (table == other.table || (table && other.table && get_context()->get_modulus() == other.get_context()->get_modulus())) {
+			return;
+		}
+#else
+		if (!std::is_void_v<Tag> || table == other.table) {
+			return;
+		}
+#endif
+		throw std::domain_error("These two elements come from different irreducible polynomials");
+	}
+
+	// The packed coefficients.
+	uint64_t get_packed() const {
+		return val;
+	}
+
+	// c_0 + c_1 p + ... + c_(n - 1) p^(n - 1).
+	uint32_t get_index() const {
+		return table->to_index(val);
+	}
+
+	const Table * get_table() const {
+		return table;
+	}
+
+	const Field_Context<p> * get_context() const {
+		return table->get_context();
+	}
+
+	GF1<p> trace() const {
+		return table->trace(val);
+	}
+
+	bool operator==(const GF_Packed& other) const {
+		return val == other.val && table == other.table;
+	}
+
+	void to_identity() {
+		val = Table::from_index(1);
+	}
+
+	Polynomial<GF1<p>> to_poly() const {
+		std::vector<GF1<p>> coeffs;
+		coeffs.reserve(n);
+		for (uint32_t i = 0; i < n; i++) {
+			coeffs.emplace_back(Layout::digit(val, i));
+		}
+		return coeffs;
+	}
+
+	std::string to_string() const {
+		return to_poly().to_string();
+	}
+
+	explicit operator std::string() const {
+		return to_string();
+	}
+public:
+	static GF_Packed member_zero(const void * other_data) {
+		return { *static_cast<const Polynomial<GF1<p>>*>(other_data) };
+	}
+
+	static GF_Packed member_one(const void * other_data) {
+		GF_Packed out{ *static_cast<const Polynomial<GF1<p>>*>(other_data) };
+		out.to_identity();
+		return out;
+	}
+private:
+	const Table * table = nullptr;
+	uint64_t val = 0;
+};
+
+template<uint32_t p, uint32_t n, typename Tag>
+std::ostream& operator<<(std::ostream& s, const GF_Packed<p, n, Tag>& value) {
+	s << value.to_poly();
+	return s;
+}
+
+}
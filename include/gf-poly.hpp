@@ -0,0 +1,219 @@
+#pragma once
+#include "field-context.hpp"
+#include "finite-field.hpp"
+#include "identities.hpp"
+#include "polynomial-multiply.hpp"
+#include "polynomial.hpp"
+#include "remove-v-tables.hpp"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace cherry {
+
+// GF(p^n) in the polynomial basis: an element is its n coefficients mod the
+// irreducible polynomial, from lowest degree to highest. Multiplying is a
+// polynomial product (from Polynomial_Multiplier, so Karatsuba, Toom-3 or the
+// NTT once n gets big enough) followed by reducing mod the irreducible
+// polynomial, and inverting uses the extended Euclidean
+// algorithm. Everything that only depends on the irreducible polynomial
+// lives in its Field_Context. Use it as GF<p, GF_Poly<p>>. Tag works the same
+// way it does for GF_Mat.
+template<uint32_t p, typename Tag = void>
+class GF_Poly COLON_IN_CLASS_INHERITANCE DIVISION_RING(GF_Poly<p COMMA Tag>) {
+public:
+	using Coeffs = std::vector<GF1<p>>;
+
+	GF_Poly() {}
+
+	GF_Poly(const Polynomial<GF1<p>>& irreducible) : GF_Poly(Field_Context<p>::get(irreducible)) {}
+
+	GF_Poly(const Polynomial<GF1<p>>& irreducible, const Polynomial<GF1<p>>& vals) :
+		GF_Poly(Field_Context<p>::get(irreducible), vals)
+	{}
+
+	explicit GF_Poly(const Field_Context<p> * ctx) :
+		context(ctx),
+		val(ctx->degree(), GF1<p>{0})
+	{}
+
+	GF_Poly(const Field_Context<p> * ctx, const Polynomial<GF1<p>>& vals) :
+		context(ctx),
+		val(ctx->reduce_poly(vals))
+	{}
+
+	GF_Poly operator+(const GF_Poly& other) const OVERRIDE {
+		GF_Poly out{ *this };
+		out += other;
+		return out;
+	}
+
+	GF_Poly& operator+=(const GF_Poly& other) OVERRIDE {
+		check_if_same_polynomial(other);
+		for (size_t i = 0; i < val.size(); i++) {
+			val[i] += other.val[i];
+		}
+		return *this;
+	}
+
+	GF_Poly operator-() const OVERRIDE {
+		GF_Poly out{ *this };
+		out.negate();
+		return out;
+	}
+
+	void negate() OVERRIDE {
+		for (auto& coeff : val) {
+			coeff.negate();
+		}
+	}
+
+	GF_Poly operator-(const GF_Poly& other) const OVERRIDE {
+		GF_Poly out{ *this };
+		out -= other;
+		return out;
+	}
+
+	GF_Poly& operator-=(const GF_Poly& other) OVERRIDE {
+		check_if_same_polynomial(other);
+		for (size_t i = 0; i < val.size(); i++) {
+			val[i] -= other.val[i];
+		}
+		return *this;
+	}
+
+	GF_Poly operator*(const GF_Poly& other) const OVERRIDE {
+		GF_Poly out{ *this };
+		out *= other;
+		return out;
+	}
+
+	GF_Poly& operator*=(const GF_Poly& other) OVERRIDE {
+		check_if_same_polynomial(other);
+		Coeffs product(2 * val.size() - 1, GF1<p>{0});
+		Polynomial_Multiplier<GF1<p>>::multiply(val.data(), val.size(), other.val.data(), other.val.size(), product.data());
+		context->reduce(product);
+		val = std::move(product);
+		return *this;
+	}
+
+	GF_Poly operator*(const GF1<p>& other) const {
+		GF_Poly out{ *this };
+		out *= other;
+		return out;
+	}
+
+	GF_Poly& operator*=(const GF1<p>& other) {
+		for (auto& coeff : val) {
+			coeff *= other;
+		}
+		return *this;
+	}
+
+	GF_Poly operator/(const GF_Poly& other) const OVERRIDE {
+		return (*this) * other.inv();
+	}
+
+	GF_Poly& operator/=(const GF_Poly& other) OVERRIDE {
+		(*this) *= other.inv();
+		return *this;
+	}
+
+	GF_Poly operator^(int pow) const OVERRIDE {
+		if (pow < 0) {
+			return inv().pow_u(-static_cast<int64_t>(pow));
+		}
+		return pow_u(pow);
+	}
+
+	GF_Poly pow_u(uint64_t pow) const OVERRIDE {
+		GF_Poly out{ *this };
+		out.val = context->pow(val, pow);
+		return out;
+	}
+
+	// this^(p^k).
+	GF_Poly frobenius(uint64_t k = 1) const {
+		GF_Poly out{ *this };
+		out.val = context->frobenius(val, k);
+		return out;
+	}
+
+	GF_Poly inv() const OVERRIDE {
+		GF_Poly out{ *this };
+		out.val = context->inv_mod(val);
+		return out;
+	}
+
+	void check_if_same_polynomial(const GF_Poly& other) const {
+#ifdef FULL_FIELD_CHECKS
+		if (context == other.context || (context && other.context && context->get_modulus() == other.context->get_modulus())) {
+			return;
+		}
+#else
+		if (!std::is_void_v<Tag> || context == other.context) {
+			return;
+		}
+#endif
+		throw std::domain_error("These two elements come from different irreducible polynomials");
+	}
+
+	const Coeffs& get_val() const {
+		return val;
+	}
+
+	// The irreducible polynomial, made monic.
+	Polynomial<GF1<p>> get_modulus() const {
+		return context->get_irreducible();
+	}
+
+	const Field_Context<p> * get_context() const {
+		return context;
+	}
+
+	bool operator==(const GF_Poly& other) const {
+		return val == other.val;
+	}
+
+	void to_identity() {
+		std::fill(val.begin(), val.end(), GF1<p>{0});
+		val[0] = GF1<p>{1};
+	}
+
+	Polynomial<GF1<p>> to_poly() const {
+		return val;
+	}
+
+	std::string to_string() const {
+		return to_poly().to_string();
+	}
+
+	explicit operator std::string() const {
+		return to_string();
+	}
+public:
+	static GF_Poly member_zero(const void * other_data) {
+		return { *static_cast<const Polynomial<GF1<p>>*>(other_data) };
+	}
+
+	static GF_Poly member_one(const void * other_data) {
+		GF_Poly out{ *static_cast<const Polynomial<GF1<p>>*>(other_data) };
+		out.to_identity();
+		return out;
+	}
+
+private:
+	const Field_Context<p> * context = nullptr;
+	Coeffs val;
+};
+
+template<uint32_t p, typename Tag>
+std::ostream& operator<<(std::ostream& s, const GF_Poly<p, Tag>& value) {
+	s << value.to_poly();
+	return s;
+}
+
+}
@@ -1,8 +1,21 @@
 #pragma once
 #include "abelian-group.hpp"
 #include "division-ring.hpp"
+#include "field-context.hpp"
+#include "gf-ext.hpp"
+#include "gf-log.hpp"
 #include "gf-matrix.hpp"
+#include "gf-normal.hpp"
+#include "gf-packed.hpp"
+#include "gf-poly.hpp"
+#include "gf1-dynamic.hpp"
+#include "gf1-large.hpp"
+#include "gf1-ntt.hpp"
+#include "gf2n.hpp"
 #include "finite-field.hpp"
 #include "matrix.hpp"
+#include "matrix-gf2.hpp"
+#include "polynomial-factor.hpp"
+#include "polynomial-gcd.hpp"
 #include "polynomial.hpp"
 #include "ring.hpp"
@@ -0,0 +1,372 @@
+#pragma once
+#include "finite-field.hpp"
+#include "identities.hpp"
+#include "remove-v-tables.hpp"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace cherry {
+
+// Everything GF1_Dyn needs to know about its modulus, computed once when the
+// context is made. Elements only keep a pointer to it, so the context has to
+// outlive every element that uses it. The easiest way to do that is to keep
+// it in a shared_ptr and hand that to any Matrix you make, the same way you
+// would with the irreducible polynomial for GF<p>.
+class GF1_Context {
+public:
+	GF1_Context(uint32_t modulus) :
+		p(checked_modulus(modulus)),
+		barrett_reciprocal(UINT64_MAX / p),
+		r2_mod_p(0),
+		p_inv(0)
+	{
+		if (p % 2 == 1) {
+			p_inv = p;
+			for (int i = 0; i < 5; i++) {
+				p_inv *= 2 - p * p_inv;
+			}
+			uint64_t r_mod_p = (uint64_t{1} << 32) % p;
+			r2_mod_p = r_mod_p * r_mod_p % p;
+		}
+	}
+
+	uint32_t modulus() const {
+		return p;
+	}
+
+	// Barrett reduction of anything that fits in 64 bits. The reciprocal is
+	// rounded down, so the estimated quotient is at most one too small.
+	uint64_t reduce(uint64_t v) const {
+		uint64_t q = static_cast<uint64_t>(
+			(static_cast<unsigned __int128>(v) * barrett_reciprocal) >> 64
+		);
+		uint64_t r = v - q * p;
+		return r >= p ? r - p : r;
+	}
+
+	uint64_t reduce(unsigned __int128 v) const {
+		uint64_t hi = reduce(static_cast<uint64_t>(v >> 64));
+		uint64_t lo = reduce(static_cast<uint64_t>(v));
+		// 2^64 mod p is (2^64 - 1) mod p + 1.
+		uint64_t two_64 = reduce(UINT64_MAX) + 1;
+		return reduce(reduce(hi * two_64) + lo);
+	}
+
+	uint64_t mul(uint64_t a, uint64_t b) const {
+		return reduce(a * b);
+	}
+
+	bool has_montgomery() const {
+		return p % 2 == 1;
+	}
+
+	// Montgomery form with R = 2^32, using the signed variant of REDC so that
+	// nothing overflows. Only available for odd p.
+	uint64_t redc(uint64_t v) const {
+		uint32_t m = static_cast<uint32_t>(v) * p_inv;
+		uint64_t v_hi = v >> 32;
+		uint64_t mp_hi = (static_cast<uint64_t>(m) * p) >> 32;
+		return v_hi >= mp_hi ? v_hi - mp_hi : v_hi - mp_hi + p;
+	}
+
+	uint64_t to_montgomery(uint64_t v) const {
+		return redc(v * r2_mod_p);
+	}
+
+	uint64_t from_montgomery(uint64_t v) const {
+		return redc(v);
+	}
+
+	uint64_t montgomery_mul(uint64_t a, uint64_t b) const {
+		return redc(a * b);
+	}
+private:
+	// Runs before anything gets divided by the modulus, so 0 and 1 throw
+	// like every other non-prime.
+	static uint32_t checked_modulus(uint32_t modulus) {
+		if (!is_prime(modulus)) {
+			throw std::invalid_argument(
+				"GF1_Context needs a prime modulus, but " +
+				std::to_string(modulus) + " isn't prime."
+			);
+		}
+		return modulus;
+	}
+
+	uint32_t p;
+	uint64_t barrett_reciprocal;
+	uint64_t r2_mod_p;
+	uint32_t p_inv;
+};
+
+// GF(p) for a p that isn't known until runtime. The modulus lives in a
+// GF1_Context that every element points to, so you can pick primes from a
+// config file or loop over hundreds of them without instantiating anything
+// new.
+//
+// Elements made without a context (which is what zero<GF1_Dyn>() and
+// one<GF1_Dyn>() give you without other_data) are plain non-negative
+// integers. They pick up a context as soon as they meet an element that has
+// one. Arithmetic between two of them works as long as the result stays a
+// non-negative integer.
+class GF1_Dyn COLON_IN_CLASS_INHERITANCE DIVISION_RING(GF1_Dyn) {
+public:
+	GF1_Dyn() : ctx(nullptr), val(0) {}
+	GF1_Dyn(uint64_t v) : ctx(nullptr), val(v) {}
+	GF1_Dyn(const GF1_Context * context, uint64_t v) :
+		ctx(context),
+		val(context ? context->reduce(v) : v)
+	{}
+	GF1_Dyn(const GF1_Context& context, uint64_t v) : GF1_Dyn(&context, v) {}
+
+	GF1_Dyn operator+(const GF1_Dyn& other) const OVERRIDE {
+		GF1_Dyn out{ *this };
+		out += other;
+		return out;
+	}
+
+	GF1_Dyn& operator+=(const GF1_Dyn& other) OVERRIDE {
+		uint64_t other_val = match_context(other);
+		val += other_val;
+		if (ctx && val >= ctx->modulus()) {
+			val -= ctx->modulus();
+		}
+		return *this;
+	}
+
+	GF1_Dyn operator-() const OVERRIDE {
+		GF1_Dyn out{ *this };
+		out.negate();
+		return out;
+	}
+
+	void negate() OVERRIDE {
+		if (val == 0) {
+			return;
+		}
+		if (!ctx) {
+			throw_negative_without_context();
+		}
+		val = ctx->modulus() - val;
+	}
+
+	GF1_Dyn operator-(const GF1_Dyn& other) const OVERRIDE {
+		GF1_Dyn out{ *this };
+		out -= other;
+		return out;
+	}
+
+	GF1_Dyn& operator-=(const GF1_Dyn& other) OVERRIDE {
+		uint64_t other_val = match_context(other);
+		if (val >= other_val) {
+			val -= other_val;
+		} else if (ctx) {
+			val += ctx->modulus() - other_val;
+		} else {
+			throw_negative_without_context();
+		}
+		return *this;
+	}
+
+	GF1_Dyn operator*(const GF1_Dyn& other) const OVERRIDE {
+		GF1_Dyn out{ *this };
+		out *= other;
+		return out;
+	}
+
+	GF1_Dyn& operator*=(const GF1_Dyn& other) OVERRIDE {
+		uint64_t other_val = match_context(other);
+		val = ctx ? ctx->mul(val, other_val) : val * other_val;
+		return *this;
+	}
+
+	GF1_Dyn operator/(const GF1_Dyn& other) const OVERRIDE {
+		return *this * other.inv();
+	}
+
+	GF1_Dyn& operator/=(const GF1_Dyn& other) OVERRIDE {
+		*this *= other.inv();
+		return *this;
+	}
+
+	// Extended Euclid on the integers, which takes O(log p) steps without
+	// any multiplications mod p.
+	GF1_Dyn inv() const OVERRIDE {
+		if (val == 0) {
+			throw std::domain_error(
+				"Trying to take the multiplicative inverse of "
+				"the additive identity (i.e. dividing by zero)."
+			);
+		}
+		if (!ctx) {
+			if (val == 1) {
+				return *this;
+			}
+			throw std::domain_error(
+				"Can't invert a GF1_Dyn that doesn't have a GF1_Context."
+			);
+		}
+		int64_t r0 = ctx->modulus();
+		int64_t r1 = static_cast<int64_t>(val);
+		int64_t t0 = 0;
+		int64_t t1 = 1;
+		while (r1 != 0) {
+			int64_t q = r0 / r1;
+			int64_t r2 = r0 - q * r1;
+			int64_t t2 = t0 - q * t1;
+			r0 = r1;
+			r1 = r2;
+			t0 = t1;
+			t1 = t2;
+		}
+		if (t0 < 0) {
+			t0 += ctx->modulus();
+		}
+		return GF1_Dyn{ctx, static_cast<uint64_t>(t0)};
+	}
+
+	GF1_Dyn operator^(int pow) const OVERRIDE {
+		if (pow >= 0) {
+			return pow_u(static_cast<uint32_t>(pow));
+		}
+		return inv().pow_u(static_cast<uint32_t>(-static_cast<int64_t>(pow)));
+	}
+
+	// Square and multiply in Montgomery form, so the loop never divides.
+	GF1_Dyn pow_u(uint32_t pow) const OVERRIDE {
+		if (val <= 1 && (ctx || pow > 0)) {
+			return *this;
+		}
+		if (!ctx) {
+			GF1_Dyn out{1};
+			for (uint32_t i = 0; i < pow; i++) {
+				out *= *this;
+			}
+			return out;
+		}
+		pow %= ctx->modulus() - 1;
+		if (!ctx->has_montgomery()) {
+			return pow == 0 ? GF1_Dyn{ctx, 1} : *this;
+		}
+		uint64_t out = ctx->to_montgomery(1);
+		uint64_t val_pow = ctx->to_montgomery(val);
+		while (pow > 0) {
+			if (pow & 1) {
+				out = ctx->montgomery_mul(out, val_pow);
+			}
+			val_pow = ctx->montgomery_mul(val_pow, val_pow);
+			pow >>= 1;
+		}
+		return GF1_Dyn{ctx, ctx->from_montgomery(out)};
+	}
+
+	uint64_t get_val() const {
+		return val;
+	}
+
+	const GF1_Context * get_context() const {
+		return ctx;
+	}
+
+	bool operator==(const GF1_Dyn& other) const {
+		if (ctx == other.ctx) {
+			return val == other.val;
+		}
+		const GF1_Context * shared = shared_context(ctx, other.ctx);
+		return shared->reduce(val) == shared->reduce(other.val);
+	}
+
+	std::string to_string() const {
+		return std::to_string(val);
+	}
+
+	explicit operator std::string() const {
+		return to_string();
+	}
+
+	// Both contexts have to agree on the modulus. Returns the one to use,
+	// which is null only if neither element has a context.
+	static const GF1_Context * shared_context(const GF1_Context * a, const GF1_Context * b) {
+		if (a == b || b == nullptr) {
+			return a;
+		}
+		if (a == nullptr) {
+			return b;
+		}
+		if (a->modulus() != b->modulus()) {
+			throw std::domain_error(
+				"These two elements come from fields with different moduli."
+			);
+		}
+		return a;
+	}
+public:
+	static GF1_Dyn member_zero(const void * other_data = nullptr) {
+		return GF1_Dyn{static_cast<const GF1_Context*>(other_data), 0};
+	}
+
+	static GF1_Dyn member_one(const void * other_data = nullptr) {
+		return GF1_Dyn{static_cast<const GF1_Context*>(other_data), 1};
+	}
+private:
+	// The usual case is that both elements share a context, which costs one
+	// comparison. Otherwise, this element takes on the shared context, and
+	// anything that was a plain integer gets reduced.
+	uint64_t match_context(const GF1_Dyn& other) {
+		if (ctx == other.ctx) {
+			return other.val;
+		}
+		ctx = shared_context(ctx, other.ctx);
+		val = ctx->reduce(val);
+		return ctx->reduce(other.val);
+	}
+
+	[[noreturn]] static void throw_negative_without_context() {
+		throw std::domain_error(
+			"Can't make a negative GF1_Dyn without a GF1_Context."
+		);
+	}
+private:
+	const GF1_Context * ctx;
+	uint64_t val;
+};
+
+inline std::ostream& operator<<(std::ostream& s, const GF1_Dyn& value) {
+	s << value.get_val();
+	return s;
+}
+
+// Same idea as GF1_Accumulator, except that since p isn't known at compile
+// time, the sum just always gets 128 bits.
+class GF1_Dyn_Accumulator {
+public:
+	GF1_Dyn_Accumulator(const GF1_Dyn& initial = 0) :
+		ctx(initial.get_context()),
+		sum(initial.get_val())
+	{}
+
+	void add_product(const GF1_Dyn& a, const GF1_Dyn& b) {
+		if (a.get_context() != ctx || b.get_context() != ctx) {
+			ctx = GF1_Dyn::shared_context(ctx, GF1_Dyn::shared_context(a.get_context(), b.get_context()));
+		}
+		sum += static_cast<unsigned __int128>(a.get_val()) * b.get_val();
+	}
+
+	GF1_Dyn result() const {
+		if (ctx) {
+			return GF1_Dyn{ctx, ctx->reduce(sum)};
+		}
+		return GF1_Dyn{static_cast<uint64_t>(sum)};
+	}
+private:
+	const GF1_Context * ctx;
+	unsigned __int128 sum;
+};
+
+template<>
+struct Accumulator_For<GF1_Dyn> {
+	using type = GF1_Dyn_Accumulator;
+};
+
+}
@@ -0,0 +1,470 @@
+#pragma once
+#include "finite-field.hpp"
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+// Define GF1_KERNELS_NO_SIMD to always use the scalar kernels.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(GF1_KERNELS_NO_SIMD)
+#define GF1_KERNELS_AVX2
+#include <immintrin.h>
+#endif
+
+// Kernels for contiguous arrays of GF1<p>. Matrix uses these for its
+// element-wise operations and its elementary row operations.
+//
+// Everything in here works directly on the stored representatives and only
+// ever multiplies them by plain values (never by another representative), so
+// x_repr * c = (x c)_repr holds for every reduction policy, Montgomery
+// included. The only place that has to care about the policy is dot, which
+// multiplies two representatives together.
+namespace cherry::kernels {
+
+namespace raw {
+
+template<uint32_t p>
+using Word = MAX_TYPE(p);
+
+template<uint32_t p>
+constexpr Word<p> add(Word<p> a, Word<p> b) {
+	uint64_t r = static_cast<uint64_t>(a) + b;
+	return r >= p ? r - p : r;
+}
+
+template<uint32_t p>
+constexpr Word<p> sub(Word<p> a, Word<p> b) {
+	uint64_t r = static_cast<uint64_t>(a) + p - b;
+	return r >= p ? r - p : r;
+}
+
+// Shoup's trick: for a fixed multiplier c, precompute floor(c 2^32 / p) so
+// that x c mod p only takes multiplies and a single conditional subtraction.
+template<uint32_t p>
+constexpr uint64_t shoup(uint64_t c) {
+	return (c << 32) / p;
+}
+
+template<uint32_t p>
+constexpr Word<p> mul(Word<p> x, uint64_t c, uint64_t c_shoup) {
+	uint64_t q = (x * c_shoup) >> 32;
+	uint64_t r = x * c - q * p;
+	return r >= p ? r - p : r;
+}
+
+}
+
+#ifdef GF1_KERNELS_AVX2
+inline bool cpu_has_avx2() {
+	static const bool has_avx2 = __builtin_cpu_supports("avx2");
+	return has_avx2;
+}
+
+// Each lane holds one representative. For p <= 16, the lanes are bytes, and
+// since there's no byte multiply, mul_bytes widens to 16-bit lanes and packs
+// the result back down.
+namespace avx2 {
+
+template<uint32_t p>
+constexpr size_t lanes = 32 / sizeof(raw::Word<p>);
+
+template<uint32_t p>
+__attribute__((target("avx2")))
+inline __m256i set1(uint64_t v) {
+	if constexpr (sizeof(raw::Word<p>) == 1) {
+		return _mm256_set1_epi8(static_cast<char>(v));
+	} else if constexpr (sizeof(raw::Word<p>) == 2) {
+		return _mm256_set1_epi16(static_cast<short>(v));
+	} else if constexpr (sizeof(raw::Word<p>) == 4) {
+		return _mm256_set1_epi32(static_cast<int>(v));
+	} else {
+		return _mm256_set1_epi64x(static_cast<long long>(v));
+	}
+}
+
+// Takes every lane from [0, 2p) to [0, p). For the narrow lanes, r - p wraps
+// around to something huge whenever r < p, so an unsigned min picks the right
+// one. There's no unsigned 64-bit min in AVX2, but the values are below 2^33,
+// so a signed compare works just as well.
+template<uint32_t p>
+__attribute__((target("avx2")))
+inline __m256i reduce_once(__m256i r) {
+	__m256i pv = set1<p>(p);
+	if constexpr (sizeof(raw::Word<p>) == 1) {
+		return _mm256_min_epu8(r, _mm256_sub_epi8(r, pv));
+	} else if constexpr (sizeof(raw::Word<p>) == 2) {
+		return _mm256_min_epu16(r, _mm256_sub_epi16(r, pv));
+	} else if constexpr (sizeof(raw::Word<p>) == 4) {
+		return _mm256_min_epu32(r, _mm256_sub_epi32(r, pv));
+	} else {
+		__m256i less_than_p = _mm256_cmpgt_epi64(pv, r);
+		return _mm256_sub_epi64(r, _mm256_andnot_si256(less_than_p, pv));
+	}
+}
+
+template<uint32_t p>
+__attribute__((target("avx2")))
+inline __m256i add_lanes(__m256i a, __m256i b) {
+	if constexpr (sizeof(raw::Word<p>) == 1) {
+		return reduce_once<p>(_mm256_add_epi8(a, b));
+	} else if constexpr (sizeof(raw::Word<p>) == 2) {
+		return reduce_once<p>(_mm256_add_epi16(a, b));
+	} else if constexpr (sizeof(raw::Word<p>) == 4) {
+		return reduce_once<p>(_mm256_add_epi32(a, b));
+	} else {
+		return reduce_once<p>(_mm256_add_epi64(a, b));
+	}
+}
+
+template<uint32_t p>
+__attribute__((target("avx2")))
+inline __m256i sub_lanes(__m256i a, __m256i b) {
+	__m256i pv = set1<p>(p);
+	if constexpr (sizeof(raw::Word<p>) == 1) {
+		return reduce_once<p>(_mm256_sub_epi8(_mm256_add_epi8(a, pv), b));
+	} else if constexpr (sizeof(raw::Word<p>) == 2) {
+		return reduce_once<p>(_mm256_sub_epi16(_mm256_add_epi16(a, pv), b));
+	} else if constexpr (sizeof(raw::Word<p>) == 4) {
+		return reduce_once<p>(_mm256_sub_epi32(_mm256_add_epi32(a, pv), b));
+	} else {
+		return reduce_once<p>(_mm256_sub_epi64(_mm256_add_epi64(a, pv), b));
+	}
+}
+
+// The multiplier and its Shoup constant, broadcast once per kernel call. The
+// 16-bit lanes use a 16-bit Shoup constant so that _mm256_mulhi_epu16 gives
+// the quotient directly.
+struct Multiplier {
+	__m256i c;
+	__m256i c_shoup;
+};
+
+template<uint32_t p>
+__attribute__((target("avx2")))
+inline Multiplier make_multiplier(uint64_t c) {
+	if constexpr (sizeof(raw::Word<p>) <= 2) {
+		return {_mm256_set1_epi16(static_cast<short>(c)), _mm256_set1_epi16(static_cast<short>((c << 16) / p))};
+	} else if constexpr (sizeof(raw::Word<p>) == 4) {
+		return {_mm256_set1_epi32(static_cast<int>(c)), _mm256_set1_epi32(static_cast<int>(raw::shoup<p>(c)))};
+	} else {
+		return {_mm256_set1_epi64x(c), _mm256_set1_epi64x(raw::shoup<p>(c))};
+	}
+}
+
+// Multiplies 16-bit lanes. Only used directly for p <= 255, where x c < 2^16.
+template<uint32_t p>
+__attribute__((target("avx2")))
+inline __m256i mul_words16(__m256i x, const Multiplier& m) {
+	__m256i q = _mm256_mulhi_epu16(x, m.c_shoup);
+	__m256i r = _mm256_sub_epi16(_mm256_mullo_epi16(x, m.c), _mm256_mullo_epi16(q, _mm256_set1_epi16(p)));
+	return _mm256_min_epu16(r, _mm256_sub_epi16(r, _mm256_set1_epi16(p)));
+}
+
+template<uint32_t p>
+__attribute__((target("avx2")))
+inline __m256i mul_lanes(__m256i x, const Multiplier& m) {
+	if constexpr (sizeof(raw::Word<p>) == 2) {
+		return mul_words16<p>(x, m);
+	} else if constexpr (sizeof(raw::Word<p>) == 4) {
+		// x c < 2^32, so the low half of the product is exact. The quotient
+		// needs the high half of x c_shoup, which AVX2 only gives us for the
+		// even lanes, so the odd lanes get shifted down and blended back in.
+		__m256i q_even = _mm256_srli_epi64(_mm256_mul_epu32(x, m.c_shoup), 32);
+		__m256i q_odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), m.c_shoup);
+		__m256i q = _mm256_blend_epi32(q_even, q_odd, 0b10101010);
+		__m256i r = _mm256_sub_epi32(_mm256_mullo_epi32(x, m.c), _mm256_mullo_epi32(q, _mm256_set1_epi32(p)));
+		return reduce_once<p>(r);
+	} else {
+		// Every value is below 2^32, so _mm256_mul_epu32 is a full multiply.
+		__m256i q = _mm256_srli_epi64(_mm256_mul_epu32(x, m.c_shoup), 32);
+		__m256i r = _mm256_sub_epi64(_mm256_mul_epu32(x, m.c), _mm256_mul_epu32(q, _mm256_set1_epi64x(p)));
+		return reduce_once<p>(r);
+	}
+}
+
+// Byte lanes get multiplied 16 at a time.
+template<uint32_t p>
+__attribute__((target("avx2")))
+inline __m128i mul_bytes(__m128i x, const Multiplier& m) {
+	__m256i r = mul_words16<p>(_mm256_cvtepu8_epi16(x), m);
+	r = _mm256_permute4x64_epi64(_mm256_packus_epi16(r, r), 0b1000);
+	return _mm256_castsi256_si128(r);
+}
+
+template<uint32_t p>
+__attribute__((target("avx2")))
+void add(raw::Word<p> * out, const raw::Word<p> * a, const raw::Word<p> * b, size_t n) {
+	size_t i = 0;
+	for (; i + lanes<p> <= n; i += lanes<p>) {
+		__m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		__m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), add_lanes<p>(va, vb));
+	}
+	for (; i < n; i++) {
+		out[i] = raw::add<p>(a[i], b[i]);
+	}
+}
+
+template<uint32_t p>
+__attribute__((target("avx2")))
+void sub(raw::Word<p> * out, const raw::Word<p> * a, const raw::Word<p> * b, size_t n) {
+	size_t i = 0;
+	for (; i + lanes<p> <= n; i += lanes<p>) {
+		__m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+		__m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), sub_lanes<p>(va, vb));
+	}
+	for (; i < n; i++) {
+		out[i] = raw::sub<p>(a[i], b[i]);
+	}
+}
+
+template<uint32_t p>
+__attribute__((target("avx2")))
+void mul(raw::Word<p> * out, const raw::Word<p> * x, uint64_t c, size_t n) {
+	Multiplier m = make_multiplier<p>(c);
+	size_t i = 0;
+	if constexpr (sizeof(raw::Word<p>) == 1) {
+		for (; i + 16 <= n; i += 16) {
+			__m128i vx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), mul_bytes<p>(vx, m));
+		}
+	} else {
+		for (; i + lanes<p> <= n; i += lanes<p>) {
+			__m256i vx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), mul_lanes<p>(vx, m));
+		}
+	}
+	uint64_t c_shoup = raw::shoup<p>(c);
+	for (; i < n; i++) {
+		out[i] = raw::mul<p>(x[i], c, c_shoup);
+	}
+}
+
+template<uint32_t p>
+__attribute__((target("avx2")))
+void axpy(raw::Word<p> * y, uint64_t c, const raw::Word<p> * x, size_t n) {
+	Multiplier m = make_multiplier<p>(c);
+	size_t i = 0;
+	if constexpr (sizeof(raw::Word<p>) == 1) {
+		for (; i + 16 <= n; i += 16) {
+			__m128i vx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+			__m128i vy = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i));
+			__m128i r = _mm256_castsi256_si128(
+				add_lanes<p>(_mm256_castsi128_si256(vy), _mm256_castsi128_si256(mul_bytes<p>(vx, m)))
+			);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(y + i), r);
+		}
+	} else {
+		for (; i + lanes<p> <= n; i += lanes<p>) {
+			__m256i vx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+			__m256i vy = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(y + i), add_lanes<p>(vy, mul_lanes<p>(vx, m)));
+		}
+	}
+	uint64_t c_shoup = raw::shoup<p>(c);
+	for (; i < n; i++) {
+		y[i] = raw::add<p>(y[i], raw::mul<p>(x[i], c, c_shoup));
+	}
+}
+
+// Returns the sum of the products reduced mod p, but without converting out
+// of whatever form the representatives are in.
+template<uint32_t p>
+__attribute__((target("avx2")))
+uint64_t dot(const raw::Word<p> * a, const raw::Word<p> * b, size_t n) {
+	uint64_t total = 0;
+	size_t i = 0;
+	if constexpr (sizeof(raw::Word<p>) <= 2) {
+		// Products fit in 16 bits and pairs of them get summed into 32-bit
+		// lanes. Each step adds less than 2^17 to a lane, so flushing every
+		// 2^13 steps keeps the lanes from overflowing.
+		const size_t block = size_t{1} << 13;
+		while (i + lanes<p> <= n) {
+			__m256i acc = _mm256_setzero_si256();
+			for (size_t steps = 0; steps < block && i + lanes<p> <= n; steps++, i += lanes<p>) {
+				__m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+				__m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+				if constexpr (sizeof(raw::Word<p>) == 1) {
+					// Values are below 16, so treating b as signed is fine.
+					__m256i pairs = _mm256_maddubs_epi16(va, vb);
+					acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, _mm256_set1_epi16(1)));
+				} else {
+					acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+				}
+			}
+			alignas(32) uint32_t lanes_out[8];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(lanes_out), acc);
+			for (uint32_t lane : lanes_out) {
+				total += lane;
+			}
+			total %= p;
+		}
+	} else if constexpr (sizeof(raw::Word<p>) == 4) {
+		// Products fit in 32 bits and get summed into 64-bit lanes.
+		const size_t block = size_t{1} << 30;
+		while (i + lanes<p> <= n) {
+			__m256i acc = _mm256_setzero_si256();
+			for (size_t steps = 0; steps < block && i + lanes<p> <= n; steps++, i += lanes<p>) {
+				__m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+				__m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+				acc = _mm256_add_epi64(acc, _mm256_mul_epu32(va, vb));
+				acc = _mm256_add_epi64(acc, _mm256_mul_epu32(_mm256_srli_epi64(va, 32), _mm256_srli_epi64(vb, 32)));
+			}
+			alignas(32) uint64_t lanes_out[4];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(lanes_out), acc);
+			for (uint64_t lane : lanes_out) {
+				total = (total + lane % p) % p;
+			}
+		}
+	}
+	// A product of two 32-bit values already fills a 64-bit lane, so that
+	// width only goes through here.
+	unsigned __int128 tail = total;
+	for (; i < n; i++) {
+		tail += static_cast<uint64_t>(a[i]) * b[i];
+	}
+	return static_cast<uint64_t>(tail % p);
+}
+
+}
+#endif
+
+// Scalar fallbacks, used when AVX2 isn't available.
+namespace scalar {
+
+template<uint32_t p>
+void add(raw::Word<p> * out, const raw::Word<p> * a, const raw::Word<p> * b, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		out[i] = raw::add<p>(a[i], b[i]);
+	}
+}
+
+template<uint32_t p>
+void sub(raw::Word<p> * out, const raw::Word<p> * a, const raw::Word<p> * b, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		out[i] = raw::sub<p>(a[i], b[i]);
+	}
+}
+
+template<uint32_t p>
+void mul(raw::Word<p> * out, const raw::Word<p> * x, uint64_t c, size_t n) {
+	uint64_t c_shoup = raw::shoup<p>(c);
+	for (size_t i = 0; i < n; i++) {
+		out[i] = raw::mul<p>(x[i], c, c_shoup);
+	}
+}
+
+template<uint32_t p>
+void axpy(raw::Word<p> * y, uint64_t c, const raw::Word<p> * x, size_t n) {
+	uint64_t c_shoup = raw::shoup<p>(c);
+	for (size_t i = 0; i < n; i++) {
+		y[i] = raw::add<p>(y[i], raw::mul<p>(x[i], c, c_shoup));
+	}
+}
+
+template<uint32_t p>
+uint64_t dot(const raw::Word<p> * a, const raw::Word<p> * b, size_t n) {
+	unsigned __int128 total = 0;
+	for (size_t i = 0; i < n; i++) {
+		total += static_cast<uint64_t>(a[i]) * b[i];
+	}
+	return static_cast<uint64_t>(total % p);
+}
+
+}
+
+template<typename T>
+struct Kernel_Traits;
+
+template<uint32_t p, template<uint32_t> typename Reduction>
+struct Kernel_Traits<GF1<p, Reduction>> {
+	using Word = raw::Word<p>;
+	static_assert(sizeof(GF1<p, Reduction>) == sizeof(Word));
+	static_assert(std::is_standard_layout_v<GF1<p, Reduction>>);
+	static constexpr uint32_t modulus = p;
+
+	static Word * words(std::span<GF1<p, Reduction>> s) {
+		return reinterpret_cast<Word*>(s.data());
+	}
+
+	static const Word * words(std::span<const GF1<p, Reduction>> s) {
+		return reinterpret_cast<const Word*>(s.data());
+	}
+};
+
+// Whether T has kernels at all, i.e. whether it's some GF1<p>.
+template<typename T>
+concept Has_Kernels = requires { Kernel_Traits<T>::modulus; };
+
+inline void check_kernel_sizes(size_t a, size_t b) {
+	if (a != b) {
+		throw std::length_error("GF1 kernels need spans of the same length.");
+	}
+}
+
+#ifdef GF1_KERNELS_AVX2
+#define GF1_KERNEL_DISPATCH(NAME, ...) \
+	(cpu_has_avx2() ? avx2::NAME<p>(__VA_ARGS__) : scalar::NAME<p>(__VA_ARGS__))
+#else
+#define GF1_KERNEL_DISPATCH(NAME, ...) scalar::NAME<p>(__VA_ARGS__)
+#endif
+
+// out = a + b
+template<typename T, uint32_t p = Kernel_Traits<T>::modulus>
+void add(std::span<T> out, std::type_identity_t<std::span<const T>> a, std::type_identity_t<std::span<const T>> b) {
+	check_kernel_sizes(out.size(), a.size());
+	check_kernel_sizes(out.size(), b.size());
+	using KT = Kernel_Traits<T>;
+	GF1_KERNEL_DISPATCH(add, KT::words(out), KT::words(a), KT::words(b), out.size());
+}
+
+// a += b
+template<typename T, uint32_t p = Kernel_Traits<T>::modulus>
+void add(std::span<T> a, std::type_identity_t<std::span<const T>> b) {
+	add<T>(a, a, b);
+}
+
+// out = a - b
+template<typename T, uint32_t p = Kernel_Traits<T>::modulus>
+void sub(std::span<T> out, std::type_identity_t<std::span<const T>> a, std::type_identity_t<std::span<const T>> b) {
+	check_kernel_sizes(out.size(), a.size());
+	check_kernel_sizes(out.size(), b.size());
+	using KT = Kernel_Traits<T>;
+	GF1_KERNEL_DISPATCH(sub, KT::words(out), KT::words(a), KT::words(b), out.size());
+}
+
+// a -= b
+template<typename T, uint32_t p = Kernel_Traits<T>::modulus>
+void sub(std::span<T> a, std::type_identity_t<std::span<const T>> b) {
+	sub<T>(a, a, b);
+}
+
+// a *= c
+template<typename T, uint32_t p = Kernel_Traits<T>::modulus>
+void scale(std::span<T> a, const T& c) {
+	using KT = Kernel_Traits<T>;
+	GF1_KERNEL_DISPATCH(mul, KT::words(a), KT::words(std::span<const T>{a}), c.get_val(), a.size());
+}
+
+// y += c x
+template<typename T, uint32_t p = Kernel_Traits<T>::modulus>
+void axpy(std::span<T> y, const T& c, std::type_identity_t<std::span<const T>> x) {
+	check_kernel_sizes(y.size(), x.size());
+	using KT = Kernel_Traits<T>;
+	GF1_KERNEL_DISPATCH(axpy, KT::words(y), c.get_val(), KT::words(x), y.size());
+}
+
+template<typename T, uint32_t p = Kernel_Traits<T>::modulus>
+T dot(std::type_identity_t<std::span<const T>> a, std::type_identity_t<std::span<const T>> b) {
+	check_kernel_sizes(a.size(), b.size());
+	using KT = Kernel_Traits<T>;
+	uint64_t sum = GF1_KERNEL_DISPATCH(dot, KT::words(a), KT::words(b), a.size());
+	// Each product was of two representatives, so this is the one spot where
+	// Montgomery form needs its extra factor of 2^-32 taken back out.
+	return T::from_repr(T::Reduction_Policy::reduce_product(sum));
+}
+
+#undef GF1_KERNEL_DISPATCH
+
+}
@@ -0,0 +1,630 @@
+#pragma once
+#include "finite-field.hpp"
+#include "remove-v-tables.hpp"
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace cherry {
+
+// GF(p) for odd primes that need all 64 bits. GF1<p> can't go past 32 bits
+// because the product of two elements has to fit in a uint64_t, so this one
+// multiplies into 128 bits and stores everything in Montgomery form with
+// R = 2^64.
+template<uint64_t p>
+class GF1_64 COLON_IN_CLASS_INHERITANCE DIVISION_RING(GF1_64<p>) {
+	static_assert(p % 2 == 1, "GF1_64<p> uses Montgomery reduction, so p has to be odd.");
+	static_assert(is_prime(p), "GF1_64<p> is only a field when p is prime.");
+public:
+	using GF1s = GF1_64<p>;
+
+	GF1_64(uint64_t v) : val(to_montgomery(v % p)) {}
+	GF1_64() : val{0} {}
+
+	GF1s operator+(const GF1s& other) const OVERRIDE {
+		return from_repr(add(val, other.val));
+	}
+
+	GF1s& operator+=(const GF1s& other) OVERRIDE {
+		val = add(val, other.val);
+		return *this;
+	}
+
+	GF1s operator-() const OVERRIDE {
+		return from_repr(sub(0, val));
+	}
+
+	void negate() OVERRIDE {
+		val = sub(0, val);
+	}
+
+	GF1s operator-(const GF1s& other) const OVERRIDE {
+		return from_repr(sub(val, other.val));
+	}
+
+	GF1s& operator-=(const GF1s& other) OVERRIDE {
+		val = sub(val, other.val);
+		return *this;
+	}
+
+	GF1s operator*(const GF1s& other) const OVERRIDE {
+		return from_repr(redc(static_cast<unsigned __int128>(val) * other.val));
+	}
+
+	GF1s& operator*=(const GF1s& other) OVERRIDE {
+		val = redc(static_cast<unsigned __int128>(val) * other.val);
+		return *this;
+	}
+
+	GF1s operator/(const GF1s& other) const OVERRIDE {
+		return *this * other.inv();
+	}
+
+	GF1s& operator/=(const GF1s& other) OVERRIDE {
+		*this *= other.inv();
+		return *this;
+	}
+
+	GF1s inv() const OVERRIDE {
+		if (val == 0) {
+			throw std::domain_error(
+				"Trying to take the multiplicative inverse of "
+				"the additive identity (i.e. dividing by zero)."
+			);
+		}
+		return pow_64(p - 2);
+	}
+
+	GF1s operator^(int pow) const OVERRIDE {
+		if (pow < 0 && val == 0) {
+			throw std::domain_error(
+				"Trying to take the multiplicative inverse of "
+				"the additive identity (i.e. dividing by zero)."
+			);
+		}
+		if (pow >= 0) {
+			return pow_64(static_cast<uint64_t>(pow));
+		}
+		uint64_t reduced = static_cast<uint64_t>(-static_cast<int64_t>(pow)) % (p - 1);
+		return pow_64((p - 1 - reduced) % (p - 1));
+	}
+
+	GF1s pow_u(uint32_t pow) const OVERRIDE {
+		return pow_64(pow);
+	}
+
+	GF1s pow_64(uint64_t pow) const {
+		if (val == 0) {
+			return *this;
+		}
+		pow %= p - 1;
+		GF1s out = 1;
+		GF1s val_pow = *this;
+		while (pow > 0) {
+			if (pow & 1) {
+				out *= val_pow;
+			}
+			val_pow *= val_pow;
+			pow >>= 1;
+		}
+		return out;
+	}
+
+	uint64_t get_val() const {
+		return redc(val);
+	}
+
+	// The value in Montgomery form.
+	uint64_t get_repr() const {
+		return val;
+	}
+
+	static GF1s from_repr(uint64_t repr) {
+		GF1s out;
+		out.val = repr;
+		return out;
+	}
+
+	bool operator==(const GF1s& other) const {
+		return val == other.val;
+	}
+
+	std::string to_string() const {
+		return std::to_string(get_val());
+	}
+
+	explicit operator std::string() const {
+		return to_string();
+	}
+public:
+	static GF1s member_zero(const void * other_data = nullptr) {
+		(void)other_data;
+		return 0;
+	}
+
+	static GF1s member_one(const void * other_data = nullptr) {
+		(void)other_data;
+		return 1;
+	}
+private:
+	static constexpr uint64_t compute_p_inv() {
+		uint64_t out = p;
+		for (int i = 0; i < 6; i++) {
+			out *= 2 - p * out;
+		}
+		return out;
+	}
+
+	static constexpr uint64_t p_inv = compute_p_inv();
+	static constexpr uint64_t r_mod_p = (0 - p) % p;
+	static constexpr uint64_t r2_mod_p = static_cast<uint64_t>(
+		static_cast<unsigned __int128>(r_mod_p) * r_mod_p % p
+	);
+
+	// Signed variant of REDC. The low halves of v and m * p are the same, so
+	// the answer is just the difference of the high halves, fixed up by p if
+	// it went negative. Nothing here can overflow, even when p is close to
+	// 2^64.
+	static constexpr uint64_t redc(unsigned __int128 v) {
+		uint64_t m = static_cast<uint64_t>(v) * p_inv;
+		uint64_t v_hi = static_cast<uint64_t>(v >> 64);
+		uint64_t mp_hi = static_cast<uint64_t>((static_cast<unsigned __int128>(m) * p) >> 64);
+		return v_hi >= mp_hi ? v_hi - mp_hi : v_hi - mp_hi + p;
+	}
+
+	static constexpr uint64_t to_montgomery(uint64_t v) {
+		return redc(static_cast<unsigned __int128>(v) * r2_mod_p);
+	}
+
+	static constexpr uint64_t add(uint64_t a, uint64_t b) {
+		unsigned __int128 sum = static_cast<unsigned __int128>(a) + b;
+		return static_cast<uint64_t>(sum >= p ? sum - p : sum);
+	}
+
+	static constexpr uint64_t sub(uint64_t a, uint64_t b) {
+		return a >= b ? a - b : a - b + p;
+	}
+
+	uint64_t val;
+};
+
+template<uint64_t p>
+std::ostream& operator<<(std::ostream& s, const GF1_64<p>& value) {
+	s << value.get_val();
+	return s;
+}
+
+// A fixed-size unsigned integer made of N 64-bit limbs, least significant
+// limb first. It's a structural type so that it can be a template argument,
+// which is how GF1_Big gets its prime. The easiest way to make one is with
+// from_string, which takes decimal or hex (with a leading 0x).
+template<size_t N>
+struct Big_Uint {
+	std::array<uint64_t, N> limbs{};
+
+	constexpr Big_Uint() = default;
+	constexpr Big_Uint(uint64_t v) {
+		limbs[0] = v;
+	}
+
+	static constexpr Big_Uint<N> from_string(std::string_view s) {
+		uint64_t base = 10;
+		if (s.size() > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+			base = 16;
+			s.remove_prefix(2);
+		}
+		if (s.empty()) {
+			throw std::invalid_argument("Big_Uint::from_string needs at least one digit.");
+		}
+		Big_Uint<N> out;
+		for (char c : s) {
+			if (c == '\'' || c == '_') {
+				continue;
+			}
+			uint64_t digit = base;
+			if (c >= '0' && c <= '9') {
+				digit = c - '0';
+			} else if (c >= 'a' && c <= 'f') {
+				digit = c - 'a' + 10;
+			} else if (c >= 'A' && c <= 'F') {
+				digit = c - 'A' + 10;
+			}
+			if (digit >= base) {
+				throw std::invalid_argument("Big_Uint::from_string got a character that isn't a digit.");
+			}
+			uint64_t carry = digit;
+			for (size_t i = 0; i < N; i++) {
+				unsigned __int128 v = static_cast<unsigned __int128>(out.limbs[i]) * base + carry;
+				out.limbs[i] = static_cast<uint64_t>(v);
+				carry = static_cast<uint64_t>(v >> 64);
+			}
+			if (carry != 0) {
+				throw std::length_error("Big_Uint::from_string got a number too big for N limbs.");
+			}
+		}
+		return out;
+	}
+
+	constexpr bool bit(size_t i) const {
+		return (limbs[i / 64] >> (i % 64)) & 1;
+	}
+
+	constexpr bool is_zero() const {
+		uint64_t all = 0;
+		for (uint64_t limb : limbs) {
+			all |= limb;
+		}
+		return all == 0;
+	}
+
+	constexpr bool operator==(const Big_Uint<N>& other) const = default;
+
+	constexpr bool operator<(const Big_Uint<N>& other) const {
+		for (size_t i = N; i-- > 0;) {
+			if (limbs[i] != other.limbs[i]) {
+				return limbs[i] < other.limbs[i];
+			}
+		}
+		return false;
+	}
+
+	// Divides in place and returns the remainder.
+	constexpr uint64_t divide_by(uint64_t d) {
+		unsigned __int128 rem = 0;
+		for (size_t i = N; i-- > 0;) {
+			unsigned __int128 cur = (rem << 64) | limbs[i];
+			limbs[i] = static_cast<uint64_t>(cur / d);
+			rem = cur % d;
+		}
+		return static_cast<uint64_t>(rem);
+	}
+
+	std::string to_string() const {
+		if (is_zero()) {
+			return "0";
+		}
+		Big_Uint<N> rest = *this;
+		std::string out;
+		while (!rest.is_zero()) {
+			out.push_back(static_cast<char>('0' + rest.divide_by(10)));
+		}
+		return std::string(out.rbegin(), out.rend());
+	}
+
+	explicit operator std::string() const {
+		return to_string();
+	}
+};
+
+template<size_t N>
+std::ostream& operator<<(std::ostream& s, const Big_Uint<N>& value) {
+	s << value.to_string();
+	return s;
+}
+
+// Limb arithmetic for GF1_Big. None of these branch on the values in the
+// limbs, which makes it much easier to keep GF1_Big constant time.
+namespace limbs {
+
+// out = a + b, returning the carry out of the top limb.
+template<size_t N>
+constexpr uint64_t add(std::array<uint64_t, N>& out, const std::array<uint64_t, N>& a, const std::array<uint64_t, N>& b) {
+	uint64_t carry = 0;
+	for (size_t i = 0; i < N; i++) {
+		unsigned __int128 v = static_cast<unsigned __int128>(a[i]) + b[i] + carry;
+		out[i] = static_cast<uint64_t>(v);
+		carry = static_cast<uint64_t>(v >> 64);
+	}
+	return carry;
+}
+
+// out = a - b, returning the borrow out of the top limb.
+template<size_t N>
+constexpr uint64_t sub(std::array<uint64_t, N>& out, const std::array<uint64_t, N>& a, const std::array<uint64_t, N>& b) {
+	uint64_t borrow = 0;
+	for (size_t i = 0; i < N; i++) {
+		unsigned __int128 v = static_cast<unsigned __int128>(a[i]) - b[i] - borrow;
+		out[i] = static_cast<uint64_t>(v);
+		borrow = static_cast<uint64_t>(v >> 64) & 1;
+	}
+	return borrow;
+}
+
+// out = mask ? a : b, where mask is either all ones or all zeros.
+template<size_t N>
+constexpr void select(std::array<uint64_t, N>& out, uint64_t mask, const std::array<uint64_t, N>& a, const std::array<uint64_t, N>& b) {
+	for (size_t i = 0; i < N; i++) {
+		out[i] = (a[i] & mask) | (b[i] & ~mask);
+	}
+}
+
+// (a + b) mod p, for a, b < p.
+template<size_t N>
+constexpr std::array<uint64_t, N> add_mod(const std::array<uint64_t, N>& a, const std::array<uint64_t, N>& b, const std::array<uint64_t, N>& p) {
+	std::array<uint64_t, N> sum{}, diff{};
+	uint64_t carry = add(sum, a, b);
+	uint64_t borrow = sub(diff, sum, p);
+	// Keep the sum only if it didn't overflow and subtracting p did.
+	uint64_t keep_sum = 0 - (borrow & (carry ^ 1));
+	select(sum, keep_sum, sum, diff);
+	return sum;
+}
+
+// (a - b) mod p, for a, b < p.
+template<size_t N>
+constexpr std::array<uint64_t, N> sub_mod(const std::array<uint64_t, N>& a, const std::array<uint64_t, N>& b, const std::array<uint64_t, N>& p) {
+	std::array<uint64_t, N> diff{}, fixed{};
+	uint64_t borrow = sub(diff, a, b);
+	add(fixed, diff, p);
+	select(diff, 0 - borrow, fixed, diff);
+	return diff;
+}
+
+// Montgomery multiplication with R = 2^(64N), interleaving the product and
+// the reduction one limb at a time (CIOS). The result is a * b / R mod p as
+// long as a * b < p * R, which holds whenever one of them is below p.
+template<size_t N>
+constexpr std::array<uint64_t, N> montgomery_mul(const std::array<uint64_t, N>& a, const std::array<uint64_t, N>& b, const std::array<uint64_t, N>& p, uint64_t p_inv_neg) {
+	std::array<uint64_t, N + 2> t{};
+	for (size_t i = 0; i < N; i++) {
+		uint64_t carry = 0;
+		for (size_t j = 0; j < N; j++) {
+			unsigned __int128 v = static_cast<unsigned __int128>(a[j]) * b[i] + t[j] + carry;
+			t[j] = static_cast<uint64_t>(v);
+			carry = static_cast<uint64_t>(v >> 64);
+		}
+		unsigned __int128 top = static_cast<unsigned __int128>(t[N]) + carry;
+		t[N] = static_cast<uint64_t>(top);
+		t[N + 1] = static_cast<uint64_t>(top >> 64);
+
+		uint64_t m = t[0] * p_inv_neg;
+		unsigned __int128 v = static_cast<unsigned __int128>(m) * p[0] + t[0];
+		carry = static_cast<uint64_t>(v >> 64);
+		for (size_t j = 1; j < N; j++) {
+			v = static_cast<unsigned __int128>(m) * p[j] + t[j] + carry;
+			t[j - 1] = static_cast<uint64_t>(v);
+			carry = static_cast<uint64_t>(v >> 64);
+		}
+		top = static_cast<unsigned __int128>(t[N]) + carry;
+		t[N - 1] = static_cast<uint64_t>(top);
+		t[N] = t[N + 1] + static_cast<uint64_t>(top >> 64);
+	}
+	// t < 2p here, so one subtraction is enough.
+	std::array<uint64_t, N> out{}, diff{};
+	for (size_t i = 0; i < N; i++) {
+		out[i] = t[i];
+	}
+	uint64_t borrow = sub(diff, out, p);
+	uint64_t keep_t = 0 - (borrow & (t[N] ^ 1));
+	select(out, keep_t, out, diff);
+	return out;
+}
+
+}
+
+// GF(p) for primes bigger than 64 bits, stored in N limbs in Montgomery
+// form. Everything except division by zero, to_string and comparisons runs
+// in time that only depends on N, so it's a reasonable starting point for
+// cryptographic code. You still need to check the compiler output if you
+// really care, though.
+//
+//     constexpr auto p = Big_Uint<4>::from_string(
+//         "0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff"
+//     );
+//     GF1_Big<4, p> a = 3;
+//
+// Running Miller-Rabin on a 256-bit number blows through the compiler's
+// constexpr limits, so the only check at compile time is that p has no odd
+// factors below 1000. Call is_probable_prime() in a test if you got p from
+// somewhere you don't trust.
+template<size_t N, Big_Uint<N> p>
+class GF1_Big COLON_IN_CLASS_INHERITANCE DIVISION_RING(GF1_Big<N COMMA p>) {
+	static_assert(N > 0, "GF1_Big needs at least one limb.");
+	static_assert(p.limbs[0] % 2 == 1, "GF1_Big<N, p> uses Montgomery reduction, so p has to be odd.");
+public:
+	using GF1s = GF1_Big<N, p>;
+	using Limbs = std::array<uint64_t, N>;
+
+	GF1_Big(uint64_t v) : GF1_Big(Big_Uint<N>{v}) {}
+	GF1_Big(const Big_Uint<N>& v) : val(limbs::montgomery_mul(v.limbs, r2_mod_p, p.limbs, p_inv_neg)) {}
+	GF1_Big() : val{} {}
+
+	GF1s operator+(const GF1s& other) const OVERRIDE {
+		return from_repr(limbs::add_mod(val, other.val, p.limbs));
+	}
+
+	GF1s& operator+=(const GF1s& other) OVERRIDE {
+		val = limbs::add_mod(val, other.val, p.limbs);
+		return *this;
+	}
+
+	GF1s operator-() const OVERRIDE {
+		return from_repr(limbs::sub_mod(Limbs{}, val, p.limbs));
+	}
+
+	void negate() OVERRIDE {
+		val = limbs::sub_mod(Limbs{}, val, p.limbs);
+	}
+
+	GF1s operator-(const GF1s& other) const OVERRIDE {
+		return from_repr(limbs::sub_mod(val, other.val, p.limbs));
+	}
+
+	GF1s& operator-=(const GF1s& other) OVERRIDE {
+		val = limbs::sub_mod(val, other.val, p.limbs);
+		return *this;
+	}
+
+	GF1s operator*(const GF1s& other) const OVERRIDE {
+		return from_repr(limbs::montgomery_mul(val, other.val, p.limbs, p_inv_neg));
+	}
+
+	GF1s& operator*=(const GF1s& other) OVERRIDE {
+		val = limbs::montgomery_mul(val, other.val, p.limbs, p_inv_neg);
+		return *this;
+	}
+
+	GF1s operator/(const GF1s& other) const OVERRIDE {
+		return *this * other.inv();
+	}
+
+	GF1s& operator/=(const GF1s& other) OVERRIDE {
+		*this *= other.inv();
+		return *this;
+	}
+
+	// Fermat's little theorem, so that inverting takes the same time for
+	// every element.
+	GF1s inv() const OVERRIDE {
+		if (val == Limbs{}) {
+			throw std::domain_error(
+				"Trying to take the multiplicative inverse of "
+				"the additive identity (i.e. dividing by zero)."
+			);
+		}
+		return pow_big(p_minus_2);
+	}
+
+	GF1s operator^(int pow) const OVERRIDE {
+		if (pow < 0) {
+			return inv().pow_big(Big_Uint<N>{static_cast<uint64_t>(-static_cast<int64_t>(pow))});
+		}
+		return pow_big(Big_Uint<N>{static_cast<uint64_t>(pow)});
+	}
+
+	GF1s pow_u(uint32_t pow) const OVERRIDE {
+		return pow_big(Big_Uint<N>{pow});
+	}
+
+	// Square and always multiply, keeping the product only when the bit is
+	// set, so the time doesn't depend on the exponent.
+	GF1s pow_big(const Big_Uint<N>& pow) const {
+		Limbs out = one_repr;
+		for (size_t i = 64 * N; i-- > 0;) {
+			out = limbs::montgomery_mul(out, out, p.limbs, p_inv_neg);
+			Limbs with_val = limbs::montgomery_mul(out, val, p.limbs, p_inv_neg);
+			limbs::select(out, 0 - static_cast<uint64_t>(pow.bit(i)), with_val, out);
+		}
+		return from_repr(out);
+	}
+
+	Big_Uint<N> get_val() const {
+		Big_Uint<N> out;
+		out.limbs = limbs::montgomery_mul(val, Limbs{1}, p.limbs, p_inv_neg);
+		return out;
+	}
+
+	// The value in Montgomery form.
+	const Limbs& get_repr() const {
+		return val;
+	}
+
+	static GF1s from_repr(const Limbs& repr) {
+		GF1s out;
+		out.val = repr;
+		return out;
+	}
+
+	bool operator==(const GF1s& other) const {
+		return val == other.val;
+	}
+
+	std::string to_string() const {
+		return get_val().to_string();
+	}
+
+	explicit operator std::string() const {
+		return to_string();
+	}
+
+	// Miller-Rabin with the first eight primes as bases, done entirely in
+	// Montgomery form.
+	static bool is_probable_prime() {
+		Big_Uint<N> d;
+		limbs::sub(d.limbs, p.limbs, Big_Uint<N>{1}.limbs);
+		Limbs minus_one = limbs::sub_mod(Limbs{}, one_repr, p.limbs);
+		size_t s = 0;
+		while (!d.bit(0)) {
+			d.divide_by(2);
+			s++;
+		}
+		for (uint64_t a : {2, 3, 5, 7, 11, 13, 17, 19}) {
+			GF1s x = GF1s{a}.pow_big(d);
+			if (x.val == one_repr || x.val == minus_one) {
+				continue;
+			}
+			bool composite = true;
+			for (size_t r = 1; r < s && composite; r++) {
+				x *= x;
+				composite = x.val != minus_one;
+			}
+			if (composite) {
+				return false;
+			}
+		}
+		return true;
+	}
+public:
+	static GF1s member_zero(const void * other_data = nullptr) {
+		(void)other_data;
+		return 0;
+	}
+
+	static GF1s member_one(const void * other_data = nullptr) {
+		(void)other_data;
+		return 1;
+	}
+private:
+	static constexpr uint64_t compute_p_inv_neg() {
+		uint64_t inv = p.limbs[0];
+		for (int i = 0; i < 6; i++) {
+			inv *= 2 - p.limbs[0] * inv;
+		}
+		return 0 - inv;
+	}
+
+	// 2^k mod p, by doubling k times. Only runs at compile time.
+	static constexpr Limbs two_to_the(size_t k) {
+		Limbs out{};
+		out[0] = 1;
+		for (size_t i = 0; i < k; i++) {
+			out = limbs::add_mod(out, out, p.limbs);
+		}
+		return out;
+	}
+
+	static constexpr Big_Uint<N> compute_p_minus_2() {
+		Big_Uint<N> out;
+		limbs::sub(out.limbs, p.limbs, Big_Uint<N>{2}.limbs);
+		return out;
+	}
+
+	static constexpr bool has_small_factor() {
+		for (uint64_t q = 3; q < 1000; q += 2) {
+			Big_Uint<N> rest = p;
+			if (rest.divide_by(q) == 0 && !(p == Big_Uint<N>{q})) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static constexpr uint64_t p_inv_neg = compute_p_inv_neg();
+	static constexpr Limbs one_repr = two_to_the(64 * N);
+	static constexpr Limbs r2_mod_p = two_to_the(128 * N);
+	static constexpr Big_Uint<N> p_minus_2 = compute_p_minus_2();
+	static_assert(!has_small_factor(), "GF1_Big<N, p> is only a field when p is prime.");
+
+	Limbs val;
+};
+
+template<size_t N, Big_Uint<N> p>
+std::ostream& operator<<(std::ostream& s, const GF1_Big<N, p>& value) {
+	s << value.get_val();
+	return s;
+}
+
+}
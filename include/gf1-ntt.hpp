@@ -0,0 +1,489 @@
+#pragma once
+#include "finite-field.hpp"
+#include "polynomial-multiply.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// Products over GF1<p> where the shorter polynomial has at least this many
+// coefficients use the number theoretic transform, as long as p - 1 is
+// divisible by a big enough power of two.
+#ifndef POLYNOMIAL_NTT_THRESHOLD
+#define POLYNOMIAL_NTT_THRESHOLD 128
+#endif
+
+// Every other prime goes through up to three NTT-friendly primes and the
+// Chinese remainder theorem, which takes up to three times the transforms, so
+// it needs bigger polynomials to pay off.
+#ifndef POLYNOMIAL_NTT_CRT_THRESHOLD
+#define POLYNOMIAL_NTT_CRT_THRESHOLD 512
+#endif
+
+namespace cherry {
+
+// The largest k such that 2^k divides n, for n > 0.
+constexpr unsigned two_adicity(uint64_t n) {
+	return static_cast<unsigned>(std::countr_zero(n));
+}
+
+// The smallest generator of the multiplicative group mod p, for a prime p.
+// g generates it if g^((p - 1) / q) != 1 for every prime q dividing p - 1.
+constexpr uint64_t primitive_root(uint64_t p) {
+	if (p == 2) {
+		return 1;
+	}
+	std::array<uint64_t, 16> factors{};
+	size_t num_factors = 0;
+	uint64_t rest = p - 1;
+	for (uint64_t q = 2; q * q <= rest; q++) {
+		if (rest % q == 0) {
+			factors[num_factors++] = q;
+			while (rest % q == 0) {
+				rest /= q;
+			}
+		}
+	}
+	if (rest > 1) {
+		factors[num_factors++] = rest;
+	}
+	for (uint64_t g = 2; ; g++) {
+		bool generates = true;
+		for (size_t i = 0; i < num_factors && generates; i++) {
+			generates = pow_mod_64(g, (p - 1) / factors[i], p) != 1;
+		}
+		if (generates) {
+			return g;
+		}
+	}
+}
+
+// A primitive nth root of unity in GF(p), which only exists when n divides
+// p - 1.
+template<uint32_t p, template<uint32_t> typename Reduction = Modulo_Reduction>
+GF1<p, Reduction> root_of_unity(uint64_t n) {
+	if (n == 0) {
+		throw std::invalid_argument("There's no such thing as a 0th root of unity.");
+	}
+	if ((p - 1) % n != 0) {
+		throw std::domain_error(
+			"GF(" + std::to_string(p) + ") only has nth roots of unity when n "
+			"divides " + std::to_string(p - 1) + "."
+		);
+	}
+	static constexpr uint64_t g = primitive_root(p);
+	return GF1<p, Reduction>{ pow_mod_64(g, (p - 1) / n, p) };
+}
+
+namespace ntt {
+
+// Number theoretic transforms over GF(p) on plain values in [0, p), for p
+// with p - 1 divisible by 2^max_log. The forward transform is decimation in
+// frequency, which takes its input in order and leaves the output in
+// bit-reversed order, and the inverse is decimation in time, which goes the
+// other way. Multiplying pointwise doesn't care about the order, so the
+// bit-reversal permutation never has to happen.
+//
+// Both go two layers at a time (radix 4), with a single radix 2 layer when
+// the size is an odd power of two, which halves the number of passes over
+// the data. Twiddle factors are multiplied in with Shoup's trick.
+template<uint32_t p>
+class Transform {
+	static_assert(p % 2 == 1, "The NTT needs an odd prime.");
+public:
+	static constexpr unsigned max_log = two_adicity(p - 1);
+
+	// The size of the cyclic convolution convolve uses for a product of na
+	// and nb coefficients. It's the smallest power of two that fits the
+	// product, unless the top few coefficients can be fixed up separately
+	// with half that.
+	static size_t cyclic_size(size_t na, size_t nb) {
+		size_t n = na + nb - 1;
+		size_t size = std::bit_ceil(n);
+		size_t wrapped = n - size / 2;
+		if (4 * wrapped <= size && wrapped <= std::min(na, nb)) {
+			size /= 2;
+		}
+		return size;
+	}
+
+	static bool fits(size_t na, size_t nb) {
+		return cyclic_size(na, nb) <= (size_t{1} << max_log);
+	}
+
+	// out[0, na + nb - 1) = a b, for na and nb at least 1 and fits(na, nb).
+	//
+	// Instead of a truncated transform, products a bit longer than a power
+	// of two M get computed mod x^M - 1, which wraps the top r coefficients
+	// around onto the bottom r. Those top r only depend on the top r of a
+	// and b, so a second, much smaller product finds them, and they get
+	// subtracted back out.
+	static void convolve(const uint32_t * a, size_t na, const uint32_t * b, size_t nb, uint32_t * out) {
+		if (std::min(na, nb) < POLYNOMIAL_NTT_THRESHOLD) {
+			schoolbook(a, na, b, nb, out);
+			return;
+		}
+		size_t n = na + nb - 1;
+		size_t size = cyclic_size(na, nb);
+		unsigned log_size = static_cast<unsigned>(std::countr_zero(size));
+		const Tables& tables = get_tables(log_size);
+		bool squaring = a == b && na == nb;
+		std::vector<uint32_t> fa(size, 0);
+		std::vector<uint32_t> fb(squaring ? 0 : size, 0);
+		fold(a, na, fa.data(), size);
+		forward(fa.data(), log_size, tables);
+		if (!squaring) {
+			fold(b, nb, fb.data(), size);
+			forward(fb.data(), log_size, tables);
+		}
+		const uint32_t * fb_data = squaring ? fa.data() : fb.data();
+		uint64_t size_inv = pow_mod_64(size, p - 2, p);
+		uint64_t size_inv_shoup = shoup(size_inv);
+		for (size_t i = 0; i < size; i++) {
+			uint64_t product = static_cast<uint64_t>(fa[i]) * fb_data[i] % p;
+			fa[i] = mul(product, size_inv, size_inv_shoup);
+		}
+		inverse(fa.data(), log_size, tables);
+		size_t wrapped = n > size ? n - size : 0;
+		std::copy(fa.begin(), fa.begin() + std::min(n, size), out);
+		if (wrapped == 0) {
+			return;
+		}
+		std::vector<uint32_t> top(2 * wrapped - 1);
+		convolve(a + na - wrapped, wrapped, b + nb - wrapped, wrapped, top.data());
+		for (size_t i = 0; i < wrapped; i++) {
+			uint32_t high = top[wrapped - 1 + i];
+			out[size + i] = high;
+			out[i] = sub(out[i], high);
+		}
+	}
+private:
+	// Everything for blocks of size 2^k: w[j] = r^j for j < 2^(k - 1), and
+	// w3[j] = r^(3j) for j < 2^(k - 2), where r is a primitive 2^kth root
+	// of unity, and the same for r^-1. The *_shoup vectors hold the
+	// precomputed quotients for Shoup's trick.
+	struct Level {
+		std::vector<uint32_t> w, w_shoup, w3, w3_shoup;
+		std::vector<uint32_t> iw, iw_shoup, iw3, iw3_shoup;
+	};
+
+	// Levels get built the first time a transform that big shows up and
+	// never change after that, so only building them needs the lock.
+	struct Tables {
+		std::mutex mutex;
+		std::array<std::unique_ptr<Level>, max_log + 1> levels;
+
+		const Level& operator[](unsigned k) const {
+			return *levels[k];
+		}
+	};
+
+	static const Tables& get_tables(unsigned log_size) {
+		static Tables tables;
+		std::lock_guard<std::mutex> lock(tables.mutex);
+		for (unsigned k = 1; k <= log_size; k++) {
+			if (!tables.levels[k]) {
+				tables.levels[k] = build_level(k);
+			}
+		}
+		return tables;
+	}
+
+	static std::unique_ptr<Level> build_level(unsigned k) {
+		auto level = std::make_unique<Level>();
+		uint64_t root = root_of_unity<p>(uint64_t{1} << k).get_val();
+		uint64_t root_inv = pow_mod_64(root, p - 2, p);
+		auto powers = [](uint64_t base, size_t count, std::vector<uint32_t>& out, std::vector<uint32_t>& out_shoup) {
+			uint64_t power = 1;
+			for (size_t j = 0; j < count; j++) {
+				out.push_back(static_cast<uint32_t>(power));
+				out_shoup.push_back(static_cast<uint32_t>(shoup(power)));
+				power = power * base % p;
+			}
+		};
+		size_t half = size_t{1} << (k - 1);
+		powers(root, half, level->w, level->w_shoup);
+		powers(root_inv, half, level->iw, level->iw_shoup);
+		powers(root * root % p * root % p, half / 2, level->w3, level->w3_shoup);
+		powers(root_inv * root_inv % p * root_inv % p, half / 2, level->iw3, level->iw3_shoup);
+		return level;
+	}
+
+	static uint32_t add(uint64_t a, uint64_t b) {
+		uint64_t r = a + b;
+		return static_cast<uint32_t>(r >= p ? r - p : r);
+	}
+
+	static uint32_t sub(uint64_t a, uint64_t b) {
+		uint64_t r = a + p - b;
+		return static_cast<uint32_t>(r >= p ? r - p : r);
+	}
+
+	// floor(c 2^32 / p), for mul.
+	static uint64_t shoup(uint64_t c) {
+		return (c << 32) / p;
+	}
+
+	static uint32_t mul(uint64_t x, uint64_t c, uint64_t c_shoup) {
+		uint64_t q = (x * c_shoup) >> 32;
+		uint64_t r = x * c - q * p;
+		return static_cast<uint32_t>(r >= p ? r - p : r);
+	}
+
+	// Reduces a mod x^size - 1.
+	static void fold(const uint32_t * a, size_t na, uint32_t * out, size_t size) {
+		std::copy(a, a + std::min(na, size), out);
+		for (size_t i = size; i < na; i++) {
+			out[i - size] = add(out[i - size], a[i]);
+		}
+	}
+
+	static void schoolbook(const uint32_t * a, size_t na, const uint32_t * b, size_t nb, uint32_t * out) {
+		for (size_t k = 0; k < na + nb - 1; k++) {
+			size_t i_min = k < nb ? 0 : k - nb + 1;
+			size_t i_max = std::min(k, na - 1);
+			unsigned __int128 sum = 0;
+			for (size_t i = i_min; i <= i_max; i++) {
+				sum += static_cast<uint64_t>(a[i]) * b[k - i];
+			}
+			out[k] = static_cast<uint32_t>(sum % p);
+		}
+	}
+
+	// With t0 = x0 + x2, t1 = x1 + x3, t2 = x0 - x2 and t3 = (x1 - x3) i,
+	// where i = r^h is a fourth root of unity, the two layers come out to
+	//
+	//     t0 + t1, (t0 - t1) r^(2j), (t2 + t3) r^j, (t2 - t3) r^(3j).
+	static void forward(uint32_t * a, unsigned log_size, const Tables& tables) {
+		size_t size = size_t{1} << log_size;
+		unsigned k = log_size;
+		if (k % 2 == 1) {
+			const Level& level = tables[k];
+			size_t h = size / 2;
+			for (size_t j = 0; j < h; j++) {
+				uint32_t u = a[j];
+				uint32_t v = a[j + h];
+				a[j] = add(u, v);
+				a[j + h] = mul(sub(u, v), level.w[j], level.w_shoup[j]);
+			}
+			k--;
+		}
+		for (; k >= 2; k -= 2) {
+			const Level& level = tables[k];
+			const Level& half_level = tables[k - 1];
+			size_t block = size_t{1} << k;
+			size_t h = block / 4;
+			uint64_t i_root = level.w[h];
+			uint64_t i_root_shoup = level.w_shoup[h];
+			for (size_t start = 0; start < size; start += block) {
+				uint32_t * x = a + start;
+				for (size_t j = 0; j < h; j++) {
+					uint32_t x0 = x[j];
+					uint32_t x1 = x[j + h];
+					uint32_t x2 = x[j + 2 * h];
+					uint32_t x3 = x[j + 3 * h];
+					uint32_t t0 = add(x0, x2);
+					uint32_t t1 = add(x1, x3);
+					uint32_t t2 = sub(x0, x2);
+					uint32_t t3 = mul(sub(x1, x3), i_root, i_root_shoup);
+					x[j] = add(t0, t1);
+					x[j + h] = mul(sub(t0, t1), half_level.w[j], half_level.w_shoup[j]);
+					x[j + 2 * h] = mul(add(t2, t3), level.w[j], level.w_shoup[j]);
+					x[j + 3 * h] = mul(sub(t2, t3), level.w3[j], level.w3_shoup[j]);
+				}
+			}
+		}
+	}
+
+	// The same two layers backwards, with X1 = x1 r^(-2j), X2 = x2 r^-j,
+	// X3 = x3 r^(-3j) and i = r^-h:
+	//
+	//     (x0 + X1) + (X2 + X3), (x0 - X1) + (X2 - X3) i,
+	//     (x0 + X1) - (X2 + X3), (x0 - X1) - (X2 - X3) i.
+	static void inverse(uint32_t * a, unsigned log_size, const Tables& tables) {
+		size_t size = size_t{1} << log_size;
+		unsigned k = 2;
+		for (; k <= log_size; k += 2) {
+			const Level& level = tables[k];
+			const Level& half_level = tables[k - 1];
+			size_t block = size_t{1} << k;
+			size_t h = block / 4;
+			uint64_t i_root = level.iw[h];
+			uint64_t i_root_shoup = level.iw_shoup[h];
+			for (size_t start = 0; start < size; start += block) {
+				uint32_t * x = a + start;
+				for (size_t j = 0; j < h; j++) {
+					uint32_t x0 = x[j];
+					uint32_t x1 = mul(x[j + h], half_level.iw[j], half_level.iw_shoup[j]);
+					uint32_t x2 = mul(x[j + 2 * h], level.iw[j], level.iw_shoup[j]);
+					uint32_t x3 = mul(x[j + 3 * h], level.iw3[j], level.iw3_shoup[j]);
+					uint32_t s0 = add(x0, x1);
+					uint32_t d0 = sub(x0, x1);
+					uint32_t s1 = add(x2, x3);
+					uint32_t d1 = mul(sub(x2, x3), i_root, i_root_shoup);
+					x[j] = add(s0, s1);
+					x[j + h] = add(d0, d1);
+					x[j + 2 * h] = sub(s0, s1);
+					x[j + 3 * h] = sub(d0, d1);
+				}
+			}
+		}
+		if (log_size % 2 == 1) {
+			const Level& level = tables[log_size];
+			size_t h = size / 2;
+			for (size_t j = 0; j < h; j++) {
+				uint32_t u = a[j];
+				uint32_t v = mul(a[j + h], level.iw[j], level.iw_shoup[j]);
+				a[j] = add(u, v);
+				a[j + h] = sub(u, v);
+			}
+		}
+	}
+};
+
+// Three primes of the form c 2^k + 1 with k >= 23. The first one alone is
+// enough for tiny p, the first two multiply to a bit under 2^59, and all three
+// multiply to a bit under 2^86, which is enough to hold any coefficient of a
+// product over GF(p) with p < 2^32 for polynomials with fewer than 2^21
+// coefficients.
+constexpr uint32_t crt_primes[3] = { 998244353, 469762049, 167772161 };
+
+// How many of the primes it takes to hold every coefficient of a product over
+// GF(p) of polynomials with na and nb coefficients, taken as an integer, or 0
+// if all three aren't enough or the transforms would be too big.
+template<uint32_t p>
+size_t crt_primes_needed(size_t na, size_t nb) {
+	// 998244353 has the fewest factors of two, so if it fits, they all do.
+	if (!Transform<crt_primes[0]>::fits(na, nb)) {
+		return 0;
+	}
+	unsigned __int128 largest = static_cast<unsigned __int128>(p - 1) * (p - 1) * std::min(na, nb);
+	unsigned __int128 modulus = 1;
+	for (size_t count = 1; count <= 3; count++) {
+		modulus *= crt_primes[count - 1];
+		if (largest < modulus) {
+			return count;
+		}
+	}
+	return 0;
+}
+
+// out = a b mod p, going through the exact integer product mod the first
+// num_primes of crt_primes. Garner's algorithm puts the residues back
+// together, reducing mod p as it goes so that nothing needs more than 128
+// bits.
+template<uint32_t p>
+void crt_convolve(const uint32_t * a, size_t na, const uint32_t * b, size_t nb, uint32_t * out, size_t num_primes) {
+	constexpr uint64_t m0 = crt_primes[0];
+	constexpr uint64_t m1 = crt_primes[1];
+	constexpr uint64_t m2 = crt_primes[2];
+	constexpr uint64_t m0_inv_mod_m1 = pow_mod_64(m0, m1 - 2, m1);
+	constexpr uint64_t m0_m1_inv_mod_m2 = pow_mod_64(m0 * m1 % m2, m2 - 2, m2);
+	constexpr uint64_t m0_m1_mod_p = m0 * m1 % p;
+	size_t n = na + nb - 1;
+	bool squaring = a == b && na == nb;
+	std::array<std::vector<uint32_t>, 3> residues;
+	auto convolve_mod = [&](auto modulus, std::vector<uint32_t>& result) {
+		constexpr uint32_t m = decltype(modulus)::value;
+		std::vector<uint32_t> a_mod(a, a + na);
+		std::vector<uint32_t> b_mod(b, b + (squaring ? 0 : nb));
+		if constexpr (p > m) {
+			for (uint32_t& c : a_mod) {
+				c %= m;
+			}
+			for (uint32_t& c : b_mod) {
+				c %= m;
+			}
+		}
+		result.resize(n);
+		const uint32_t * b_data = squaring ? a_mod.data() : b_mod.data();
+		Transform<m>::convolve(a_mod.data(), na, b_data, nb, result.data());
+	};
+	convolve_mod(std::integral_constant<uint32_t, m0>{}, residues[0]);
+	if (num_primes == 1) {
+		for (size_t i = 0; i < n; i++) {
+			out[i] = residues[0][i] % p;
+		}
+		return;
+	}
+	convolve_mod(std::integral_constant<uint32_t, m1>{}, residues[1]);
+	if (num_primes == 3) {
+		convolve_mod(std::integral_constant<uint32_t, m2>{}, residues[2]);
+	}
+	for (size_t i = 0; i < n; i++) {
+		uint64_t r0 = residues[0][i];
+		uint64_t r1 = residues[1][i];
+		// x = r0 + m0 y1 + m0 m1 y2
+		uint64_t y1 = (r1 + m1 - r0 % m1) % m1 * m0_inv_mod_m1 % m1;
+		uint64_t x01 = r0 + m0 * y1;
+		if (num_primes == 2) {
+			out[i] = static_cast<uint32_t>(x01 % p);
+			continue;
+		}
+		uint64_t r2 = residues[2][i];
+		uint64_t y2 = (r2 + m2 - x01 % m2) % m2 * m0_m1_inv_mod_m2 % m2;
+		out[i] = static_cast<uint32_t>((x01 % p + static_cast<unsigned __int128>(m0_m1_mod_p) * y2) % p);
+	}
+}
+
+}
+
+// The NTT for Polynomial<GF1<p>>. If p - 1 has enough factors of two, it
+// transforms over GF(p) directly, and otherwise it goes through
+// ntt::crt_convolve. Anything too small or too big for either goes back to
+// Karatsuba and Toom-3.
+template<uint32_t p, template<uint32_t> typename Reduction>
+class GF1_NTT_Multiplier {
+public:
+	using GF1s = GF1<p, Reduction>;
+
+	static constexpr bool native = p % 2 == 1 && two_adicity(p - 1) >= 16;
+
+	static bool multiply(const GF1s * a, size_t na, const GF1s * b, size_t nb, GF1s * out) {
+		size_t shorter = std::min(na, nb);
+		bool use_native = false;
+		if constexpr (native) {
+			use_native = shorter >= POLYNOMIAL_NTT_THRESHOLD && ntt::Transform<p>::fits(na, nb);
+		}
+		size_t num_primes = 0;
+		if (!use_native) {
+			if (shorter < POLYNOMIAL_NTT_CRT_THRESHOLD) {
+				return false;
+			}
+			num_primes = ntt::crt_primes_needed<p>(na, nb);
+			if (num_primes == 0) {
+				return false;
+			}
+		}
+		bool squaring = a == b && na == nb;
+		std::vector<uint32_t> a_vals(na);
+		std::vector<uint32_t> b_vals(squaring ? 0 : nb);
+		std::vector<uint32_t> out_vals(na + nb - 1);
+		for (size_t i = 0; i < na; i++) {
+			a_vals[i] = static_cast<uint32_t>(a[i].get_val());
+		}
+		for (size_t i = 0; i < b_vals.size(); i++) {
+			b_vals[i] = static_cast<uint32_t>(b[i].get_val());
+		}
+		const uint32_t * b_data = squaring ? a_vals.data() : b_vals.data();
+		if constexpr (native) {
+			if (use_native) {
+				ntt::Transform<p>::convolve(a_vals.data(), na, b_data, nb, out_vals.data());
+			} else {
+				ntt::crt_convolve<p>(a_vals.data(), na, b_data, nb, out_vals.data(), num_primes);
+			}
+		} else {
+			ntt::crt_convolve<p>(a_vals.data(), na, b_data, nb, out_vals.data(), num_primes);
+		}
+		for (size_t i = 0; i < out_vals.size(); i++) {
+			out[i] = GF1s{ out_vals[i] };
+		}
+		return true;
+	}
+};
+
+}
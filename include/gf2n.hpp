@@ -0,0 +1,438 @@
+#pragma once
+#include "field-context.hpp"
+#include "finite-field.hpp"
+#include "polynomial.hpp"
+#include "remove-v-tables.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Define GF2N_NO_CLMUL to always use the portable carry-less multiply.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(GF2N_NO_CLMUL)
+#define GF2N_CLMUL
+#include <immintrin.h>
+#endif
+
+namespace cherry {
+
+// Carry-less multiplication of two 64-bit polynomials over GF(2) into a
+// 128-bit product. Uses PCLMULQDQ when the CPU has it.
+namespace clmul {
+
+// Four bits of b at a time against a table of a times every polynomial of
+// degree less than four.
+constexpr void portable_64(uint64_t a, uint64_t b, uint64_t& lo, uint64_t& hi) {
+	unsigned __int128 table[16]{};
+	table[1] = a;
+	for (size_t i = 2; i < 16; i++) {
+		table[i] = (i % 2 == 0) ? table[i / 2] << 1 : table[i - 1] ^ a;
+	}
+	unsigned __int128 r = 0;
+	for (int i = 60; i >= 0; i -= 4) {
+		r = (r << 4) ^ table[(b >> i) & 15];
+	}
+	lo = static_cast<uint64_t>(r);
+	hi = static_cast<uint64_t>(r >> 64);
+}
+
+#ifdef GF2N_CLMUL
+inline bool cpu_has_pclmul() {
+	static const bool has_pclmul = __builtin_cpu_supports("pclmul");
+	return has_pclmul;
+}
+
+__attribute__((target("pclmul")))
+inline void hardware_64(uint64_t a, uint64_t b, uint64_t& lo, uint64_t& hi) {
+	__m128i r = _mm_clmulepi64_si128(
+		_mm_cvtsi64_si128(static_cast<long long>(a)),
+		_mm_cvtsi64_si128(static_cast<long long>(b)),
+		0
+	);
+	lo = static_cast<uint64_t>(_mm_cvtsi128_si64(r));
+	hi = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(r, r)));
+}
+#endif
+
+inline void mul_64(uint64_t a, uint64_t b, uint64_t& lo, uint64_t& hi) {
+	#ifdef GF2N_CLMUL
+	if (cpu_has_pclmul()) {
+		hardware_64(a, b, lo, hi);
+		return;
+	}
+	#endif
+	portable_64(a, b, lo, hi);
+}
+
+}
+
+// GF(2^n) with the modulus x^n + poly, for n up to 128, where the bits of
+// poly are the coefficients of everything below x^n (so poly = 0x1b is the
+// AES polynomial x^8 + x^4 + x^3 + x + 1 when n = 8). Since poly is a
+// uint64_t, the modulus can't have any terms between x^64 and x^n, which
+// isn't a problem for any of the usual choices.
+//
+// Elements are just bit strings, multiplied with a carry-less multiply and
+// then reduced. If poly is sparse (a trinomial or pentanomial, say), the
+// reduction is a few shifts and XORs per term. Otherwise, it multiplies the
+// overflow by poly with another carry-less multiply.
+//
+// You can use GF2n on its own, or as the Repr of GF<2, Repr>, in which case
+// the irreducible polynomial you hand to GF has to be x^n + poly. Nothing
+// checks that x^n + poly is actually irreducible, so make sure it is.
+template<unsigned int n, uint64_t poly>
+class GF2n COLON_IN_CLASS_INHERITANCE DIVISION_RING(GF2n<n COMMA poly>) {
+	static_assert(n >= 2 && n <= 128, "GF2n only supports 2 <= n <= 128.");
+	static_assert(n >= 64 || (poly >> n) == 0, "poly has to have degree less than n.");
+	static_assert(poly % 2 == 1, "x^n + poly can't be irreducible without a constant term.");
+public:
+	static constexpr size_t num_limbs = (n + 63) / 64;
+	using Limbs = std::array<uint64_t, num_limbs>;
+	using GF2ns = GF2n<n, poly>;
+
+	GF2n() : val{} {}
+
+	explicit GF2n(const Limbs& bits) : val{reduce(widen(bits))} {}
+
+	GF2n(const Polynomial<GF1<2>>& irreducible) : val{} {
+		check_modulus(irreducible);
+	}
+
+	// Horner's rule, so vals can have any degree.
+	GF2n(const Polynomial<GF1<2>>& irreducible, const Polynomial<GF1<2>>& vals) : val{} {
+		check_modulus(irreducible);
+		for (size_t i = vals.degree(); i <= vals.degree(); i--) {
+			mul_by_x();
+			val[0] ^= vals[i].get_val();
+		}
+	}
+
+	GF2ns operator+(const GF2ns& other) const OVERRIDE {
+		GF2ns out{ *this };
+		out += other;
+		return out;
+	}
+
+	GF2ns& operator+=(const GF2ns& other) OVERRIDE {
+		for (size_t i = 0; i < num_limbs; i++) {
+			val[i] ^= other.val[i];
+		}
+		return *this;
+	}
+
+	GF2ns operator-() const OVERRIDE {
+		return *this;
+	}
+
+	void negate() OVERRIDE {}
+
+	GF2ns operator-(const GF2ns& other) const OVERRIDE {
+		return *this + other;
+	}
+
+	GF2ns& operator-=(const GF2ns& other) OVERRIDE {
+		return *this += other;
+	}
+
+	GF2ns operator*(const GF2ns& other) const OVERRIDE {
+		GF2ns out;
+		out.val = mul(val, other.val);
+		return out;
+	}
+
+	GF2ns& operator*=(const GF2ns& other) OVERRIDE {
+		val = mul(val, other.val);
+		return *this;
+	}
+
+	GF2ns operator*(const GF1<2>& other) const {
+		return other.get_val() ? *this : GF2ns{};
+	}
+
+	GF2ns& operator*=(const GF1<2>& other) {
+		if (!other.get_val()) {
+			val = Limbs{};
+		}
+		return *this;
+	}
+
+	GF2ns operator/(const GF2ns& other) const OVERRIDE {
+		return *this * other.inv();
+	}
+
+	GF2ns& operator/=(const GF2ns& other) OVERRIDE {
+		*this *= other.inv();
+		return *this;
+	}
+
+	// Itoh-Tsujii. The inverse is a^(2^n - 2) = (a^(2^(n - 1) - 1))^2, and
+	// a^(2^k - 1) for k = n - 1 comes from an addition chain on the bits of
+	// n - 1, using a^(2^(2k) - 1) = (a^(2^k - 1))^(2^k) a^(2^k - 1). That's
+	// n - 1 squarings but only about 2 log(n) multiplications.
+	GF2ns inv() const OVERRIDE {
+		if (val == Limbs{}) {
+			throw std::domain_error(
+				"Trying to take the multiplicative inverse of "
+				"the additive identity (i.e. dividing by zero)."
+			);
+		}
+		constexpr unsigned int m = n - 1;
+		GF2ns beta = *this;
+		unsigned int k = 1;
+		for (int bit = std::bit_width(m) - 2; bit >= 0; bit--) {
+			GF2ns t = beta;
+			for (unsigned int i = 0; i < k; i++) {
+				t *= t;
+			}
+			beta = t * beta;
+			k *= 2;
+			if ((m >> bit) & 1) {
+				beta = beta * beta * *this;
+				k++;
+			}
+		}
+		return beta * beta;
+	}
+
+	GF2ns operator^(int pow) const OVERRIDE {
+		if (pow < 0) {
+			return inv().pow_u(static_cast<uint32_t>(-static_cast<int64_t>(pow)));
+		}
+		return pow_u(static_cast<uint32_t>(pow));
+	}
+
+	GF2ns pow_u(uint32_t pow) const OVERRIDE {
+		GF2ns out = one();
+		GF2ns val_pow = *this;
+		while (pow > 0) {
+			if (pow & 1) {
+				out *= val_pow;
+			}
+			val_pow *= val_pow;
+			pow >>= 1;
+		}
+		return out;
+	}
+
+	// Bit i is the coefficient of x^i.
+	const Limbs& get_bits() const {
+		return val;
+	}
+
+	bool operator==(const GF2ns& other) const {
+		return val == other.val;
+	}
+
+	void to_identity() {
+		val = one().val;
+	}
+
+	Polynomial<GF1<2>> to_poly() const {
+		std::vector<GF1<2>> coeffs;
+		coeffs.reserve(n);
+		for (size_t i = 0; i < n; i++) {
+			coeffs.emplace_back((val[i / 64] >> (i % 64)) & 1);
+		}
+		return coeffs;
+	}
+
+	std::string to_string() const {
+		return to_poly().to_string();
+	}
+
+	explicit operator std::string() const {
+		return to_string();
+	}
+
+	// The field context for x^n + poly, which GF<2, GF2n<n, poly>> uses for
+	// norms and subfields.
+	static const Field_Context<2> * get_context() {
+		static const Field_Context<2> * context = Field_Context<2>::get(modulus());
+		return context;
+	}
+
+	// The trace is linear, so it's the parity of the bits where Tr(x^i) = 1.
+	GF1<2> trace() const {
+		static const Limbs mask = trace_mask();
+		uint64_t bits = 0;
+		for (size_t i = 0; i < num_limbs; i++) {
+			bits ^= val[i] & mask[i];
+		}
+		return GF1<2>{static_cast<uint64_t>(std::popcount(bits) & 1)};
+	}
+
+	static Polynomial<GF1<2>> modulus() {
+		std::vector<GF1<2>> coeffs(n + 1, GF1<2>{0});
+		for (size_t i = 0; i < 64 && i < n; i++) {
+			coeffs[i] = (poly >> i) & 1;
+		}
+		coeffs[n] = 1;
+		return coeffs;
+	}
+public:
+	static GF2ns member_zero(const void * other_data = nullptr) {
+		(void)other_data;
+		return GF2ns{};
+	}
+
+	static GF2ns member_one(const void * other_data = nullptr) {
+		(void)other_data;
+		return one();
+	}
+private:
+	using Wide = std::array<uint64_t, 2 * num_limbs>;
+
+	static Limbs trace_mask() {
+		Limbs mask{};
+		const std::vector<GF1<2>>& traces = get_context()->get_traces();
+		for (size_t i = 0; i < n; i++) {
+			if (traces[i] == GF1<2>{1}) {
+				mask[i / 64] |= uint64_t{1} << (i % 64);
+			}
+		}
+		return mask;
+	}
+
+	static constexpr size_t num_taps = std::popcount(poly);
+	static constexpr bool sparse = num_taps <= 8;
+
+	static constexpr std::array<unsigned int, num_taps> compute_taps() {
+		std::array<unsigned int, num_taps> out{};
+		size_t j = 0;
+		for (unsigned int i = 0; i < 64; i++) {
+			if ((poly >> i) & 1) {
+				out[j++] = i;
+			}
+		}
+		return out;
+	}
+
+	static constexpr std::array<unsigned int, num_taps> taps = compute_taps();
+
+	static GF2ns one() {
+		GF2ns out;
+		out.val[0] = 1;
+		return out;
+	}
+
+	static Wide widen(const Limbs& bits) {
+		Wide out{};
+		for (size_t i = 0; i < num_limbs; i++) {
+			out[i] = bits[i];
+		}
+		return out;
+	}
+
+	static Limbs mul(const Limbs& a, const Limbs& b) {
+		Wide product{};
+		for (size_t i = 0; i < num_limbs; i++) {
+			for (size_t j = 0; j < num_limbs; j++) {
+				uint64_t lo, hi;
+				clmul::mul_64(a[i], b[j], lo, hi);
+				product[i + j] ^= lo;
+				product[i + j + 1] ^= hi;
+			}
+		}
+		return reduce(product);
+	}
+
+	// Splits v into high * x^n + low and replaces it with high * poly + low
+	// until nothing is left at or above x^n. For sparse moduli, this only
+	// takes two rounds.
+	static Limbs reduce(Wide v) {
+		constexpr size_t q = n / 64;
+		constexpr size_t r = n % 64;
+		while (true) {
+			Limbs high{};
+			uint64_t any = 0;
+			for (size_t i = 0; i < num_limbs && i + q < v.size(); i++) {
+				high[i] = v[i + q] >> r;
+				if (r != 0 && i + q + 1 < v.size()) {
+					high[i] |= v[i + q + 1] << ((64 - r) % 64);
+				}
+				any |= high[i];
+			}
+			if (any == 0) {
+				break;
+			}
+			if constexpr (r == 0) {
+				v[q] = 0;
+			} else {
+				v[q] &= (uint64_t{1} << r) - 1;
+			}
+			for (size_t i = q + 1; i < v.size(); i++) {
+				v[i] = 0;
+			}
+			if constexpr (sparse) {
+				for (unsigned int t : taps) {
+					for (size_t i = 0; i < num_limbs; i++) {
+						v[i] ^= high[i] << t;
+						if (t != 0) {
+							v[i + 1] ^= high[i] >> (64 - t);
+						}
+					}
+				}
+			} else {
+				for (size_t i = 0; i < num_limbs; i++) {
+					uint64_t lo, hi;
+					clmul::mul_64(high[i], poly, lo, hi);
+					v[i] ^= lo;
+					v[i + 1] ^= hi;
+				}
+			}
+		}
+		Limbs out{};
+		for (size_t i = 0; i < num_limbs; i++) {
+			out[i] = v[i];
+		}
+		return out;
+	}
+
+	void mul_by_x() {
+		uint64_t carry = 0;
+		for (size_t i = 0; i < num_limbs; i++) {
+			uint64_t next_carry = val[i] >> 63;
+			val[i] = (val[i] << 1) | carry;
+			carry = next_carry;
+		}
+		constexpr size_t top_limb = n / 64;
+		constexpr size_t top_bit = n % 64;
+		bool overflow;
+		if constexpr (top_limb == num_limbs) {
+			overflow = carry;
+		} else {
+			overflow = (val[top_limb] >> top_bit) & 1;
+			val[top_limb] &= ~(uint64_t{1} << top_bit);
+		}
+		if (overflow) {
+			val[0] ^= poly;
+		}
+	}
+
+	static void check_modulus(const Polynomial<GF1<2>>& irreducible) {
+		bool matches = irreducible.degree() == n;
+		for (size_t i = 0; i < n && matches; i++) {
+			uint64_t expected = i < 64 ? (poly >> i) & 1 : 0;
+			matches = irreducible[i].get_val() == expected;
+		}
+		if (!matches || irreducible[n].get_val() != 1) {
+			throw std::invalid_argument(
+				"The irreducible polynomial doesn't match the one GF2n was "
+				"instantiated with."
+			);
+		}
+	}
+
+	Limbs val;
+};
+
+template<unsigned int n, uint64_t poly>
+std::ostream& operator<<(std::ostream& s, const GF2n<n, poly>& value) {
+	s << value.to_poly();
+	return s;
+}
+
+}
@@ -1,6 +1,10 @@
 #pragma once
 #include <cctype>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
 #include <type_traits>
+#include <vector>
 
 namespace cherry {
 
@@ -37,6 +41,93 @@ constexpr T one(const void * other_data = nullptr) {
 	return T::member_one(other_data);
 }
 
+// Adds up products of pairs of elements. This one just does sum += a * b,
+// but types that can put off reducing until the end (like GF1<p>)
+// specialize Accumulator_For to do better.
+template<typename T>
+class Plain_Accumulator {
+public:
+	Plain_Accumulator(const T& initial) : sum(initial) {}
+
+	void add_product(const T& a, const T& b) {
+		sum += a * b;
+	}
+
+	T result() const {
+		return sum;
+	}
+private:
+	T sum;
+};
+
+template<typename T>
+struct Accumulator_For {
+	using type = Plain_Accumulator<T>;
+};
+
+template<typename T>
+using Accumulator = typename Accumulator_For<T>::type;
+
+// Xorshift, for the algorithms that need to make random choices. They all
+// start from a fixed seed, so every run makes the same ones.
+inline uint64_t next_random(uint64_t& seed) {
+	seed ^= seed << 13;
+	seed ^= seed >> 7;
+	seed ^= seed << 17;
+	return seed;
+}
+
+// Montgomery's trick: inverts every element of values with a single call to
+// inv() and 3(n - 1) multiplications. If P_i = a_0 a_1 ... a_i, then
+// a_i^-1 = P_i^-1 P_(i - 1) and P_(i - 1)^-1 = a_i P_i^-1, so we only ever
+// need the inverse of the full product. The products are kept in the right
+// order, so this also works for matrices.
+//
+// If any element doesn't have an inverse, neither does the product, so you
+// get whatever inv() throws for it and out is left with partial products.
+template<typename T>
+void batch_inv(std::span<const T> values, std::span<T> out) {
+	if (values.size() != out.size()) {
+		throw std::length_error(
+			"batch_inv needs an output span the same size as its input."
+		);
+	}
+	if (values.empty()) {
+		return;
+	}
+	// out holds the prefix products until we overwrite them on the way back.
+	out[0] = values[0];
+	for (size_t i = 1; i < values.size(); i++) {
+		out[i] = out[i - 1] * values[i];
+	}
+	T cur_inv = inv(out.back());
+	for (size_t i = values.size() - 1; i > 0; i--) {
+		out[i] = cur_inv * out[i - 1];
+		cur_inv = values[i] * cur_inv;
+	}
+	out[0] = cur_inv;
+}
+
+template<typename T>
+void batch_inv(std::span<T> values) {
+	if (values.empty()) {
+		return;
+	}
+	std::vector<T> prefix;
+	prefix.reserve(values.size());
+	prefix.push_back(values[0]);
+	for (size_t i = 1; i < values.size(); i++) {
+		prefix.push_back(prefix.back() * values[i]);
+	}
+	T cur_inv = inv(prefix.back());
+	for (size_t i = values.size() - 1; i > 0; i--) {
+		T value = values[i];
+		values[i] = cur_inv * prefix[i - 1];
+		cur_inv = value * cur_inv;
+	}
+	values[0] = cur_inv;
+}
+
 // class GF1_Base {};
 // 
 // template<typename T, std::enable_if_t<std::is_base_of_v<GF1_Base, T>, bool> = true>
@@ -0,0 +1,587 @@
+#pragma once
+#include "division-ring.hpp"
+#include "finite-field.hpp"
+#include "matrix.hpp"
+#include "remove-v-tables.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace cherry {
+
+// Matrix<GF1<2>> spends a whole byte on every entry and works on them one at
+// a time. Matrix_GF2 packs 64 entries into each word instead. Every row
+// starts on a new word, so adding one row to another is just XORing words,
+// and the bits past the last column are always kept at zero.
+//
+// Multiplication uses the Method of Four Russians (M4RM), and inv, rref and
+// rank use the elimination version of it (M4RI). Both work through the
+// matrix eight columns at a time, build a table of every sum of the eight
+// rows involved, and then handle each row with a single table lookup.
+class Matrix_GF2 COLON_IN_CLASS_INHERITANCE DIVISION_RING(Matrix_GF2) COMMA_IN_CLASS_INHERITANCE {
+public:
+	using Word = uint64_t;
+	static constexpr size_t word_bits = 64;
+	// How many columns M4RM and M4RI handle at once. Has to divide word_bits
+	// so that a block never straddles two words.
+	static constexpr size_t block_size = 8;
+
+	// You can't have a reference to a single bit, so operator() hands one of
+	// these back instead.
+	class Bit_Reference {
+	public:
+		Bit_Reference(Word * w, Word m) : word(w), mask(m) {}
+
+		Bit_Reference& operator=(const GF1<2>& v) {
+			if (v.get_val()) {
+				*word |= mask;
+			} else {
+				*word &= ~mask;
+			}
+			return *this;
+		}
+
+		Bit_Reference& operator=(const Bit_Reference& other) {
+			return *this = static_cast<GF1<2>>(other);
+		}
+
+		Bit_Reference& operator+=(const GF1<2>& v) {
+			if (v.get_val()) {
+				*word ^= mask;
+			}
+			return *this;
+		}
+
+		Bit_Reference& operator-=(const GF1<2>& v) {
+			return *this += v;
+		}
+
+		operator GF1<2>() const {
+			return GF1<2>{(*word & mask) != 0};
+		}
+
+		bool operator==(const GF1<2>& v) const {
+			return static_cast<GF1<2>>(*this) == v;
+		}
+	private:
+		Word * word;
+		Word mask;
+	};
+
+	Matrix_GF2(const GF1<2>& fill, size_t rows) : Matrix_GF2(fill, rows, rows) {}
+
+	Matrix_GF2(const GF1<2>& fill, size_t rows, size_t cols) : num_rows(rows), num_cols(cols), words_per_row((cols + word_bits - 1) / word_bits), data(num_rows * words_per_row, 0) {
+		if (num_rows == 0 || num_cols == 0) {
+			std::string error_message{std::format("Cannot create a matrix of dimensions {}x{}! Neither dimension can be zero.", num_rows, num_cols)};
+			throw std::length_error(error_message);
+		}
+		if (fill.get_val()) {
+			for (size_t row = 0; row < num_rows; row++) {
+				for (size_t w = 0; w < words_per_row; w++) {
+					data[row * words_per_row + w] = ~Word{0};
+				}
+				data[row * words_per_row + words_per_row - 1] &= last_word_mask();
+			}
+		}
+	}
+
+	explicit Matrix_GF2(const Matrix<GF1<2>>& other) : Matrix_GF2(GF1<2>{0}, other.get_num_rows(), other.get_num_cols()) {
+		for (size_t row = 0; row < num_rows; row++) {
+			for (size_t col = 0; col < num_cols; col++) {
+				if (other(row, col).get_val()) {
+					data[row * words_per_row + col / word_bits] |= Word{1} << (col % word_bits);
+				}
+			}
+		}
+	}
+
+	Matrix<GF1<2>> to_matrix() const {
+		Matrix<GF1<2>> out{GF1<2>{0}, num_rows, num_cols};
+		for (size_t row = 0; row < num_rows; row++) {
+			for (size_t col = 0; col < num_cols; col++) {
+				out(row, col) = (*this)(row, col);
+			}
+		}
+		return out;
+	}
+
+	Bit_Reference operator()(size_t r, size_t c) {
+		return Bit_Reference{&data[r * words_per_row + c / word_bits], Word{1} << (c % word_bits)};
+	}
+
+	GF1<2> operator()(size_t r, size_t c) const {
+		return GF1<2>{bit(r, c)};
+	}
+
+	Matrix_GF2 operator+(const Matrix_GF2& other) const OVERRIDE {
+		Matrix_GF2 out{*this};
+		out += other;
+		return out;
+	}
+
+	Matrix_GF2& operator+=(const Matrix_GF2& other) OVERRIDE {
+		check_addition_size(other, "add");
+		for (size_t i = 0; i < data.size(); i++) {
+			data[i] ^= other.data[i];
+		}
+		return *this;
+	}
+
+	Matrix_GF2 operator-(const Matrix_GF2& other) const OVERRIDE {
+		check_addition_size(other, "subtract");
+		return *this + other;
+	}
+
+	Matrix_GF2& operator-=(const Matrix_GF2& other) OVERRIDE {
+		check_addition_size(other, "subtract");
+		return *this += other;
+	}
+
+	// M4RM. For every block of eight rows of other, every sum of those rows
+	// goes into a table, and then the matching byte of each row of this
+	// matrix says which entry of the table to add to the output.
+	Matrix_GF2 operator*(const Matrix_GF2& other) const OVERRIDE {
+		check_multiplication_size(other);
+		Matrix_GF2 out{GF1<2>{0}, num_rows, other.num_cols};
+		const size_t width = other.words_per_row;
+		std::vector<Word> table((size_t{1} << block_size) * width, 0);
+		for (size_t k = 0; k < num_cols; k += block_size) {
+			size_t rows_in_block = std::min(block_size, num_cols - k);
+			for (size_t i = 1; i < (size_t{1} << rows_in_block); i++) {
+				const Word * prev = &table[(i & (i - 1)) * width];
+				const Word * row = other.row_ptr(k + std::countr_zero(i));
+				Word * entry = &table[i * width];
+				for (size_t w = 0; w < width; w++) {
+					entry[w] = prev[w] ^ row[w];
+				}
+			}
+			for (size_t row = 0; row < num_rows; row++) {
+				size_t index = window(row, k);
+				if (index == 0) {
+					continue;
+				}
+				const Word * entry = &table[index * width];
+				Word * out_row = out.row_ptr(row);
+				for (size_t w = 0; w < width; w++) {
+					out_row[w] ^= entry[w];
+				}
+			}
+		}
+		return out;
+	}
+
+	Matrix_GF2& operator*=(const Matrix_GF2& other) OVERRIDE {
+		*this = (*this * other);
+		return *this;
+	}
+
+	Matrix_GF2 operator-() const OVERRIDE {
+		return *this;
+	}
+
+	void negate() OVERRIDE {}
+
+	Matrix_GF2 pow_u(unsigned int pow) const OVERRIDE {
+		check_square("Exponentiation");
+		Matrix_GF2 out{GF1<2>{0}, num_rows, num_cols};
+		out.to_identity();
+		Matrix_GF2 val_pow{ *this };
+		while (pow > 0) {
+			if (pow & 1) {
+				out *= val_pow;
+			}
+			val_pow *= val_pow;
+			pow >>= 1;
+		}
+		return out;
+	}
+
+	Matrix_GF2 operator^(int pow) const OVERRIDE {
+		if (pow < 0) {
+			return inv().pow_u(static_cast<unsigned int>(std::abs(pow)));
+		} else {
+			return pow_u(static_cast<unsigned int>(std::abs(pow)));
+		}
+	}
+
+	size_t get_num_rows() const {
+		return num_rows;
+	}
+
+	size_t get_num_cols() const {
+		return num_cols;
+	}
+
+	Matrix_GF2 operator/(const Matrix_GF2& other) const OVERRIDE {
+		return (*this) * other.inv();
+	}
+
+	Matrix_GF2& operator/=(const Matrix_GF2& other) OVERRIDE {
+		*this *= other.inv();
+		return *this;
+	}
+
+	// Runs M4RI on [this | I] and reads the inverse off the right half. The
+	// left half gets padded out to a whole number of words so that the right
+	// half can be copied out a word at a time.
+	Matrix_GF2 inv() const OVERRIDE {
+		check_square("Inversion");
+		const size_t left_words = words_per_row;
+		Matrix_GF2 augmented{GF1<2>{0}, num_rows, left_words * word_bits + num_cols};
+		for (size_t row = 0; row < num_rows; row++) {
+			const Word * src = row_ptr(row);
+			Word * dest = augmented.row_ptr(row);
+			for (size_t w = 0; w < left_words; w++) {
+				dest[w] = src[w];
+			}
+			augmented(row, left_words * word_bits + row) = GF1<2>{1};
+		}
+		if (augmented.reduce_to_rref(num_cols) < num_rows) {
+			throw std::domain_error("Matrix does not have an inverse.");
+		}
+		Matrix_GF2 inverse{GF1<2>{0}, num_rows, num_cols};
+		for (size_t row = 0; row < num_rows; row++) {
+			const Word * src = augmented.row_ptr(row) + left_words;
+			Word * dest = inverse.row_ptr(row);
+			for (size_t w = 0; w < words_per_row; w++) {
+				dest[w] = src[w];
+			}
+		}
+		return inverse;
+	}
+
+	// Unlike Matrix::rref, this one handles columns without pivots, so it
+	// works for singular and non-square matrices too.
+	Matrix_GF2 rref() const {
+		Matrix_GF2 out{*this};
+		out.reduce_to_rref(num_cols);
+		return out;
+	}
+
+	size_t rank() const {
+		Matrix_GF2 dummy{*this};
+		return dummy.reduce_to_rref(num_cols);
+	}
+
+	void to_zero() {
+		std::fill(data.begin(), data.end(), Word{0});
+	}
+
+	void to_identity() {
+		to_zero();
+		for (size_t i = 0; i < std::min(num_rows, num_cols); i++) {
+			(*this)(i, i) = GF1<2>{1};
+		}
+	}
+
+	void to_identity(GF1<2> val_to_set) {
+		to_zero();
+		if (val_to_set.get_val()) {
+			to_identity();
+		}
+	}
+
+	void to_nilpotent_diag(int start, GF1<2> val_to_set) {
+		to_zero();
+		if (val_to_set.get_val()) {
+			to_nilpotent_diag(start);
+		}
+	}
+
+	void to_nilpotent_diag(int start) {
+		to_zero();
+		if (start >= 0) {
+			for (size_t i = start; i < num_cols && i - start < num_rows; i++) {
+				(*this)(i - start, i) = GF1<2>{1};
+			}
+		} else {
+			size_t offset = std::abs(start);
+			for (size_t i = offset; i < num_rows && i - offset < num_cols; i++) {
+				(*this)(i, i - offset) = GF1<2>{1};
+			}
+		}
+	}
+
+	void to_circulant_diag(size_t start, GF1<2> val_to_set) {
+		to_zero();
+		if (val_to_set.get_val()) {
+			to_circulant_diag(start);
+		}
+	}
+
+	void to_circulant_diag(size_t start) {
+		to_zero();
+		for (size_t i = 0; i < num_rows; i++) {
+			(*this)(i, (i + start) % num_cols) = GF1<2>{1};
+		}
+	}
+
+	// Scaling by one does nothing, and scaling by zero clears the row.
+	void ero_scale(size_t row, const GF1<2>& scale, size_t start_col = 0) {
+		if (scale.get_val()) {
+			return;
+		}
+		Word * r = row_ptr(row);
+		size_t first_word = start_col / word_bits;
+		r[first_word] &= (Word{1} << (start_col % word_bits)) - 1;
+		for (size_t w = first_word + 1; w < words_per_row; w++) {
+			r[w] = 0;
+		}
+	}
+
+	void ero_swap(size_t r1, size_t r2) {
+		Word * a = row_ptr(r1);
+		Word * b = row_ptr(r2);
+		for (size_t w = 0; w < words_per_row; w++) {
+			std::swap(a[w], b[w]);
+		}
+	}
+
+	void ero_subtract_scaled_row_from_r1(size_t r1, size_t r2, const GF1<2>& scale, size_t start_col = 0) {
+		if (!scale.get_val()) {
+			return;
+		}
+		Word * a = row_ptr(r1);
+		const Word * b = row_ptr(r2);
+		size_t first_word = start_col / word_bits;
+		a[first_word] ^= b[first_word] & ~((Word{1} << (start_col % word_bits)) - 1);
+		for (size_t w = first_word + 1; w < words_per_row; w++) {
+			a[w] ^= b[w];
+		}
+	}
+
+	Matrix_GF2 operator*(const GF1<2>& scalar) const {
+		Matrix_GF2 out{*this};
+		out *= scalar;
+		return out;
+	}
+
+	Matrix_GF2& operator*=(const GF1<2>& scalar) {
+		if (!scalar.get_val()) {
+			to_zero();
+		}
+		return *this;
+	}
+
+	bool operator==(const Matrix_GF2& other) const {
+		check_addition_size(other, "Equality testing");
+		return data == other.data;
+	}
+
+	GF1<2> trace() const {
+		bool out = false;
+		for (size_t i = 0; i < std::min(num_rows, num_cols); i++) {
+			out ^= bit(i, i);
+		}
+		return GF1<2>{out};
+	}
+
+	struct Other_Data {
+		size_t rows;
+		size_t cols;
+	};
+
+	std::string to_string() const {
+		std::string out;
+		out.reserve(num_rows * (2 * num_cols + 1) + 1);
+		for (size_t row = 0; row < get_num_rows(); row++) {
+			for (size_t col = 0; col < get_num_cols(); col++) {
+				out += bit(row, col) ? "1 " : "0 ";
+			}
+			out += "\n";
+		}
+		out += "\n";
+		return out;
+	}
+
+	explicit operator std::string() const {
+		return to_string();
+	}
+public:
+	static Matrix_GF2 member_zero(const void * other_data) {
+		Other_Data o_data = *static_cast<const Other_Data*>(other_data);
+		return Matrix_GF2{GF1<2>{0}, o_data.rows, o_data.cols};
+	}
+
+	static Matrix_GF2 member_one(const void * other_data) {
+		Matrix_GF2 out(Matrix_GF2::member_zero(other_data));
+		out.to_identity();
+		return out;
+	}
+private:
+	bool bit(size_t r, size_t c) const {
+		return (data[r * words_per_row + c / word_bits] >> (c % word_bits)) & 1;
+	}
+
+	// The block_size bits of a row starting at col, which is always a
+	// multiple of block_size.
+	size_t window(size_t r, size_t col) const {
+		Word w = data[r * words_per_row + col / word_bits] >> (col % word_bits);
+		return w & ((Word{1} << block_size) - 1);
+	}
+
+	Word * row_ptr(size_t row) {
+		return &data[row * words_per_row];
+	}
+
+	const Word * row_ptr(size_t row) const {
+		return &data[row * words_per_row];
+	}
+
+	Word last_word_mask() const {
+		size_t used = num_cols % word_bits;
+		return used == 0 ? ~Word{0} : (Word{1} << used) - 1;
+	}
+
+	void xor_row(size_t dest, size_t src, size_t first_word) {
+		Word * a = row_ptr(dest);
+		const Word * b = row_ptr(src);
+		for (size_t w = first_word; w < words_per_row; w++) {
+			a[w] ^= b[w];
+		}
+	}
+
+	// M4RI. Takes the matrix to reduced row echelon form, only looking for
+	// pivots in the first col_limit columns, and returns the rank.
+	//
+	// For each block of columns, ordinary Gauss-Jordan finds up to
+	// block_size pivot rows and reduces them against each other. Usually a
+	// pivot turns up within a row or two, so this part is cheap. Then every
+	// sum of the pivot rows goes into a table, and every other row gets
+	// cleared in that block with one lookup and one row XOR.
+	size_t reduce_to_rref(size_t col_limit) {
+		size_t rank = 0;
+		std::vector<Word> table;
+		std::array<size_t, block_size> pivot_cols{};
+		std::array<uint8_t, size_t{1} << block_size> window_to_index{};
+		for (size_t c0 = 0; c0 < col_limit && rank < num_rows; c0 += block_size) {
+			const size_t first_word = c0 / word_bits;
+			const size_t c_end = std::min(c0 + block_size, col_limit);
+			size_t found = 0;
+			for (size_t c = c0; c < c_end && rank + found < num_rows; c++) {
+				for (size_t r = rank + found; r < num_rows; r++) {
+					for (size_t j = 0; j < found; j++) {
+						if (bit(r, pivot_cols[j])) {
+							xor_row(r, rank + j, first_word);
+						}
+					}
+					if (!bit(r, c)) {
+						continue;
+					}
+					ero_swap(r, rank + found);
+					for (size_t j = 0; j < found; j++) {
+						if (bit(rank + j, c)) {
+							xor_row(rank + j, rank + found, first_word);
+						}
+					}
+					pivot_cols[found++] = c;
+					break;
+				}
+			}
+			if (found == 0) {
+				continue;
+			}
+
+			const size_t width = words_per_row - first_word;
+			table.assign((size_t{1} << found) * width, 0);
+			for (size_t i = 1; i < (size_t{1} << found); i++) {
+				const Word * prev = &table[(i & (i - 1)) * width];
+				const Word * row = row_ptr(rank + std::countr_zero(i)) + first_word;
+				Word * entry = &table[i * width];
+				for (size_t w = 0; w < width; w++) {
+					entry[w] = prev[w] ^ row[w];
+				}
+			}
+			for (size_t w = 0; w < window_to_index.size(); w++) {
+				uint8_t index = 0;
+				for (size_t j = 0; j < found; j++) {
+					index |= ((w >> (pivot_cols[j] - c0)) & 1) << j;
+				}
+				window_to_index[w] = index;
+			}
+			for (size_t r = 0; r < num_rows; r++) {
+				if (r == rank) {
+					r += found - 1;
+					continue;
+				}
+				size_t index = window_to_index[window(r, c0)];
+				if (index == 0) {
+					continue;
+				}
+				const Word * entry = &table[index * width];
+				Word * dest = row_ptr(r) + first_word;
+				for (size_t w = 0; w < width; w++) {
+					dest[w] ^= entry[w];
+				}
+			}
+			rank += found;
+		}
+		return rank;
+	}
+
+	void check_addition_size(const Matrix_GF2& other, const char * operation) const {
+		if (num_rows != other.num_rows || num_cols != other.num_cols) {
+			throw std::out_of_range(
+				std::format(
+					"Trying to {} a matrix of dimensions {}x{} "
+					"to a matrix of dimensions {}x{}.",
+					operation,
+					num_rows,
+					num_cols,
+					other.num_rows,
+					other.num_cols
+				)
+			);
+		}
+	}
+
+	void check_multiplication_size(const Matrix_GF2& other) const {
+		if (num_cols != other.num_rows) {
+			throw std::out_of_range(
+				std::format(
+					"Trying to multiply a matrix of dimensions {}x{} "
+					"with a matrix of dimensions {}x{}.",
+					num_rows,
+					num_cols,
+					other.num_rows,
+					other.num_cols
+				)
+			);
+		}
+	}
+
+	void check_square(const char * operation) const {
+		if (num_rows != num_cols) {
+			throw std::invalid_argument(
+				std::format(
+					"{} only works with square matrices, but this "
+					"matrix has dimensions of {}x{}.",
+					operation,
+					num_rows,
+					num_cols
+				)
+			);
+		}
+	}
+private:
+	size_t num_rows;
+	size_t num_cols;
+	size_t words_per_row;
+	std::vector<Word> data;
+};
+
+inline Matrix_GF2 operator*(const GF1<2>& scalar, const Matrix_GF2& matrix) {
+	return matrix * scalar;
+}
+
+inline std::ostream& operator<<(std::ostream& s, const Matrix_GF2& matrix) {
+	s << matrix.to_string();
+	return s;
+}
+
+}
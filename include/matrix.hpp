@@ -1,8 +1,10 @@
 #pragma once
 #include "division-ring.hpp"
+#include "gf1-kernels.hpp"
 #include "identities.hpp"
 #include "remove-v-tables.hpp"
 #include <cstdlib>
+#include <span>
 #include <stdexcept>
 #include <vector>
 #include <format>
@@ -37,6 +39,10 @@ public:
 	Matrix<T> operator+(const Matrix<T>& other) const OVERRIDE {
 		check_addition_size(other, "add");
 		Matrix<T> out{zero<T>(other_data.get()), num_rows, num_cols, other_data};
+		if constexpr (kernels::Has_Kernels<T>) {
+			kernels::add<T>(out.data, data, other.data);
+			return out;
+		}
 		for (size_t i = 0; i < data.size(); i++) {
 			T& c = out.data[i];
 			const T& a = data[i];
@@ -48,6 +54,10 @@ public:
 
 	Matrix<T>& operator+=(const Matrix<T>& other) OVERRIDE {
 		check_addition_size(other, "add");
+		if constexpr (kernels::Has_Kernels<T>) {
+			kernels::add<T>(data, other.data);
+			return *this;
+		}
 		for (size_t i = 0; i < data.size(); i++) {
 			T& a = data[i];
 			const T& b = other.data[i];
@@ -59,6 +69,10 @@ public:
 	Matrix<T> operator-(const Matrix<T>& other) const OVERRIDE {
 		check_addition_size(other, "subtract");
 		Matrix<T> out{zero<T>(other_data.get()), num_rows, num_cols, other_data};
+		if constexpr (kernels::Has_Kernels<T>) {
+			kernels::sub<T>(out.data, data, other.data);
+			return out;
+		}
 		for (size_t i = 0; i < data.size(); i++) {
 			T& c = out.data[i];
 			const T& a = data[i];
@@ -70,6 +84,10 @@ public:
 
 	Matrix<T>& operator-=(const Matrix<T>& other) OVERRIDE {
 		check_addition_size(other, "subtract");
+		if constexpr (kernels::Has_Kernels<T>) {
+			kernels::sub<T>(data, other.data);
+			return *this;
+		}
 		for (size_t i = 0; i < data.size(); i++) {
 			T& a = data[i];
 			const T& b = other.data[i];
@@ -80,13 +98,23 @@ public:
 
 	Matrix<T> operator*(const Matrix<T>& other) const OVERRIDE {
 		check_multiplication_size(other);
-		Matrix<T> out{zero<T>(other_data.get()), num_rows, other.num_cols, other_data};
+		T zero_v = zero<T>(other_data.get());
+		Matrix<T> out{zero_v, num_rows, other.num_cols, other_data};
+		// Keeping a whole row of sums lets k go before j, so every read is
+		// contiguous. For GF1<p>, the sums only get reduced at the end.
+		std::vector<Accumulator<T>> row_sums;
 		for (size_t i = 0; i < num_rows; i++) {
-			for (size_t j = 0; j < other.num_cols; j++) {
-				for (size_t k = 0; k < num_cols; k++) {
-					out(i, j) += (*this)(i, k) * other(k, j);
+			row_sums.assign(other.num_cols, Accumulator<T>{zero_v});
+			for (size_t k = 0; k < num_cols; k++) {
+				const T& a = data[i * num_cols + k];
+				const T * other_row = &other.data[k * other.num_cols];
+				for (size_t j = 0; j < other.num_cols; j++) {
+					row_sums[j].add_product(a, other_row[j]);
 				}
 			}
+			for (size_t j = 0; j < other.num_cols; j++) {
+				out(i, j) = row_sums[j].result();
+			}
 		}
 		return out;
 	}
@@ -343,6 +371,10 @@ public:
 	}
 
 	void ero_scale(size_t row, const T& scale, size_t start_col = 0) {
+		if constexpr (kernels::Has_Kernels<T>) {
+			kernels::scale<T>(row_span(row, start_col), scale);
+			return;
+		}
 		for (size_t i = start_col; i < num_cols; i++) {
 			(*this)(row, i) *= scale;
 		}
@@ -358,6 +390,10 @@ public:
 	}
 
 	void ero_subtract_scaled_row_from_r1(size_t r1, size_t r2, const T& scale, size_t start_col = 0) {
+		if constexpr (kernels::Has_Kernels<T>) {
+			kernels::axpy<T>(row_span(r1, start_col), -scale, row_span(r2, start_col));
+			return;
+		}
 		for (size_t i = start_col; i < num_cols; i++) {
 			(*this)(r1, i) -= scale * (*this)(r2, i);
 		}
@@ -365,13 +401,15 @@ public:
 
 	Matrix<T> operator*(const T& scalar) const {
 		Matrix<T> out{*this};
-		for (auto& element : out.data) {
-			element *= scalar;
-		}
+		out *= scalar;
 		return out;
 	}
 
 	Matrix<T>& operator*=(const T& scalar) {
+		if constexpr (kernels::Has_Kernels<T>) {
+			kernels::scale<T>(data, scalar);
+			return *this;
+		}
 		for (auto& element : data) {
 			element *= scalar;
 		}
@@ -431,6 +469,10 @@ public:
 		return out;
 	}
 private:
+	std::span<T> row_span(size_t row, size_t start_col = 0) {
+		return std::span<T>{data}.subspan(row * num_cols + start_col, num_cols - start_col);
+	}
+
 	void check_addition_size(const Matrix<T>& other, const char * operation) const {
 		if (num_rows != other.num_rows || num_cols != other.num_cols) {
 			throw std::out_of_range(
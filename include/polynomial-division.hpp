@@ -0,0 +1,137 @@
+#pragma once
+#include "identities.hpp"
+#include "polynomial-multiply.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Once both the quotient and the divisor have this many coefficients,
+// reducing by a Poly_Modulus multiplies by a power series inverse (found with
+// Newton's method) instead of doing long division, which lets it use fast
+// multiplication. A one-off divmod has to find the inverse first, which
+// costs a few more products, so it waits for four times as many.
+#ifndef POLYNOMIAL_NEWTON_DIVISION_THRESHOLD
+#define POLYNOMIAL_NEWTON_DIVISION_THRESHOLD 256
+#endif
+
+namespace cherry {
+
+// Divides polynomials stored as arrays of coefficients (from lowest degree to
+// highest) over a field R. Like Polynomial_Multiplier, every zero comes from
+// c - c for some coefficient c, so R doesn't need zero<R>().
+template<typename R>
+class Polynomial_Divider {
+public:
+	// f^-1 mod x^n, for nf, n >= 1 and f[0] invertible. The first
+	// POLYNOMIAL_NEWTON_DIVISION_THRESHOLD coefficients come straight from
+	// f g = 1, and after that each step of Newton's method,
+	//
+	//     g <- g - g (f g - 1),
+	//
+	// doubles how many are right. f g - 1 is zero mod x^k, so only its
+	// next k coefficients need to be multiplied by g.
+	static std::vector<R> inverse_series(const R * f, size_t nf, size_t n) {
+		const R z = f[0] - f[0];
+		const R f0_inv = cherry::inv(f[0]);
+		size_t base = std::min<size_t>(n, POLYNOMIAL_NEWTON_DIVISION_THRESHOLD);
+		std::vector<R> g;
+		g.reserve(n);
+		g.push_back(f0_inv);
+		for (size_t k = 1; k < base; k++) {
+			Accumulator<R> sum{ z };
+			for (size_t j = 1; j <= std::min(k, nf - 1); j++) {
+				sum.add_product(f[j], g[k - j]);
+			}
+			g.push_back(-(sum.result() * f0_inv));
+		}
+		for (size_t k = base; k < n; k = g.size()) {
+			size_t next = std::min(2 * k, n);
+			std::vector<R> fg = multiply(f, std::min(nf, next), g.data(), k);
+			fg.resize(std::max(fg.size(), next), z);
+			std::vector<R> correction = multiply(g.data(), next - k, fg.data() + k, next - k);
+			for (size_t i = 0; i < next - k; i++) {
+				g.push_back(-correction[i]);
+			}
+		}
+		return g;
+	}
+
+	// q = a div b and r = a mod b for nb >= 1 with b[nb - 1] nonzero. q gets
+	// na - nb + 1 coefficients and r gets nb - 1 (or na, if that's fewer),
+	// and neither gets trimmed. a can be q or r.
+	static void divmod(const R * a, size_t na, const R * b, size_t nb, std::vector<R>& q, std::vector<R>& r) {
+		if (na < nb) {
+			r.assign(a, a + na);
+			q.clear();
+			return;
+		}
+		size_t m = na - nb + 1;
+		if (std::min(m, nb) < 4 * POLYNOMIAL_NEWTON_DIVISION_THRESHOLD) {
+			schoolbook(a, na, b, nb, cherry::inv(b[nb - 1]), q, r);
+		} else {
+			std::vector<R> reversed(b, b + nb);
+			std::reverse(reversed.begin(), reversed.end());
+			newton(a, na, b, nb, inverse_series(reversed.data(), nb, m), q, r);
+		}
+	}
+
+	// Long division, one coefficient of q at a time from the top. Each one
+	// only depends on a and the coefficients of q above it, so everything
+	// gets summed in an accumulator instead of subtracted from a copy of a.
+	static void schoolbook(const R * a, size_t na, const R * b, size_t nb, const R& lead_inv, std::vector<R>& q, std::vector<R>& r) {
+		const R z = b[0] - b[0];
+		size_t m = na - nb + 1;
+		std::vector<R> quotient(m, z);
+		for (size_t k = m - 1; k < m; k--) {
+			size_t top = k + nb - 1;
+			Accumulator<R> sum{ z };
+			for (size_t j = k + 1; j < std::min(m, top + 1); j++) {
+				sum.add_product(quotient[j], b[top - j]);
+			}
+			quotient[k] = (a[top] - sum.result()) * lead_inv;
+		}
+		std::vector<R> remainder(nb - 1, z);
+		for (size_t i = 0; i < nb - 1; i++) {
+			Accumulator<R> sum{ z };
+			for (size_t j = 0; j <= std::min(i, m - 1); j++) {
+				sum.add_product(quotient[j], b[i - j]);
+			}
+			remainder[i] = a[i] - sum.result();
+		}
+		q = std::move(quotient);
+		r = std::move(remainder);
+	}
+
+	// With rev(f) = x^deg(f) f(1 / x), rev(a) = rev(q) rev(b) mod x^m, so
+	// rev(q) is rev(a) times the inverse of rev(b) mod x^m. rev_b_inv needs
+	// at least m coefficients, but can have more.
+	static void newton(const R * a, size_t na, const R * b, size_t nb, const std::vector<R>& rev_b_inv, std::vector<R>& q, std::vector<R>& r) {
+		size_t m = na - nb + 1;
+		std::vector<R> rev_a(m, a[0]);
+		for (size_t i = 0; i < m; i++) {
+			rev_a[i] = a[na - 1 - i];
+		}
+		std::vector<R> quotient = multiply(rev_a.data(), m, rev_b_inv.data(), m);
+		quotient.resize(m, a[0]);
+		std::reverse(quotient.begin(), quotient.end());
+		std::vector<R> remainder;
+		if (nb > 1) {
+			// Only the bottom nb - 1 coefficients of q b are left over.
+			remainder = multiply(quotient.data(), std::min(m, nb - 1), b, nb - 1);
+			remainder.resize(nb - 1, a[0]);
+			for (size_t i = 0; i < nb - 1; i++) {
+				remainder[i] = a[i] - remainder[i];
+			}
+		}
+		q = std::move(quotient);
+		r = std::move(remainder);
+	}
+private:
+	static std::vector<R> multiply(const R * a, size_t na, const R * b, size_t nb) {
+		std::vector<R> out(na + nb - 1, a[0]);
+		Polynomial_Multiplier<R>::multiply(a, na, b, nb, out.data());
+		return out;
+	}
+};
+
+}
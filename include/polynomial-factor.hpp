@@ -0,0 +1,500 @@
+#pragma once
+#include "finite-field.hpp"
+#include "gf1-ntt.hpp"
+#include "identities.hpp"
+#include "polynomial-gcd.hpp"
+#include "polynomial.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Factors of the same degree over fields with at most this many elements get
+// split with Berlekamp's algorithm, which tries every element of the field
+// instead of guessing. Past that, Cantor-Zassenhaus's guesses win.
+#ifndef POLYNOMIAL_BERLEKAMP_FIELD_SIZE
+#define POLYNOMIAL_BERLEKAMP_FIELD_SIZE 32
+#endif
+
+// Moduli whose matrix for x -> x^q fits in this many bytes get it written
+// down while finding the distinct-degree factorization, which makes each qth
+// power a matrix-vector product instead of about log(q) multiplications mod
+// f. It takes deg(f)^2 elements, so the default is degree 2048 for 4-byte
+// GF1s.
+#ifndef POLYNOMIAL_FROBENIUS_MATRIX_BYTES
+#define POLYNOMIAL_FROBENIUS_MATRIX_BYTES (16 << 20)
+#endif
+
+namespace cherry {
+
+// What factoring needs to know about a finite field besides its arithmetic:
+// its characteristic, a basis over GF(p) to build elements out of, and how to
+// take pth roots. Everything takes an element of the field, since that's the
+// only way GF<p, Repr> knows which field it's in.
+template<typename R>
+struct Finite_Field_For;
+
+template<uint32_t p, template<uint32_t> typename Reduction>
+struct Finite_Field_For<GF1<p, Reduction>> {
+	using F = GF1<p, Reduction>;
+	static constexpr uint32_t characteristic = p;
+
+	static std::vector<F> basis(const F&) {
+		return { F{1} };
+	}
+
+	static F scale(const F& c, uint64_t k) {
+		return c * F{k % p};
+	}
+
+	// Every element of GF(p) is its own pth power.
+	static F pth_root(const F& c) {
+		return c;
+	}
+};
+
+template<uint32_t p, typename Repr>
+struct Finite_Field_For<GF<p, Repr>> {
+	using F = GF<p, Repr>;
+	static constexpr uint32_t characteristic = p;
+
+	// 1, x, ..., x^(n - 1) mod the irreducible polynomial.
+	static std::vector<F> basis(const F& like) {
+		Polynomial<GF1<p>> irreducible = like.get_val().get_context()->get_irreducible();
+		std::vector<F> out;
+		std::vector<GF1<p>> coeffs;
+		for (size_t i = 0; i < irreducible.degree(); i++) {
+			coeffs.assign(i + 1, GF1<p>{0});
+			coeffs.back() = 1;
+			out.emplace_back(irreducible, Polynomial<GF1<p>>{coeffs});
+		}
+		return out;
+	}
+
+	static F scale(const F& c, uint64_t k) {
+		F out{ c };
+		out *= GF1<p>{k % p};
+		return out;
+	}
+
+	// c^(1 / p) = c^(p^(n - 1)), since c^(p^n) = c.
+	static F pth_root(const F& c) {
+		size_t n = c.get_val().get_context()->degree();
+		if constexpr (requires { c.get_val().frobenius(1); }) {
+			return c.frobenius(n - 1);
+		} else {
+			F out{ c };
+			for (size_t i = 1; i < n; i++) {
+				out = out.pow_u(p);
+			}
+			return out;
+		}
+	}
+};
+
+// Factors monic polynomials over a finite field GF(q), q = p^n, into monic
+// irreducibles in three steps:
+//
+// 1.  The square-free factorization pulls out repeated factors with GCDs
+//     against the derivative.
+// 2.  The distinct-degree factorization groups what's left by the degree d of
+//     its factors, since x^(q^d) - x is the product of every monic
+//     irreducible whose degree divides d.
+// 3.  Each group gets split into its factors, with Berlekamp's algorithm for
+//     tiny fields and Cantor-Zassenhaus for everything else.
+//
+// Cantor-Zassenhaus guesses, but the guesses come from a fixed seed, so the
+// same polynomial always gets its factors in the same order.
+template<typename R>
+class Polynomial_Factorizer {
+public:
+	using Field = Finite_Field_For<R>;
+	using Factors = std::vector<std::pair<Polynomial<R>, size_t>>;
+	static constexpr uint32_t p = Field::characteristic;
+
+	// like is any element of the field, which GF<p, Repr> needs to find the
+	// field it's in.
+	explicit Polynomial_Factorizer(const R& like) :
+		basis(Field::basis(like)),
+		unit(basis[0]),
+		zero(unit - unit),
+		x(Polynomial<R>::from_coeffs({ zero, unit })),
+		one_poly(Polynomial<R>::from_coeffs({ unit }))
+	{
+		for (size_t i = 0; i < basis.size(); i++) {
+			field_size = field_size > UINT64_MAX / p ? UINT64_MAX : field_size * p;
+		}
+	}
+
+	// Every monic irreducible factor of f, with its multiplicity, from lowest
+	// degree to highest. f has to be monic.
+	Factors factor(const Polynomial<R>& f) {
+		Factors out;
+		for (const auto& [part, multiplicity] : square_free(f)) {
+			for (const auto& [group, d] : distinct_degree(part)) {
+				for (auto& irreducible : equal_degree(group, d)) {
+					out.emplace_back(std::move(irreducible), multiplicity);
+				}
+			}
+		}
+		std::stable_sort(out.begin(), out.end(), [](const auto& a, const auto& b) {
+			return a.first.degree() < b.first.degree();
+		});
+		return out;
+	}
+
+	// f = s_1 s_2^2 s_3^3 ... for monic f, with every s_i square-free and
+	// coprime to the rest. Only the s_i that aren't 1 come back. In
+	// characteristic p, f' also loses every factor whose multiplicity is a
+	// multiple of p, so whatever's left after the rest come out is a pth
+	// power, and its pth root gets the same treatment.
+	Factors square_free(const Polynomial<R>& f) const {
+		Factors out;
+		square_free(f, 1, out);
+		return out;
+	}
+
+	// For monic, square-free f, the products of all of its factors of each
+	// degree d, paired with d. Every degree costs a qth power and a GCD, so
+	// the x^(q^d) - x get multiplied together mod f about sqrt(deg(f)) at a
+	// time first, and only blocks that share a factor with f get checked one
+	// degree at a time.
+	Factors distinct_degree(const Polynomial<R>& f) const {
+		Factors out;
+		Poly_Modulus<R> modulus{ f };
+		std::vector<std::vector<R>> matrix;
+		if (f.degree() * f.degree() <= POLYNOMIAL_FROBENIUS_MATRIX_BYTES / sizeof(R)) {
+			matrix = frobenius_matrix(modulus);
+		}
+		size_t block_size = 1;
+		while (block_size * block_size < f.degree()) {
+			block_size++;
+		}
+		Polynomial<R> rest{ f };
+		Polynomial<R> power = x;
+		for (size_t d = 1; 2 * d <= rest.degree(); ) {
+			std::vector<Polynomial<R>> differences;
+			Polynomial<R> product{ one_poly };
+			for (size_t j = 0; j < block_size && 2 * (d + j) <= rest.degree(); j++) {
+				// power = x^(q^(d + j)) mod f, and rest divides f.
+				power = matrix.empty() ? frobenius(power, modulus) : apply(matrix, power);
+				differences.push_back(power - x);
+				product = modulus.mul_mod(product, differences.back());
+			}
+			Polynomial<R> block = gcd(rest, product);
+			for (size_t j = 0; j < differences.size() && block.degree() > 0; j++) {
+				Polynomial<R> group = gcd(block, differences[j]);
+				if (group.degree() > 0) {
+					block /= group;
+					rest /= group;
+					out.emplace_back(std::move(group), d + j);
+				}
+			}
+			d += differences.size();
+		}
+		if (rest.degree() > 0) {
+			size_t d = rest.degree();
+			out.emplace_back(std::move(rest), d);
+		}
+		return out;
+	}
+
+	// The factors of monic, square-free f, all of which have degree d. A
+	// constant f has none.
+	std::vector<Polynomial<R>> equal_degree(const Polynomial<R>& f, size_t d) {
+		std::vector<Polynomial<R>> out;
+		if (f.degree() == 0) {
+			return out;
+		} else if (f.degree() <= d) {
+			out.push_back(f);
+		} else if (field_size <= POLYNOMIAL_BERLEKAMP_FIELD_SIZE) {
+			berlekamp(f, out);
+		} else {
+			cantor_zassenhaus(f, d, out);
+		}
+		return out;
+	}
+
+	// Every distinct root of monic f, from the linear factors of
+	// gcd(f, x^q - x), which is 1 when f has no roots.
+	std::vector<R> roots(const Polynomial<R>& f) {
+		std::vector<R> out;
+		if (f.degree() == 0) {
+			return out;
+		}
+		Poly_Modulus<R> modulus{ f };
+		Polynomial<R> linear_part = gcd(f, frobenius(modulus.reduce(x), modulus) - x);
+		if (linear_part.degree() == 0) {
+			return out;
+		}
+		for (const auto& linear : equal_degree(linear_part, 1)) {
+			out.push_back(-linear.coeffs[0]);
+		}
+		return out;
+	}
+private:
+	void square_free(const Polynomial<R>& f, size_t multiplicity, Factors& out) const {
+		Polynomial<R> derivative = differentiate(f);
+		if (derivative.coeffs.empty()) {
+			square_free(pth_root(f), multiplicity * p, out);
+			return;
+		}
+		Polynomial<R> c = gcd(f, derivative);
+		Polynomial<R> w = f / c;
+		for (size_t i = 1; w.degree() > 0; i++) {
+			Polynomial<R> y = gcd(w, c);
+			Polynomial<R> z = w / y;
+			if (z.degree() > 0) {
+				out.emplace_back(std::move(z), i * multiplicity);
+			}
+			w = std::move(y);
+			c /= w;
+		}
+		if (c.degree() > 0) {
+			square_free(pth_root(c), multiplicity * p, out);
+		}
+	}
+
+	// Polynomial::differentiate needs a cast from an integer to R, which
+	// GF<p, Repr> doesn't have.
+	Polynomial<R> differentiate(const Polynomial<R>& f) const {
+		std::vector<R> out;
+		for (size_t i = 1; i < f.coeffs.size(); i++) {
+			out.push_back(Field::scale(f.coeffs[i], i));
+		}
+		return Polynomial<R>::from_coeffs(out);
+	}
+
+	// f(x)^(1 / p) for f with only powers of x^p, which is the sum of
+	// c_(ip)^(1 / p) x^i.
+	Polynomial<R> pth_root(const Polynomial<R>& f) const {
+		std::vector<R> out;
+		for (size_t i = 0; i < f.coeffs.size(); i += p) {
+			out.push_back(Field::pth_root(f.coeffs[i]));
+		}
+		return Polynomial<R>::from_coeffs(out);
+	}
+
+	// h^q mod the modulus, as n pth powers.
+	Polynomial<R> frobenius(Polynomial<R> h, const Poly_Modulus<R>& modulus) const {
+		for (size_t i = 0; i < basis.size(); i++) {
+			h = modulus.pow_mod(h, p);
+		}
+		return h;
+	}
+
+	// h -> h^q is linear over GF(q), since it's the identity on GF(q). Column
+	// i of this is x^(qi) mod the modulus, so h^q is this times h.
+	std::vector<std::vector<R>> frobenius_matrix(const Poly_Modulus<R>& modulus) const {
+		size_t m = modulus.degree();
+		std::vector<std::vector<R>> matrix(m, std::vector<R>(m, zero));
+		Polynomial<R> x_q = frobenius(modulus.reduce(x), modulus);
+		Polynomial<R> column = modulus.reduce(one_poly);
+		for (size_t i = 0; i < m; i++) {
+			for (size_t j = 0; j < column.coeffs.size(); j++) {
+				matrix[j][i] = column.coeffs[j];
+			}
+			column = modulus.mul_mod(column, x_q);
+		}
+		return matrix;
+	}
+
+	Polynomial<R> apply(const std::vector<std::vector<R>>& matrix, const Polynomial<R>& h) const {
+		std::vector<R> out;
+		for (const auto& row : matrix) {
+			Accumulator<R> sum{ zero };
+			for (size_t i = 0; i < h.coeffs.size(); i++) {
+				sum.add_product(row[i], h.coeffs[i]);
+			}
+			out.push_back(sum.result());
+		}
+		return Polynomial<R>::from_coeffs(out);
+	}
+
+	// Element number index of the field, with the digits of index in base p
+	// as coordinates.
+	R element(uint64_t index) const {
+		R out{ zero };
+		for (const R& b : basis) {
+			out += Field::scale(b, index % p);
+			index /= p;
+		}
+		return out;
+	}
+
+	R random_element() {
+		R out{ zero };
+		for (const R& b : basis) {
+			out += Field::scale(b, next_random(seed) % p);
+		}
+		return out;
+	}
+
+	// For odd p, g is split by a^((q^d - 1) / 2) - 1 for about half of all a,
+	// since that's zero mod each factor of g for half of the nonzero values a
+	// can take mod it. For p = 2, the trace a + a^2 + ... + a^(2^(nd - 1))
+	// does the same thing. (q^d - 1) / 2 = (p - 1) / 2 (1 + p + ... +
+	// p^(nd - 1)), so both come from the same powers a^(p^j).
+	void cantor_zassenhaus(const Polynomial<R>& g, size_t d, std::vector<Polynomial<R>>& out) {
+		if (g.degree() <= d) {
+			out.push_back(g);
+			return;
+		}
+		Poly_Modulus<R> modulus{ g };
+		while (true) {
+			std::vector<R> coeffs;
+			for (size_t i = 0; i < g.degree(); i++) {
+				coeffs.push_back(random_element());
+			}
+			Polynomial<R> power = Polynomial<R>::from_coeffs(coeffs);
+			Polynomial<R> combined{ power };
+			for (size_t j = 1; j < basis.size() * d; j++) {
+				power = modulus.pow_mod(power, p);
+				if constexpr (p == 2) {
+					combined += power;
+				} else {
+					combined = modulus.mul_mod(combined, power);
+				}
+			}
+			if constexpr (p != 2) {
+				combined = modulus.pow_mod(combined, (p - 1) / 2) - one_poly;
+			}
+			Polynomial<R> split = gcd(g, combined);
+			if (split.degree() > 0 && split.degree() < g.degree()) {
+				cantor_zassenhaus(split, d, out);
+				cantor_zassenhaus(g / split, d, out);
+				return;
+			}
+		}
+	}
+
+	// The v with v^q = v mod g form a subalgebra with one dimension per
+	// factor of g, and gcd(g, v - s) over every s in the field splits g
+	// along whichever factors v tells apart. Those v are the kernel of
+	// Q - I, with Q from frobenius_matrix.
+	void berlekamp(const Polynomial<R>& g, std::vector<Polynomial<R>>& out) const {
+		std::vector<std::vector<R>> matrix = frobenius_matrix(Poly_Modulus<R>{ g });
+		for (size_t i = 0; i < matrix.size(); i++) {
+			matrix[i][i] -= unit;
+		}
+		std::vector<std::vector<R>> kernel = null_space(matrix);
+		std::vector<Polynomial<R>> factors{ g };
+		for (const auto& v : kernel) {
+			if (factors.size() == kernel.size()) {
+				break;
+			}
+			Polynomial<R> v_poly = Polynomial<R>::from_coeffs(v);
+			std::vector<Polynomial<R>> next;
+			for (auto& rest : factors) {
+				for (uint64_t s = 0; s < field_size && rest.degree() > 0; s++) {
+					Polynomial<R> piece = gcd(rest, v_poly - Polynomial<R>::from_coeffs({ element(s) }));
+					if (piece.degree() > 0 && piece.degree() < rest.degree()) {
+						rest /= piece;
+						next.push_back(std::move(piece));
+					}
+				}
+				next.push_back(std::move(rest));
+			}
+			factors = std::move(next);
+		}
+		for (auto& factor : factors) {
+			out.push_back(std::move(factor));
+		}
+	}
+
+	// A basis for the kernel of a square matrix, from its reduced row echelon
+	// form.
+	std::vector<std::vector<R>> null_space(std::vector<std::vector<R>> matrix) const {
+		size_t m = matrix.size();
+		std::vector<size_t> pivots;
+		std::vector<bool> is_pivot(m, false);
+		for (size_t col = 0; col < m && pivots.size() < m; col++) {
+			size_t row = pivots.size();
+			size_t found = row;
+			while (found < m && matrix[found][col] == zero) {
+				found++;
+			}
+			if (found == m) {
+				continue;
+			}
+			std::swap(matrix[row], matrix[found]);
+			R pivot_inv = cherry::inv(matrix[row][col]);
+			for (R& c : matrix[row]) {
+				c *= pivot_inv;
+			}
+			for (size_t other = 0; other < m; other++) {
+				if (other == row || matrix[other][col] == zero) {
+					continue;
+				}
+				R factor = matrix[other][col];
+				for (size_t c = col; c < m; c++) {
+					matrix[other][c] -= factor * matrix[row][c];
+				}
+			}
+			pivots.push_back(col);
+			is_pivot[col] = true;
+		}
+		std::vector<std::vector<R>> out;
+		for (size_t free = 0; free < m; free++) {
+			if (is_pivot[free]) {
+				continue;
+			}
+			std::vector<R> v(m, zero);
+			v[free] = unit;
+			for (size_t row = 0; row < pivots.size(); row++) {
+				v[pivots[row]] = -matrix[row][free];
+			}
+			out.push_back(std::move(v));
+		}
+		return out;
+	}
+
+	std::vector<R> basis;
+	R unit;
+	R zero;
+	Polynomial<R> x;
+	Polynomial<R> one_poly;
+	// q, or UINT64_MAX if it doesn't fit, which doesn't matter since it only
+	// gets compared against POLYNOMIAL_BERLEKAMP_FIELD_SIZE.
+	uint64_t field_size = 1;
+	uint64_t seed = 0x9e3779b97f4a7c15;
+};
+
+// f = c f_1^e_1 f_2^e_2 ... with c the leading coefficient of f and each f_i
+// monic and irreducible. Returns the pairs (f_i, e_i), from lowest degree to
+// highest, and nothing for constants. Throws a std::domain_error for the zero
+// polynomial.
+template<typename R>
+std::vector<std::pair<Polynomial<R>, size_t>> factor(const Polynomial<R>& f) {
+	// Adding zero trims f.
+	Polynomial<R> monic = f + Polynomial<R>{};
+	const auto& coeffs = monic.get_coeffs();
+	if (coeffs.empty()) {
+		throw std::domain_error("Trying to factor the zero polynomial.");
+	}
+	if (coeffs.size() == 1) {
+		return {};
+	}
+	R lead = coeffs.back();
+	monic *= cherry::inv(lead);
+	return Polynomial_Factorizer<R>{ lead }.factor(monic);
+}
+
+// Every distinct root of f in the field its coefficients are in. Throws a
+// std::domain_error for the zero polynomial, which has all of them.
+template<typename R>
+std::vector<R> roots(const Polynomial<R>& f) {
+	// Adding zero trims f.
+	Polynomial<R> monic = f + Polynomial<R>{};
+	const auto& coeffs = monic.get_coeffs();
+	if (coeffs.empty()) {
+		throw std::domain_error("Every element is a root of the zero polynomial.");
+	}
+	R lead = coeffs.back();
+	monic *= cherry::inv(lead);
+	return Polynomial_Factorizer<R>{ lead }.roots(monic);
+}
+
+}
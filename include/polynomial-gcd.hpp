@@ -0,0 +1,267 @@
+#pragma once
+#include "identities.hpp"
+#include "polynomial.hpp"
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Polynomials with fewer than this many coefficients get their half GCD from
+// plain Euclidean steps instead of recursing.
+#ifndef POLYNOMIAL_HALF_GCD_THRESHOLD
+#define POLYNOMIAL_HALF_GCD_THRESHOLD 128
+#endif
+
+// inverse_mod only uses the half GCD for moduli of at least this degree.
+// Below that, the extended Euclidean algorithm that only keeps track of one
+// coefficient beats building whole matrices of polynomials. Over
+// GF(998244353), they break even around degree 3000.
+#ifndef POLYNOMIAL_HALF_GCD_INVERSE_THRESHOLD
+#define POLYNOMIAL_HALF_GCD_INVERSE_THRESHOLD 4096
+#endif
+
+namespace cherry {
+
+// GCDs of polynomials over a field R. Each step of the Euclidean algorithm,
+// (a, b) -> (b, a - q b), is a 2x2 matrix of polynomials, and so is any run of
+// them. The half GCD finds the matrix that takes (a, b) halfway down the
+// remainder sequence by only looking at the top halves of a and b, which
+// gets to the end in O(M(n) log n) instead of O(n^2).
+template<typename R>
+class Polynomial_GCD {
+public:
+	// m = [[m00, m01], [m10, m11]], applied to (a, b) as a column vector.
+	struct Matrix {
+		Polynomial<R> m00, m01, m10, m11;
+
+		std::pair<Polynomial<R>, Polynomial<R>> apply(const Polynomial<R>& a, const Polynomial<R>& b) const {
+			return { m00 * a + m01 * b, m10 * a + m11 * b };
+		}
+
+		// this * other, so other happens first.
+		Matrix operator*(const Matrix& other) const {
+			return {
+				m00 * other.m00 + m01 * other.m10, m00 * other.m01 + m01 * other.m11,
+				m10 * other.m00 + m11 * other.m10, m10 * other.m01 + m11 * other.m11
+			};
+		}
+
+		// One Euclidean step with quotient q after this.
+		void step(const Polynomial<R>& q) {
+			Polynomial<R> next0 = m00 - q * m10;
+			Polynomial<R> next1 = m01 - q * m11;
+			std::swap(m00, m10);
+			std::swap(m01, m11);
+			m10 = std::move(next0);
+			m11 = std::move(next1);
+		}
+	};
+
+	// Both arguments trimmed. Returns (g, 0) = m (a, b) with g the last
+	// nonzero remainder, and m too if track is set. Big steps go through the
+	// half GCD whenever b is still more than half as long as a, since
+	// otherwise one division gets rid of most of a anyway.
+	static std::pair<Polynomial<R>, Matrix> euclid(Polynomial<R> a, Polynomial<R> b, const R& unit, bool track) {
+		Matrix m = identity(unit);
+		while (!b.coeffs.empty()) {
+			size_t na = a.coeffs.size();
+			size_t nb = b.coeffs.size();
+			if (na > nb && na >= POLYNOMIAL_HALF_GCD_THRESHOLD && 2 * nb > na) {
+				Matrix h = half_gcd(a, b, unit);
+				std::tie(a, b) = h.apply(a, b);
+				if (track) {
+					m = h * m;
+				}
+			} else {
+				auto [q, r] = divmod(a, b);
+				a = std::move(b);
+				b = std::move(r);
+				if (track) {
+					m.step(q);
+				}
+			}
+		}
+		return { std::move(a), std::move(m) };
+	}
+
+	// For deg(a) > deg(b), the matrix taking (a, b) to the first pair of
+	// remainders (a', b') with deg(a') >= ceil(deg(a) / 2) > deg(b'). The
+	// quotients that get there only depend on the top halves of a and b,
+	// so the first recursive call takes (a, b) about a quarter of the way
+	// with polynomials half as long, and once a division gets past the
+	// pair it lands on, the second does the next quarter the same way.
+	static Matrix half_gcd(const Polynomial<R>& a, const Polynomial<R>& b, const R& unit) {
+		size_t half = a.coeffs.size() / 2;
+		if (b.coeffs.size() <= half) {
+			return identity(unit);
+		}
+		if (a.coeffs.size() < POLYNOMIAL_HALF_GCD_THRESHOLD) {
+			Matrix m = identity(unit);
+			Polynomial<R> x{ a };
+			Polynomial<R> y{ b };
+			while (y.coeffs.size() > half) {
+				auto [q, r] = divmod(x, y);
+				x = std::move(y);
+				y = std::move(r);
+				m.step(q);
+			}
+			return m;
+		}
+		Matrix first = half_gcd(shift_down(a, half), shift_down(b, half), unit);
+		auto [c, d] = first.apply(a, b);
+		if (d.coeffs.size() <= half) {
+			return first;
+		}
+		auto [q, r] = divmod(c, d);
+		first.step(q);
+		size_t k = 2 * half - (d.coeffs.size() - 1);
+		return half_gcd(shift_down(d, k), shift_down(r, k), unit) * first;
+	}
+
+	static Polynomial<R> gcd(const Polynomial<R>& a, const Polynomial<R>& b) {
+		Polynomial<R> x = Polynomial<R>::from_coeffs(a.to_vector());
+		Polynomial<R> y = Polynomial<R>::from_coeffs(b.to_vector());
+		if (x.coeffs.empty() && y.coeffs.empty()) {
+			return {};
+		}
+		R unit = unit_of(x, y);
+		Polynomial<R> g = euclid(std::move(x), std::move(y), unit, false).first;
+		g *= cherry::inv(g.coeffs.back());
+		return g;
+	}
+
+	static std::tuple<Polynomial<R>, Polynomial<R>, Polynomial<R>> xgcd(const Polynomial<R>& a, const Polynomial<R>& b) {
+		Polynomial<R> x = Polynomial<R>::from_coeffs(a.to_vector());
+		Polynomial<R> y = Polynomial<R>::from_coeffs(b.to_vector());
+		if (x.coeffs.empty() && y.coeffs.empty()) {
+			return {};
+		}
+		R unit = unit_of(x, y);
+		auto [g, m] = euclid(std::move(x), std::move(y), unit, true);
+		R lead_inv = cherry::inv(g.coeffs.back());
+		g *= lead_inv;
+		m.m00 *= lead_inv;
+		m.m01 *= lead_inv;
+		return { std::move(g), std::move(m.m00), std::move(m.m01) };
+	}
+
+	// a^-1 mod m by the plain extended Euclidean algorithm, one term of each
+	// quotient at a time, keeping track of only the coefficient of a. That's
+	// O(n^2), but it never builds a quotient or a matrix, so it's what field
+	// elements use.
+	static Polynomial<R> euclid_inverse_mod(const Polynomial<R>& a, const Polynomial<R>& m) {
+		size_t nm = m.trimmed_size();
+		if (nm == 0) {
+			throw std::domain_error("Trying to divide by the zero polynomial.");
+		}
+		Polynomial<R> reduced = a.trimmed_size() >= nm ? a % m : a;
+		std::vector<R> r0(m.coeffs.begin(), m.coeffs.begin() + nm);
+		std::vector<R> r1(reduced.coeffs.begin(), reduced.coeffs.begin() + reduced.trimmed_size());
+		if (r1.empty()) {
+			throw std::domain_error(
+				"Trying to take the multiplicative inverse of "
+				"the additive identity (i.e. dividing by zero)."
+			);
+		}
+		const R z = r1[0] - r1[0];
+		std::vector<R> t0;
+		std::vector<R> t1{ r1.back() * cherry::inv(r1.back()) };
+		auto trim = [](std::vector<R>& coeffs) {
+			while (!coeffs.empty() && Polynomial<R>::is_zero(coeffs.back())) {
+				coeffs.pop_back();
+			}
+		};
+		while (r1.size() > 1) {
+			// r0 = q r1 + r, t0 -= q t1, one term of q at a time.
+			R lead_inv = cherry::inv(r1.back());
+			while (r0.size() >= r1.size()) {
+				size_t shift = r0.size() - r1.size();
+				R factor = r0.back() * lead_inv;
+				for (size_t i = 0; i < r1.size(); i++) {
+					r0[shift + i] -= factor * r1[i];
+				}
+				if (t0.size() < t1.size() + shift) {
+					t0.resize(t1.size() + shift, z);
+				}
+				for (size_t i = 0; i < t1.size(); i++) {
+					t0[shift + i] -= factor * t1[i];
+				}
+				trim(r0);
+			}
+			std::swap(r0, r1);
+			std::swap(t0, t1);
+			trim(t1);
+		}
+		if (r1.empty()) {
+			throw std::domain_error(
+				"A polynomial only has an inverse mod m if it shares no factors with m."
+			);
+		}
+		// r1 is a nonzero constant, and t1 a = r1.
+		R scale = cherry::inv(r1[0]);
+		for (auto& coeff : t1) {
+			coeff *= scale;
+		}
+		return Polynomial<R>::from_coeffs(t1);
+	}
+private:
+	// One, as c c^-1 for a coefficient c of whichever of x and y isn't zero.
+	static R unit_of(const Polynomial<R>& x, const Polynomial<R>& y) {
+		const R& c = x.coeffs.empty() ? y.coeffs.back() : x.coeffs.back();
+		return c * cherry::inv(c);
+	}
+
+	static Matrix identity(const R& unit) {
+		return { Polynomial<R>::from_coeffs({ unit }), {}, {}, Polynomial<R>::from_coeffs({ unit }) };
+	}
+
+	// f div x^k
+	static Polynomial<R> shift_down(const Polynomial<R>& f, size_t k) {
+		Polynomial<R> out;
+		if (f.coeffs.size() > k) {
+			out.coeffs.assign(f.coeffs.begin() + k, f.coeffs.end());
+		}
+		return out;
+	}
+};
+
+// The monic GCD of a and b, or the zero polynomial if both are zero.
+template<typename R>
+Polynomial<R> gcd(const Polynomial<R>& a, const Polynomial<R>& b) {
+	return Polynomial_GCD<R>::gcd(a, b);
+}
+
+// (g, s, t) with g = gcd(a, b) monic and s a + t b = g. Unless a or b divides
+// the other, deg(s) < deg(b) - deg(g) and deg(t) < deg(a) - deg(g).
+template<typename R>
+std::tuple<Polynomial<R>, Polynomial<R>, Polynomial<R>> xgcd(const Polynomial<R>& a, const Polynomial<R>& b) {
+	return Polynomial_GCD<R>::xgcd(a, b);
+}
+
+// The same as inverse_mod, but always with the O(n^2) extended Euclidean
+// algorithm.
+template<typename R>
+Polynomial<R> euclid_inverse_mod(const Polynomial<R>& a, const Polynomial<R>& m) {
+	return Polynomial_GCD<R>::euclid_inverse_mod(a, m);
+}
+
+// a^-1 mod m, which only exists when gcd(a, m) = 1. Throws std::domain_error
+// otherwise, or if m is zero. Below POLYNOMIAL_HALF_GCD_INVERSE_THRESHOLD,
+// that's euclid_inverse_mod, and past it, xgcd with the half GCD.
+template<typename R>
+Polynomial<R> inverse_mod(const Polynomial<R>& a, const Polynomial<R>& m) {
+	if (m.degree() < POLYNOMIAL_HALF_GCD_INVERSE_THRESHOLD) {
+		return euclid_inverse_mod(a, m);
+	}
+	auto [g, s, t] = xgcd(a % m, m);
+	(void)t;
+	if (g.get_coeffs().size() != 1) {
+		throw std::domain_error(
+			"A polynomial only has an inverse mod m if it shares no factors with m."
+		);
+	}
+	return s % m;
+}
+
+}
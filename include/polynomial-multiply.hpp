@@ -0,0 +1,294 @@
+#pragma once
+#include "identities.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Below this many coefficients (in the shorter polynomial), products use the
+// schoolbook method. Tuned for GF1<p>, where delayed reduction makes the
+// schoolbook method hard to beat.
+#ifndef POLYNOMIAL_KARATSUBA_THRESHOLD
+#define POLYNOMIAL_KARATSUBA_THRESHOLD 32
+#endif
+
+// At or above this many coefficients, balanced products use Toom-3 instead of
+// Karatsuba, as long as 2 and 3 can be inverted.
+#ifndef POLYNOMIAL_TOOM3_THRESHOLD
+#define POLYNOMIAL_TOOM3_THRESHOLD 256
+#endif
+
+namespace cherry {
+
+template<typename T>
+class Matrix;
+
+template<typename T>
+struct Is_Matrix : std::false_type {};
+
+template<typename T>
+struct Is_Matrix<Matrix<T>> : std::true_type {};
+
+// Coefficients with a faster way to multiply big polynomials (like the NTT
+// for GF1<p>) specialize this. type::multiply has the same signature as
+// Polynomial_Multiplier<R>::multiply, but returns false when it would rather
+// leave the product to Karatsuba and Toom-3.
+template<typename R>
+struct Fast_Multiplier_For {
+	using type = void;
+};
+
+template<uint32_t p, template<uint32_t> typename Reduction>
+class GF1;
+
+template<uint32_t p, template<uint32_t> typename Reduction>
+class GF1_NTT_Multiplier;
+
+// Declared here instead of in gf1-ntt.hpp so that every Polynomial<GF1<p>>
+// multiplies the same way no matter what got included. finite-field.hpp
+// includes gf1-ntt.hpp at the end, so GF1_NTT_Multiplier is complete
+// anywhere GF1 is.
+template<uint32_t p, template<uint32_t> typename Reduction>
+struct Fast_Multiplier_For<GF1<p, Reduction>> {
+	using type = GF1_NTT_Multiplier<p, Reduction>;
+};
+
+// Multiplies polynomials stored as arrays of coefficients (from lowest degree
+// to highest), picking an algorithm by size:
+//
+// -   Schoolbook below POLYNOMIAL_KARATSUBA_THRESHOLD.
+// -   Karatsuba, which turns one product of size n into three of size n / 2.
+// -   Toom-3 at POLYNOMIAL_TOOM3_THRESHOLD and up, which turns one product of
+//     size n into five of size n / 3. It divides by 2 and 3, so it only runs
+//     when R can invert things and its characteristic isn't 2 or 3.
+//
+// If one polynomial is a lot longer than the other, the longer one gets cut
+// into pieces the size of the shorter one, and each piece is a balanced
+// product. None of this needs zero<R>() or one<R>(), since those come from
+// the coefficients themselves, so it works for anything Polynomial works
+// with, commutative or not. Coefficients that specialize Fast_Multiplier_For
+// get first pick of the whole product.
+template<typename R>
+class Polynomial_Multiplier {
+public:
+	// Matrices have inv() too, but most of them can't be inverted, so they
+	// never get Toom-3.
+	static constexpr bool has_inverses = std::is_floating_point_v<R>
+		|| (requires (const R& r) { r.inv(); } && !Is_Matrix<R>::value);
+
+	// out[0, na + nb - 1) = a b, for na and nb at least 1. out has to already
+	// hold na + nb - 1 constructed elements, but their values don't matter.
+	static void multiply(const R * a, size_t na, const R * b, size_t nb, R * out) {
+		using Fast_Multiplier = typename Fast_Multiplier_For<R>::type;
+		if constexpr (!std::is_void_v<Fast_Multiplier>) {
+			if (Fast_Multiplier::multiply(a, na, b, nb, out)) {
+				return;
+			}
+		}
+		Multiplier engine{ a[0] };
+		engine.unbalanced(a, na, b, nb, out);
+	}
+private:
+	explicit Polynomial_Multiplier(const R& sample) : z(sample - sample) {}
+
+	using Multiplier = Polynomial_Multiplier<R>;
+
+	void schoolbook(const R * a, size_t na, const R * b, size_t nb, R * out) const {
+		for (size_t k = 0; k < na + nb - 1; k++) {
+			size_t i_min = k < nb ? 0 : k - nb + 1;
+			size_t i_max = std::min(k, na - 1);
+			Accumulator<R> sum{ a[i_min] * b[k - i_min] };
+			for (size_t i = i_min + 1; i <= i_max; i++) {
+				sum.add_product(a[i], b[k - i]);
+			}
+			out[k] = sum.result();
+		}
+	}
+
+	// The operands never swap places, so the coefficients never have to
+	// commute.
+	void unbalanced(const R * a, size_t na, const R * b, size_t nb, R * out) {
+		if (std::min(na, nb) < POLYNOMIAL_KARATSUBA_THRESHOLD) {
+			schoolbook(a, na, b, nb, out);
+			return;
+		}
+		if (na == nb) {
+			balanced(a, b, na, out);
+			return;
+		}
+		// The longer one in pieces the size of the shorter one, with the
+		// last piece possibly shorter.
+		size_t n = std::min(na, nb);
+		size_t total = std::max(na, nb);
+		std::fill(out, out + na + nb - 1, z);
+		std::vector<R> piece(2 * n - 1, z);
+		for (size_t start = 0; start < total; start += n) {
+			size_t len = std::min(n, total - start);
+			if (na > nb) {
+				unbalanced(a + start, len, b, nb, piece.data());
+			} else {
+				unbalanced(a, na, b + start, len, piece.data());
+			}
+			for (size_t i = 0; i < len + n - 1; i++) {
+				out[start + i] += piece[i];
+			}
+		}
+	}
+
+	// out[0, 2n - 1) = a b, where both have n coefficients.
+	void balanced(const R * a, const R * b, size_t n, R * out) {
+		if (n < POLYNOMIAL_KARATSUBA_THRESHOLD) {
+			schoolbook(a, n, b, n, out);
+		} else if (n >= POLYNOMIAL_TOOM3_THRESHOLD && can_toom3(a, b, n)) {
+			toom3(a, b, n, out);
+		} else {
+			karatsuba(a, b, n, out);
+		}
+	}
+
+	// With a = a_0 + a_1 x^m and the same for b,
+	//
+	//     a b = a_0 b_0 + ((a_0 + a_1)(b_0 + b_1) - a_0 b_0 - a_1 b_1) x^m + a_1 b_1 x^2m.
+	void karatsuba(const R * a, const R * b, size_t n, R * out) {
+		size_t m = (n + 1) / 2;
+		size_t h = n - m;
+		balanced(a, b, m, out);
+		balanced(a + m, b + m, h, out + 2 * m);
+		// out[2m - 1] sits between the two products.
+		out[2 * m - 1] = z;
+		std::vector<R> sums(2 * m, z);
+		R * a_sum = sums.data();
+		R * b_sum = sums.data() + m;
+		for (size_t i = 0; i < m; i++) {
+			a_sum[i] = a[i];
+			b_sum[i] = b[i];
+		}
+		for (size_t i = 0; i < h; i++) {
+			a_sum[i] += a[m + i];
+			b_sum[i] += b[m + i];
+		}
+		std::vector<R> middle(2 * m - 1, z);
+		balanced(a_sum, b_sum, m, middle.data());
+		for (size_t i = 0; i < 2 * m - 1; i++) {
+			middle[i] -= out[i];
+		}
+		for (size_t i = 0; i + 1 < 2 * h; i++) {
+			middle[i] -= out[2 * m + i];
+		}
+		for (size_t i = 0; i < 2 * m - 1; i++) {
+			out[m + i] += middle[i];
+		}
+	}
+
+	// Toom-3 needs 1/2 and 1/3, which come from one = c / c for any nonzero
+	// coefficient c.
+	bool can_toom3(const R * a, const R * b, size_t n) {
+		if constexpr (!has_inverses) {
+			(void)a;
+			(void)b;
+			(void)n;
+			return false;
+		} else {
+			if (toom3_checked) {
+				return toom3_ok;
+			}
+			toom3_checked = true;
+			const R * nonzero = nullptr;
+			for (size_t i = 0; i < n && nonzero == nullptr; i++) {
+				if (!(a[i] == z)) {
+					nonzero = a + i;
+				} else if (!(b[i] == z)) {
+					nonzero = b + i;
+				}
+			}
+			if (nonzero == nullptr) {
+				return false;
+			}
+			R one_v = (*nonzero) * cherry::inv(*nonzero);
+			R two = one_v + one_v;
+			R three = two + one_v;
+			if (two == z || three == z) {
+				return false;
+			}
+			inv_two.push_back(cherry::inv(two));
+			inv_three.push_back(cherry::inv(three));
+			toom3_ok = true;
+			return true;
+		}
+	}
+
+	// Evaluates at 0, 1, -1, -2 and infinity, multiplies pointwise, and
+	// interpolates with Bodrato's sequence, which only divides by 2 and 3.
+	void toom3(const R * a, const R * b, size_t n, R * out) {
+		size_t k = (n + 2) / 3;
+		size_t top = n - 2 * k;
+		std::vector<R> evals(8 * k, z);
+		auto evaluate = [&](const R * c, R * at_one, R * at_minus_one, R * at_minus_two, R * at_infinity) {
+			for (size_t i = 0; i < k; i++) {
+				const R& c0 = c[i];
+				const R& c1 = c[k + i];
+				R c2 = i < top ? c[2 * k + i] : z;
+				R even = c0 + c2;
+				at_one[i] = even + c1;
+				at_minus_one[i] = even - c1;
+				R twice = c1 - c2 - c2;
+				at_minus_two[i] = c0 - twice - twice;
+				at_infinity[i] = c2;
+			}
+		};
+		R * a_evals = evals.data();
+		R * b_evals = evals.data() + 4 * k;
+		evaluate(a, a_evals, a_evals + k, a_evals + 2 * k, a_evals + 3 * k);
+		evaluate(b, b_evals, b_evals + k, b_evals + 2 * k, b_evals + 3 * k);
+
+		size_t len = 2 * k - 1;
+		std::vector<R> products(4 * len, z);
+		R * r1 = products.data();
+		R * r_minus_one = products.data() + len;
+		R * r_minus_two = products.data() + 2 * len;
+		R * r_infinity = products.data() + 3 * len;
+		balanced(a_evals, b_evals, k, r1);
+		balanced(a_evals + k, b_evals + k, k, r_minus_one);
+		balanced(a_evals + 2 * k, b_evals + 2 * k, k, r_minus_two);
+		if (top > 0) {
+			balanced(a_evals + 3 * k, b_evals + 3 * k, k, r_infinity);
+		}
+		// r0 goes straight into out, and everything past it starts at zero.
+		balanced(a, b, k, out);
+		std::fill(out + len, out + 2 * n - 1, z);
+
+		const R& half = inv_two[0];
+		const R& third = inv_three[0];
+		for (size_t i = 0; i < len; i++) {
+			const R& r0 = out[i];
+			R r3 = (r_minus_two[i] - r1[i]) * third;
+			R r1_i = (r1[i] - r_minus_one[i]) * half;
+			R r2 = r_minus_one[i] - r0;
+			r3 = (r2 - r3) * half + r_infinity[i] + r_infinity[i];
+			r2 += r1_i - r_infinity[i];
+			r1_i -= r3;
+			r1[i] = r1_i;
+			r_minus_one[i] = r2;
+			r_minus_two[i] = r3;
+		}
+		// The coefficients of X^1, ..., X^4 for X = x^k, which overlap.
+		const R * parts[4] = { r1, r_minus_one, r_minus_two, r_infinity };
+		for (size_t j = 0; j < 4; j++) {
+			size_t shift = (j + 1) * k;
+			for (size_t i = 0; i < len && shift + i < 2 * n - 1; i++) {
+				out[shift + i] += parts[j][i];
+			}
+		}
+	}
+
+	R z;
+	bool toom3_checked = false;
+	bool toom3_ok = false;
+	// At most one element each. R doesn't have to be default constructible,
+	// so these can't just be members.
+	std::vector<R> inv_two;
+	std::vector<R> inv_three;
+};
+
+}
@@ -1,75 +1,136 @@
 #pragma once
 #include "ring.hpp"
 #include "identities.hpp"
+#include "polynomial-division.hpp"
+#include "polynomial-multiply.hpp"
+#include "small-vector.hpp"
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
+// Polynomials keep up to this many bytes of coefficients inside the object
+// itself, so low-degree ones (like most irreducible polynomials) never touch
+// the heap.
+#ifndef POLYNOMIAL_INLINE_BYTES
+#define POLYNOMIAL_INLINE_BYTES 64
+#endif
+
 namespace cherry {
 
 class Polynomial_Base {};
 
+template<typename R>
+class Polynomial;
+
+template<typename R>
+void multiply_into(Polynomial<R>& out, const Polynomial<R>& a, const Polynomial<R>& b);
+
+template<typename R>
+std::pair<Polynomial<R>, Polynomial<R>> divmod(const Polynomial<R>& a, const Polynomial<R>& b);
+
+template<typename R>
+Polynomial<R> inverse_series(const Polynomial<R>& f, size_t n);
+
+template<typename R>
+class Poly_Modulus;
+
+template<typename R>
+class Polynomial_GCD;
+
+template<typename R>
+class Polynomial_Factorizer;
+
 template<typename R>
 class Polynomial : public Polynomial_Base {
 public:
+	static constexpr size_t inline_coeffs = std::max<size_t>(1, POLYNOMIAL_INLINE_BYTES / sizeof(R));
+	using Coeffs = Small_Vector<R, inline_coeffs>;
+
 	Polynomial() {}
 	Polynomial(const std::vector<R>& c) : coeffs(c) {}
 
 	Polynomial<R> operator-() const {
-		std::vector<R> new_coeffs;
-		new_coeffs.reserve(coeffs.size());
-		for (const R& coeff : coeffs) {
-			new_coeffs.push_back(-coeff);
+		Polynomial<R> out{ *this };
+		for (R& coeff : out.coeffs) {
+			coeff = -coeff;
 		}
-		return Polynomial<R>{new_coeffs};
+		return out;
 	}
 
 	Polynomial<R> operator+(const Polynomial<R>& other) const {
-		R z = zero<R>();
-		size_t len = std::max(coeffs.size(), other.coeffs.size());
-		std::vector<R> new_coeffs;
-		new_coeffs.reserve(len);
-		for (size_t i = 0; i < len; i++) {
-			new_coeffs.push_back((*this)[i] + other[i]);
-		}
-		while (!new_coeffs.empty() && new_coeffs.back() == z) {
-			new_coeffs.pop_back();
-		}
-		return Polynomial<R>{new_coeffs};
+		Polynomial<R> out{ *this };
+		out += other;
+		return out;
 	}
 
 	Polynomial<R> operator-(const Polynomial<R>& other) const {
-		static const R z = zero<R>();
-		size_t len = std::max(coeffs.size(), other.coeffs.size());
-		std::vector<R> new_coeffs;
-		new_coeffs.reserve(len);
-		for (size_t i = 0; i < len; i++) {
-			new_coeffs.push_back((*this)[i] - other[i]);
+		Polynomial<R> out{ *this };
+		out -= other;
+		return out;
+	}
+
+	// Coefficients past the end of this just get copied over, so this never
+	// needs zero<R>().
+	Polynomial<R>& operator+=(const Polynomial<R>& other) {
+		size_t shared = std::min(coeffs.size(), other.coeffs.size());
+		R * dst = coeffs.data();
+		const R * src = other.coeffs.data();
+		for (size_t i = 0; i < shared; i++) {
+			dst[i] += src[i];
 		}
-		while (!new_coeffs.empty() && new_coeffs.back() == z) {
-			new_coeffs.pop_back();
+		for (size_t i = shared; i < other.coeffs.size(); i++) {
+			coeffs.push_back(other.coeffs[i]);
 		}
-		return Polynomial<R>{new_coeffs};
+		trim();
+		return *this;
 	}
 
-	Polynomial<R> operator*(const Polynomial<R>& other) const {
-		static const R z = zero<R>();
-		std::vector<R> new_coeffs;
-		new_coeffs.reserve(coeffs.size() + other.coeffs.size());
-		for (size_t i = 0; i < coeffs.size() + other.coeffs.size(); i++) {
-			new_coeffs.emplace_back(z);
-		}
-		for (size_t i = 0; i < coeffs.size(); i++) {
-			const R& v_this = coeffs.at(i);
-			for (size_t j = 0; j < other.coeffs.size(); j++) {
-				const R& v_other = other.coeffs.at(j);
-				new_coeffs.at(i + j) += v_this * v_other;
-			}
+	Polynomial<R>& operator-=(const Polynomial<R>& other) {
+		size_t shared = std::min(coeffs.size(), other.coeffs.size());
+		R * dst = coeffs.data();
+		const R * src = other.coeffs.data();
+		for (size_t i = 0; i < shared; i++) {
+			dst[i] -= src[i];
 		}
-		while (!new_coeffs.empty() && new_coeffs.back() == z) {
-			new_coeffs.pop_back();
+		for (size_t i = shared; i < other.coeffs.size(); i++) {
+			coeffs.push_back(-other.coeffs[i]);
 		}
-		return new_coeffs;
+		trim();
+		return *this;
+	}
+
+	Polynomial<R> operator*(const Polynomial<R>& other) const {
+		Polynomial<R> out;
+		multiply_into(out, *this, other);
+		return out;
+	}
+
+	Polynomial<R>& operator*=(const Polynomial<R>& other) {
+		multiply_into(*this, *this, other);
+		return *this;
+	}
+
+	// These need R to be a field. Dividing by the zero polynomial throws a
+	// std::domain_error.
+	Polynomial<R> operator/(const Polynomial<R>& other) const {
+		return divmod(*this, other).first;
+	}
+
+	Polynomial<R> operator%(const Polynomial<R>& other) const {
+		return divmod(*this, other).second;
+	}
+
+	Polynomial<R>& operator/=(const Polynomial<R>& other) {
+		*this = divmod(*this, other).first;
+		return *this;
+	}
+
+	Polynomial<R>& operator%=(const Polynomial<R>& other) {
+		*this = divmod(*this, other).second;
+		return *this;
 	}
 
 	Polynomial<R>& operator*=(const R& other) {
@@ -91,6 +152,17 @@ public:
 		}
 	}
 
+	// All of the coefficients, from lowest degree to highest. Unlike
+	// operator[], this never has to come up with a zero, which some
+	// coefficient types can't do on their own.
+	const Coeffs& get_coeffs() const {
+		return coeffs;
+	}
+
+	std::vector<R> to_vector() const {
+		return { coeffs.begin(), coeffs.end() };
+	}
+
 	size_t degree() const {
 		if (coeffs.size() == 0) {
 			return 0;
@@ -114,6 +186,7 @@ public:
 	void to_derivative() {
 		if (degree() == 0) {
 			coeffs.clear();
+			return;
 		}
 		for (size_t i = 1; i < coeffs.size(); i++) {
 			coeffs[i - 1] = static_cast<R>(i) * coeffs[i];
@@ -124,6 +197,7 @@ public:
 	void to_derivative(size_t n) {
 		if (n > degree()) {
 			coeffs.clear();
+			return;
 		}
 		for (size_t i = n; i < coeffs.size(); i++) {
 			size_t multiple = 1;
@@ -139,7 +213,7 @@ public:
 		Polynomial<R> out;
 		out.coeffs.reserve(coeffs.size());
 		for (size_t i = 1; i < coeffs.size(); i++) {
-			out.push_back(static_cast<R>(i) * coeffs[i]);
+			out.coeffs.push_back(static_cast<R>(i) * coeffs[i]);
 		}
 		return out;
 	}
@@ -178,7 +252,209 @@ public:
 		return {{ one<R>(other_data) }};
 	}
 private:
-	std::vector<R> coeffs;
+	friend void multiply_into<R>(Polynomial<R>& out, const Polynomial<R>& a, const Polynomial<R>& b);
+	friend std::pair<Polynomial<R>, Polynomial<R>> divmod<R>(const Polynomial<R>& a, const Polynomial<R>& b);
+	friend Polynomial<R> inverse_series<R>(const Polynomial<R>& f, size_t n);
+	friend class Poly_Modulus<R>;
+	friend class Polynomial_GCD<R>;
+	friend class Polynomial_Factorizer<R>;
+
+	static Polynomial<R> from_coeffs(const std::vector<R>& values) {
+		Polynomial<R> out;
+		out.coeffs.assign(values.begin(), values.end());
+		out.trim();
+		return out;
+	}
+
+	// How many coefficients are left without the zeros on top.
+	size_t trimmed_size() const {
+		size_t size = coeffs.size();
+		while (size > 0 && is_zero(coeffs[size - 1])) {
+			size--;
+		}
+		return size;
+	}
+
+	// c - c is zero for any c, so this works for coefficients that can't
+	// make a zero on their own.
+	static bool is_zero(const R& c) {
+		return c == c - c;
+	}
+
+	void trim() {
+		while (!coeffs.empty() && is_zero(coeffs.back())) {
+			coeffs.pop_back();
+		}
+	}
+
+	Coeffs coeffs;
+};
+
+// out = a b, reusing whatever storage out already has, so multiplying in a
+// loop doesn't allocate once out is big enough. Polynomial_Multiplier picks
+// the algorithm. out can be a or b.
+template<typename R>
+void multiply_into(Polynomial<R>& out, const Polynomial<R>& a, const Polynomial<R>& b) {
+	if (&out == &a || &out == &b) {
+		Polynomial<R> product;
+		multiply_into(product, a, b);
+		out = std::move(product);
+		return;
+	}
+	size_t a_size = a.coeffs.size();
+	size_t b_size = b.coeffs.size();
+	out.coeffs.clear();
+	if (a_size == 0 || b_size == 0) {
+		return;
+	}
+	const R& first = a.coeffs[0];
+	out.coeffs.resize(a_size + b_size - 1, first - first);
+	Polynomial_Multiplier<R>::multiply(a.coeffs.data(), a_size, b.coeffs.data(), b_size, out.coeffs.data());
+	out.trim();
+}
+
+// q and r with a = q b + r and deg(r) < deg(b). Polynomial_Divider picks
+// between long division and Newton's method.
+template<typename R>
+std::pair<Polynomial<R>, Polynomial<R>> divmod(const Polynomial<R>& a, const Polynomial<R>& b) {
+	size_t nb = b.trimmed_size();
+	if (nb == 0) {
+		throw std::domain_error("Trying to divide by the zero polynomial.");
+	}
+	size_t na = a.trimmed_size();
+	if (na == 0) {
+		return {};
+	}
+	std::vector<R> q, r;
+	Polynomial_Divider<R>::divmod(a.coeffs.data(), na, b.coeffs.data(), nb, q, r);
+	return { Polynomial<R>::from_coeffs(q), Polynomial<R>::from_coeffs(r) };
+}
+
+// f^-1 mod x^n, which needs the constant term of f to be invertible.
+template<typename R>
+Polynomial<R> inverse_series(const Polynomial<R>& f, size_t n) {
+	if (f.coeffs.empty() || Polynomial<R>::is_zero(f.coeffs[0])) {
+		throw std::domain_error(
+			"A power series only has an inverse if its constant term does."
+		);
+	}
+	if (n == 0) {
+		return {};
+	}
+	return Polynomial<R>::from_coeffs(
+		Polynomial_Divider<R>::inverse_series(f.coeffs.data(), f.coeffs.size(), n)
+	);
+}
+
+// Everything reducing by a fixed polynomial needs that doesn't depend on what
+// gets reduced: the inverse of its top coefficient and, once it's big enough
+// for Newton's method, the inverse of its reversal as a power series. Reducing
+// by the same polynomial over and over (like working mod an irreducible
+// polynomial) only pays for those once.
+//
+// reduce takes anything. Inputs with more than 2 deg(m) - 1 coefficients get
+// reduced deg(m) coefficients at a time from the top, so the precomputed
+// inverse never has to get any longer.
+template<typename R>
+class Poly_Modulus {
+public:
+	explicit Poly_Modulus(const Polynomial<R>& modulus_poly) :
+		modulus(Polynomial<R>::from_coeffs(modulus_poly.to_vector()))
+	{
+		const auto& m = modulus.coeffs;
+		if (m.empty()) {
+			throw std::domain_error("Trying to divide by the zero polynomial.");
+		}
+		lead_inv.push_back(cherry::inv(m.back()));
+		size_t chunk = m.size() - 1;
+		if (chunk >= POLYNOMIAL_NEWTON_DIVISION_THRESHOLD) {
+			std::vector<R> reversed(m.begin(), m.end());
+			std::reverse(reversed.begin(), reversed.end());
+			rev_inv = Polynomial_Divider<R>::inverse_series(reversed.data(), reversed.size(), chunk);
+		}
+	}
+
+	const Polynomial<R>& get_modulus() const {
+		return modulus;
+	}
+
+	size_t degree() const {
+		return modulus.degree();
+	}
+
+	std::pair<Polynomial<R>, Polynomial<R>> divmod(const Polynomial<R>& a) const {
+		size_t na = a.trimmed_size();
+		if (na == 0) {
+			return {};
+		}
+		std::vector<R> q, r;
+		divide(a.coeffs.data(), na, q, r);
+		return { Polynomial<R>::from_coeffs(q), Polynomial<R>::from_coeffs(r) };
+	}
+
+	Polynomial<R> reduce(const Polynomial<R>& a) const {
+		size_t nb = modulus.coeffs.size();
+		std::vector<R> r(a.coeffs.begin(), a.coeffs.begin() + a.trimmed_size());
+		std::vector<R> q, top_r;
+		while (r.size() >= nb) {
+			size_t top = std::min(r.size(), nb - 1 + max_quotient());
+			size_t start = r.size() - top;
+			divide(r.data() + start, top, q, top_r);
+			r.erase(r.begin() + start, r.end());
+			r.insert(r.end(), top_r.begin(), top_r.end());
+		}
+		return Polynomial<R>::from_coeffs(r);
+	}
+
+	Polynomial<R> mul_mod(const Polynomial<R>& a, const Polynomial<R>& b) const {
+		return reduce(a * b);
+	}
+
+	// base^pow mod the modulus, by squaring and multiplying.
+	Polynomial<R> pow_mod(const Polynomial<R>& base, uint64_t pow) const {
+		const R& lead = modulus.coeffs.back();
+		Polynomial<R> out = reduce(Polynomial<R>{{ lead * lead_inv[0] }});
+		Polynomial<R> power = reduce(base);
+		while (pow > 0) {
+			if (pow & 1) {
+				out = mul_mod(out, power);
+			}
+			pow >>= 1;
+			if (pow > 0) {
+				power = mul_mod(power, power);
+			}
+		}
+		return out;
+	}
+private:
+	// The longest quotient one call to divide can handle with rev_inv, or no
+	// limit at all for long division.
+	size_t max_quotient() const {
+		return rev_inv.empty() ? SIZE_MAX / 2 : rev_inv.size();
+	}
+
+	void divide(const R * a, size_t na, std::vector<R>& q, std::vector<R>& r) const {
+		const auto& m = modulus.coeffs;
+		size_t nb = m.size();
+		if (na < nb) {
+			r.assign(a, a + na);
+			q.clear();
+			return;
+		}
+		size_t quotient_size = na - nb + 1;
+		if (rev_inv.empty() || quotient_size < POLYNOMIAL_NEWTON_DIVISION_THRESHOLD) {
+			Polynomial_Divider<R>::schoolbook(a, na, m.data(), nb, lead_inv[0], q, r);
+		} else if (quotient_size <= rev_inv.size()) {
+			Polynomial_Divider<R>::newton(a, na, m.data(), nb, rev_inv, q, r);
+		} else {
+			Polynomial_Divider<R>::divmod(a, na, m.data(), nb, q, r);
+		}
+	}
+
+	Polynomial<R> modulus;
+	// At most one element. R doesn't have to be default constructible.
+	std::vector<R> lead_inv;
+	std::vector<R> rev_inv;
 };
 
 template<typename T>
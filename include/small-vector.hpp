@@ -0,0 +1,273 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace cherry {
+
+// A vector that keeps its first N elements inside the object itself and only
+// goes to the heap once it grows past that. T doesn't have to be default
+// constructible, since elements only get constructed when they're added.
+// Only the parts of std::vector that Polynomial needs are here.
+template<typename T, size_t N>
+class Small_Vector {
+	static_assert(N > 0, "Small_Vector needs room for at least one element.");
+public:
+	using value_type = T;
+	using iterator = T *;
+	using const_iterator = const T *;
+
+	Small_Vector() {}
+
+	Small_Vector(size_t count, const T& value) {
+		resize(count, value);
+	}
+
+	Small_Vector(std::initializer_list<T> values) {
+		assign(values.begin(), values.end());
+	}
+
+	explicit Small_Vector(const std::vector<T>& values) {
+		assign(values.begin(), values.end());
+	}
+
+	Small_Vector(const Small_Vector& other) {
+		assign(other.begin(), other.end());
+	}
+
+	Small_Vector(Small_Vector&& other) noexcept {
+		take(std::move(other));
+	}
+
+	Small_Vector& operator=(const Small_Vector& other) {
+		if (this != &other) {
+			assign(other.begin(), other.end());
+		}
+		return *this;
+	}
+
+	Small_Vector& operator=(Small_Vector&& other) noexcept {
+		if (this != &other) {
+			clear();
+			release();
+			take(std::move(other));
+		}
+		return *this;
+	}
+
+	~Small_Vector() {
+		clear();
+		release();
+	}
+
+	// Replaces the contents while keeping whatever storage is already there.
+	template<typename It>
+	void assign(It first, It last) {
+		clear();
+		reserve(static_cast<size_t>(std::distance(first, last)));
+		for (; first != last; ++first) {
+			new (elements + count) T(*first);
+			count++;
+		}
+	}
+
+	size_t size() const {
+		return count;
+	}
+
+	size_t capacity() const {
+		return space;
+	}
+
+	bool empty() const {
+		return count == 0;
+	}
+
+	bool is_inline() const {
+		return elements == inline_elements();
+	}
+
+	T * data() {
+		return elements;
+	}
+
+	const T * data() const {
+		return elements;
+	}
+
+	T * begin() {
+		return elements;
+	}
+
+	const T * begin() const {
+		return elements;
+	}
+
+	T * end() {
+		return elements + count;
+	}
+
+	const T * end() const {
+		return elements + count;
+	}
+
+	T& operator[](size_t i) {
+		return elements[i];
+	}
+
+	const T& operator[](size_t i) const {
+		return elements[i];
+	}
+
+	T& at(size_t i) {
+		if (i >= count) {
+			throw std::out_of_range("Small_Vector index out of range.");
+		}
+		return elements[i];
+	}
+
+	const T& at(size_t i) const {
+		if (i >= count) {
+			throw std::out_of_range("Small_Vector index out of range.");
+		}
+		return elements[i];
+	}
+
+	T& back() {
+		return elements[count - 1];
+	}
+
+	const T& back() const {
+		return elements[count - 1];
+	}
+
+	void push_back(const T& value) {
+		emplace_back(value);
+	}
+
+	void push_back(T&& value) {
+		emplace_back(std::move(value));
+	}
+
+	template<typename... Args>
+	T& emplace_back(Args&&... args) {
+		if (count == space) {
+			// value might live in this vector, so it gets built before the
+			// old storage goes away.
+			T value(std::forward<Args>(args)...);
+			grow(std::max<size_t>(2 * space, count + 1));
+			new (elements + count) T(std::move(value));
+		} else {
+			new (elements + count) T(std::forward<Args>(args)...);
+		}
+		return elements[count++];
+	}
+
+	void pop_back() {
+		elements[--count].~T();
+	}
+
+	void clear() {
+		std::destroy(elements, elements + count);
+		count = 0;
+	}
+
+	void reserve(size_t new_space) {
+		if (new_space > space) {
+			grow(new_space);
+		}
+	}
+
+	void resize(size_t new_count, const T& value) {
+		if (new_count < count) {
+			std::destroy(elements + new_count, elements + count);
+			count = new_count;
+			return;
+		}
+		if (new_count > space) {
+			T copy{ value };
+			grow(std::max(new_count, 2 * space));
+			for (; count < new_count; count++) {
+				new (elements + count) T(copy);
+			}
+			return;
+		}
+		for (; count < new_count; count++) {
+			new (elements + count) T(value);
+		}
+	}
+
+	// Shrinking works for any T, but growing needs a default.
+	void resize(size_t new_count) {
+		if (new_count <= count) {
+			std::destroy(elements + new_count, elements + count);
+			count = new_count;
+		} else {
+			resize(new_count, T{});
+		}
+	}
+
+	void swap(Small_Vector& other) noexcept {
+		Small_Vector temp{ std::move(other) };
+		other = std::move(*this);
+		*this = std::move(temp);
+	}
+
+	bool operator==(const Small_Vector& other) const {
+		return std::equal(begin(), end(), other.begin(), other.end());
+	}
+private:
+	T * inline_elements() {
+		return reinterpret_cast<T *>(buffer);
+	}
+
+	const T * inline_elements() const {
+		return reinterpret_cast<const T *>(buffer);
+	}
+
+	void grow(size_t new_space) {
+		T * bigger = std::allocator<T>{}.allocate(new_space);
+		std::uninitialized_move(elements, elements + count, bigger);
+		std::destroy(elements, elements + count);
+		release();
+		elements = bigger;
+		space = new_space;
+	}
+
+	// Gives back heap storage (if any) without touching the elements.
+	void release() {
+		if (!is_inline()) {
+			std::allocator<T>{}.deallocate(elements, space);
+			elements = inline_elements();
+			space = N;
+		}
+	}
+
+	void take(Small_Vector&& other) {
+		if (other.is_inline()) {
+			std::uninitialized_move(other.begin(), other.end(), elements);
+			count = other.count;
+			other.clear();
+		} else {
+			elements = other.elements;
+			space = other.space;
+			count = other.count;
+			other.elements = other.inline_elements();
+			other.space = N;
+			other.count = 0;
+		}
+	}
+
+	alignas(T) unsigned char buffer[N * sizeof(T)];
+	T * elements = inline_elements();
+	size_t count = 0;
+	size_t space = N;
+};
+
+}
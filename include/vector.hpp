@@ -139,11 +139,11 @@ Vector<N, T>& Vector<N, T>::operator/=(const T& s) {
 
 template <size_t N, typename T>
 T Vector<N, T>::operator*(const Vector<N, T>& v) const {
-	T out = zero<T>();
+	Accumulator<T> out{zero<T>()};
 	for (size_t i = 0; i < N; i++) {
-		out += x[i] * v[i];
+		out.add_product(x[i], v[i]);
 	}
-	return out;
+	return out.result();
 }
 
 template <size_t N, typename T>
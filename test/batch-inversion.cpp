@@ -0,0 +1,92 @@
+#include "../include/gf.hpp"
+#include "set-coeffs.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <vector>
+
+using namespace cherry;
+
+template<typename T>
+bool all_inverses_match(const std::vector<T>& values, const std::vector<T>& inverses, const T& one_v) {
+	for (size_t i = 0; i < values.size(); i++) {
+		if (!(values[i] * inverses[i] == one_v) || !(inverses[i] * values[i] == one_v)) {
+			std::cerr << "Element " << i << " doesn't match its inverse.\n";
+			return false;
+		}
+	}
+	return true;
+}
+
+template<typename T>
+void test_batch_inv(const std::vector<T>& values, const T& one_v, const char * test_name) {
+	std::vector<T> out_of_place{values};
+	batch_inv(std::span<const T>{values}, std::span<T>{out_of_place});
+	std::vector<T> in_place{values};
+	batch_inv(std::span<T>{in_place});
+	std::cout << test_name;
+	if (all_inverses_match(values, out_of_place, one_v) && all_inverses_match(values, in_place, one_v)) {
+		std::cout << " succeeded!\n";
+	} else {
+		std::cout << " failed!\n";
+	}
+}
+
+void test_gf1() {
+	std::vector<GF1<5>> small;
+	for (uint64_t i = 1; i < 5; i++) {
+		small.push_back(i);
+	}
+	test_batch_inv(small, GF1<5>{1}, "batch_inv on GF(5)");
+	std::vector<GF1<4294967291, Montgomery_Reduction>> large;
+	for (uint64_t i = 1; i < 10000; i++) {
+		large.push_back(i * 2654435761u);
+	}
+	test_batch_inv(large, GF1<4294967291, Montgomery_Reduction>{1}, "batch_inv on GF(4294967291)");
+}
+
+void test_gf() {
+	Polynomial<GF1<5>> irreducible_poly{{1, 4, 3, 1}};
+	std::vector<GF1<5>> coeffs;
+	std::vector<GF<5>> values;
+	for (uint64_t i = 1; i < 125; i++) {
+		set_coeffs(i, coeffs);
+		values.emplace_back(irreducible_poly, coeffs);
+	}
+	test_batch_inv(values, one<GF<5>>(&irreducible_poly), "batch_inv on GF(5^3)");
+}
+
+void test_matrix() {
+	std::vector<Matrix<GF1<5>>> values;
+	Matrix<GF1<5>> identity{GF1<5>{0}, 4};
+	identity.to_identity();
+	for (size_t i = 0; i < 4; i++) {
+		Matrix<GF1<5>> m{GF1<5>{0}, 4};
+		m.to_nilpotent_diag(1, GF1<5>{i + 1});
+		m += identity * GF1<5>{i + 1};
+		values.push_back(m);
+	}
+	test_batch_inv(values, identity, "batch_inv on 4x4 matrices over GF(5)");
+}
+
+void test_zero_throws() {
+	std::vector<GF1<5>> values{1, 2, 0, 3};
+	std::cout << "batch_inv with a zero element";
+	try {
+		batch_inv(std::span<GF1<5>>{values});
+		std::cout << " failed to throw!\n";
+	} catch (const std::domain_error&) {
+		std::cout << " succeeded!\n";
+	}
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_gf1();
+	test_gf();
+	test_matrix();
+	test_zero_throws();
+	return 0;
+}
@@ -0,0 +1,109 @@
+#include "../include/gf.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace cherry;
+
+struct GF_125 {};
+struct GF_25 {};
+struct GF_3_40 {};
+
+template<typename A, typename B>
+concept Mixable = requires(A a, B b) {
+	a + b;
+	a * b;
+};
+
+// Mixing tagged fields shouldn't even compile.
+static_assert(!Mixable<GF_Mat<5, GF_125>, GF_Mat<5, GF_25>>);
+static_assert(!Mixable<GF_Poly<5, GF_125>, GF_Poly<5, GF_25>>);
+static_assert(!Mixable<GF_Packed<5, 3, GF_125>, GF_Packed<5, 3, GF_25>>);
+static_assert(!Mixable<GF_Mat<5, GF_125>, GF_Mat<5>>);
+static_assert(Mixable<GF_Mat<5, GF_125>, GF_Mat<5, GF_125>>);
+
+template<typename Repr>
+void test_different_fields(const char * name) {
+	Polynomial<GF1<5>> cubic{{1, 4, 3, 1}};
+	Polynomial<GF1<5>> quadratic{{2, 0, 1}};
+	Repr a{cubic, {{1, 2}}};
+	Repr b{quadratic, {{1, 2}}};
+	Repr c{cubic, {{3, 4}}};
+	bool succeeded = true;
+	try {
+		a + b;
+		succeeded = false;
+	} catch (const std::domain_error&) {}
+	try {
+		a *= b;
+		succeeded = false;
+	} catch (const std::domain_error&) {}
+	try {
+		a + c;
+		a * c;
+	} catch (const std::domain_error&) {
+		succeeded = false;
+	}
+	std::cout << name << " rejecting elements from different fields";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+template<typename Untagged, typename Tagged>
+void test_tagged(const char * name) {
+	Polynomial<GF1<5>> cubic{{1, 4, 3, 1}};
+	bool succeeded = true;
+	for (uint64_t i = 1; i < 125; i++) {
+		Polynomial<GF1<5>> poly{{i % 5, (i / 5) % 5, i / 25}};
+		GF<5, Untagged> a{cubic, poly};
+		GF<5, Tagged> b{cubic, poly};
+		GF<5, Untagged> a_next{cubic, {{1, 1}}};
+		GF<5, Tagged> b_next{cubic, {{1, 1}}};
+		succeeded &= (a * a_next + a).to_string() == (b * b_next + b).to_string();
+		succeeded &= a.inv().to_string() == b.inv().to_string();
+	}
+	std::cout << name << " with a Tag matching " << name << " without one";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// Addition used to be dominated by comparing the companion matrices.
+template<typename Repr>
+void time_additions(const std::string& name, size_t iterations) {
+	std::vector<GF1<3>> coeffs(41, GF1<3>{0});
+	// x^40 + x^3 + x^2 + 2 isn't necessarily irreducible, but addition
+	// doesn't care.
+	coeffs[0] = 2;
+	coeffs[2] = 1;
+	coeffs[3] = 1;
+	coeffs[40] = 1;
+	Polynomial<GF1<3>> irreducible{coeffs};
+	Repr sum{irreducible};
+	Repr step{irreducible, {{1, 2, 0, 1}}};
+	std::string timer_name = "Adding in GF(3^40) with " + name;
+	{
+		Timer t(timer_name.c_str());
+		for (size_t i = 0; i < iterations; i++) {
+			sum += step;
+		}
+	}
+	Repr expected{step};
+	expected *= GF1<3>{iterations % 3};
+	std::cout << "Adding in GF(3^40) with " << name;
+	std::cout << (sum == expected ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_different_fields<GF_Mat<5>>("GF_Mat");
+	test_different_fields<GF_Poly<5>>("GF_Poly");
+	test_tagged<GF_Mat<5>, GF_Mat<5, GF_125>>("GF_Mat");
+	test_tagged<GF_Poly<5>, GF_Poly<5, GF_125>>("GF_Poly");
+	test_tagged<GF_Packed<5, 3>, GF_Packed<5, 3, GF_125>>("GF_Packed");
+	time_additions<GF_Mat<3>>("GF_Mat", 100000);
+	time_additions<GF_Mat<3, GF_3_40>>("a tagged GF_Mat", 100000);
+	return 0;
+}
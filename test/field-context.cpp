@@ -0,0 +1,99 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+void test_interning() {
+	Polynomial<GF1<5>> irreducible{{1, 4, 2, 3, 3, 4, 1}};
+	Polynomial<GF1<5>> scaled{{3, 2, 1, 4, 4, 2, 3}};
+	Polynomial<GF1<5>> other{{1, 1, 0, 1}};
+	bool succeeded = true;
+	succeeded &= Field_Context<5>::get(irreducible) == Field_Context<5>::get(irreducible);
+	succeeded &= Field_Context<5>::get(irreducible) == Field_Context<5>::get(scaled);
+	succeeded &= Field_Context<5>::get(irreducible) != Field_Context<5>::get(other);
+	GF_Mat<5> a{irreducible, {{1, 2}}};
+	GF_Mat<5> b{scaled, {{3, 4}}};
+	GF_Poly<5> c{irreducible, {{1, 2}}};
+	succeeded &= a.get_context() == b.get_context() && a.get_context() == c.get_context();
+	std::cout << "Field_Context interning";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// Checks the tables against the matrix representation.
+template<uint32_t p>
+void test_tables(const Polynomial<GF1<p>>& irreducible, const char * name) {
+	const Field_Context<p> * context = Field_Context<p>::get(irreducible);
+	size_t n = context->degree();
+	bool succeeded = true;
+	GF_Mat<p> x{context, Polynomial<GF1<p>>{{0, 1}}};
+	GF_Mat<p> power = x^static_cast<int>(n);
+	for (const auto& row : context->get_reduction_table()) {
+		succeeded &= power.to_poly().to_string() == Polynomial<GF1<p>>{row}.to_string();
+		power *= x;
+	}
+	GF_Mat<p> frobenius = x;
+	for (const auto& row : context->get_frobenius_powers()) {
+		succeeded &= frobenius.to_poly().to_string() == Polynomial<GF1<p>>{row}.to_string();
+		frobenius = frobenius.pow_u(p);
+	}
+	// x^(p^n) = x.
+	succeeded &= frobenius == x;
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	for (size_t i = 0; i < 100; i++) {
+		Polynomial<GF1<p>> a_poly = random_poly<p>(n, seed);
+		Polynomial<GF1<p>> b_poly = random_poly<p>(n, seed);
+		GF_Mat<p> a{context, a_poly}, b{context, b_poly};
+		std::vector<GF1<p>> a_coeffs, b_coeffs;
+		for (size_t j = 0; j < n; j++) {
+			a_coeffs.push_back(a_poly[j]);
+			b_coeffs.push_back(b_poly[j]);
+		}
+		succeeded &= (a * b).to_poly().to_string() == Polynomial<GF1<p>>{context->mul_mod(a_coeffs, b_coeffs)}.to_string();
+	}
+	std::cout << "Field_Context tables for " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void time_copies(size_t iterations) {
+	Polynomial<GF1<5>> irreducible{{1, 4, 2, 3, 3, 4, 1}};
+	GF<5> mat_element{irreducible, {{1, 2, 3}}};
+	GF<5, GF_Poly<5>> poly_element{irreducible, {{1, 2, 3}}};
+	std::vector<GF<5>> mat_copies;
+	std::vector<GF<5, GF_Poly<5>>> poly_copies;
+	{
+		Timer t("Copying GF(5^6) elements with GF_Mat");
+		mat_copies.assign(iterations, mat_element);
+	}
+	{
+		Timer t("Copying GF(5^6) elements with GF_Poly");
+		poly_copies.assign(iterations, poly_element);
+	}
+	{
+		Timer t("Building zeros of GF(5^6) from the irreducible polynomial");
+		for (size_t i = 0; i < iterations; i++) {
+			mat_copies[i] = zero<GF<5>>(&irreducible);
+		}
+	}
+	bool succeeded = mat_copies.back() == zero<GF<5>>(&irreducible)
+		&& poly_copies.back() == poly_element;
+	std::cout << "Copying elements that share a Field_Context";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_interning();
+	test_tables<2>(Polynomial<GF1<2>>{{1, 1, 0, 1}}, "x^3 + x + 1");
+	test_tables<5>(Polynomial<GF1<5>>{{1, 4, 2, 3, 3, 4, 1}}, "a degree 6 polynomial over GF(5)");
+	test_tables<7>(Polynomial<GF1<7>>{{3, 1}}, "x + 3");
+	test_tables<65521>(Polynomial<GF1<65521>>{{65504, 0, 0, 0, 1}}, "x^4 - 17 over GF(65521)");
+	time_copies(100000);
+	return 0;
+}
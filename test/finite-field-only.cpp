@@ -0,0 +1,78 @@
+#include "../include/finite-field.hpp"
+#include "simple-timer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Only finite-field.hpp, so Polynomial<GF1<p>> has to multiply and divide
+// without anything gf.hpp would pull in.
+
+using namespace cherry;
+
+template<uint32_t p>
+Polynomial<GF1<p>> random_full_poly(size_t n, uint64_t& seed) {
+	std::vector<GF1<p>> coeffs;
+	for (size_t i = 0; i < n; i++) {
+		coeffs.push_back(GF1<p>(next_random(seed) % p));
+	}
+	if (n > 0 && coeffs.back() == GF1<p>{0}) {
+		coeffs.back() = GF1<p>{1};
+	}
+	return Polynomial<GF1<p>>{ coeffs };
+}
+
+template<uint32_t p>
+std::vector<GF1<p>> naive_product(const Polynomial<GF1<p>>& a, const Polynomial<GF1<p>>& b) {
+	std::vector<GF1<p>> a_coeffs = a.to_vector();
+	std::vector<GF1<p>> b_coeffs = b.to_vector();
+	std::vector<GF1<p>> out(a_coeffs.size() + b_coeffs.size() - 1, GF1<p>{0});
+	for (size_t i = 0; i < a_coeffs.size(); i++) {
+		for (size_t j = 0; j < b_coeffs.size(); j++) {
+			out[i + j] += a_coeffs[i] * b_coeffs[j];
+		}
+	}
+	return out;
+}
+
+void test_small() {
+	Polynomial<GF1<5>> a{{1, 2, 3}};
+	Polynomial<GF1<5>> b{{4, 1}};
+	bool succeeded = (a * b).to_vector() == std::vector<GF1<5>>{4, 4, 4, 3};
+	succeeded &= (a / b).to_vector() == std::vector<GF1<5>>{0, 3};
+	succeeded &= (a % b).to_vector() == std::vector<GF1<5>>{1};
+	std::cout << "Multiplying and dividing small polynomials over GF(5)";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// Big enough for the NTT (and for 65521, the CRT over three NTT primes) and
+// for Newton division.
+template<uint32_t p>
+void test_large(const std::string& name) {
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t n : {200, 700}) {
+		Polynomial<GF1<p>> q = random_full_poly<p>(n, seed);
+		Polynomial<GF1<p>> b = random_full_poly<p>(n, seed);
+		Polynomial<GF1<p>> r = random_full_poly<p>(n - 1, seed);
+		Polynomial<GF1<p>> product = q * b;
+		succeeded &= product.to_vector() == naive_product(q, b);
+		Polynomial<GF1<p>> a = product + r;
+		succeeded &= (a / b).to_vector() == q.to_vector();
+		succeeded &= (a % b).to_vector() == r.to_vector();
+	}
+	std::cout << "Multiplying and dividing large polynomials over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_small();
+	test_large<998244353>("GF(998244353)");
+	test_large<65521>("GF(65521)");
+	return 0;
+}
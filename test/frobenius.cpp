@@ -0,0 +1,144 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+template<uint32_t p>
+uint64_t pow_of_p(size_t k) {
+	uint64_t out = 1;
+	for (size_t i = 0; i < k; i++) {
+		out *= p;
+	}
+	return out;
+}
+
+// Checks pow, the Frobenius map and Itoh-Tsujii against plain
+// square-and-multiply on the matrices and the extended Euclidean algorithm.
+template<uint32_t p>
+void test_field(const Polynomial<GF1<p>>& irreducible, const char * name, size_t iterations) {
+	const Field_Context<p> * context = Field_Context<p>::get(irreducible);
+	size_t n = context->degree();
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		std::vector<GF1<p>> coeffs = random_coeffs<p>(n, seed);
+		GF_Mat<p> a{context, coeffs};
+		GF_Poly<p> b{context, coeffs};
+		uint64_t exponents[4] = { next_random(seed) % 1000, next_random(seed), p, 0 };
+		for (uint64_t e : exponents) {
+			GF_Mat<p> expected{context};
+			expected.to_identity();
+			GF_Mat<p> square = a;
+			for (uint64_t bits = e; bits > 0; bits >>= 1) {
+				if (bits & 1) {
+					expected *= square;
+				}
+				square *= square;
+			}
+			succeeded &= a.pow_u(e) == expected;
+			succeeded &= b.pow_u(e).to_string() == expected.to_string();
+		}
+		for (size_t k = 0; k <= n && k < 4; k++) {
+			succeeded &= a.frobenius(k) == a.pow_u(pow_of_p<p>(k));
+			succeeded &= b.frobenius(k).to_string() == a.frobenius(k).to_string();
+		}
+		succeeded &= a.frobenius(n) == a;
+		if (!(a == GF_Mat<p>{context})) {
+			std::vector<GF1<p>> inverse = context->inv_itoh_tsujii(coeffs);
+			succeeded &= inverse == context->inv_mod(coeffs);
+			succeeded &= (a^-5) * (a^5) == GF_Mat<p>::one(&irreducible);
+		}
+	}
+	std::cout << "Frobenius map, pow and Itoh-Tsujii over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void time_fermat_inverse(size_t iterations) {
+	Polynomial<GF1<5>> irreducible{{1, 4, 2, 3, 3, 4, 1}};
+	const Field_Context<5> * context = Field_Context<5>::get(irreducible);
+	uint64_t seed = 7;
+	std::vector<GF<5>> elements;
+	for (size_t i = 0; i < iterations; i++) {
+		std::vector<GF1<5>> coeffs = random_coeffs<5>(6, seed);
+		coeffs[0] = GF1<5>{1};
+		elements.emplace_back(irreducible, Polynomial<GF1<5>>{coeffs});
+	}
+	// x^(p^n - 2) = x^-1.
+	uint32_t exponent = 15625 - 2;
+	std::vector<Matrix<GF1<5>>> matrix_powers;
+	std::vector<GF<5>> powers;
+	{
+		Timer t("x^(5^6 - 2) with matrix square-and-multiply");
+		for (const auto& element : elements) {
+			matrix_powers.push_back(element.get_val().get_val().pow_u(exponent));
+		}
+	}
+	{
+		Timer t("x^(5^6 - 2) reading the exponent in base 5");
+		for (const auto& element : elements) {
+			powers.push_back(element.pow_u(exponent));
+		}
+	}
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		succeeded &= powers[i].get_val().get_val() == matrix_powers[i];
+		succeeded &= powers[i] == elements[i].inv();
+	}
+	(void)context;
+	std::cout << "Fermat inverses in GF(5^6) matching";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+template<uint32_t p>
+void time_inverses(const Polynomial<GF1<p>>& irreducible, const std::string& name, size_t iterations) {
+	const Field_Context<p> * context = Field_Context<p>::get(irreducible);
+	uint64_t seed = 11;
+	std::vector<std::vector<GF1<p>>> elements;
+	for (size_t i = 0; i < iterations; i++) {
+		std::vector<GF1<p>> coeffs = random_coeffs<p>(context->degree(), seed);
+		coeffs[0] = GF1<p>{1};
+		elements.push_back(coeffs);
+	}
+	// Builds the Frobenius maps before timing anything.
+	context->frobenius(elements[0]);
+	std::vector<std::vector<GF1<p>>> euclid, itoh_tsujii;
+	std::string names[2] = {
+		"Inverting in " + name + " with the extended Euclidean algorithm",
+		"Inverting in " + name + " with Itoh-Tsujii"
+	};
+	{
+		Timer t(names[0].c_str());
+		for (const auto& element : elements) {
+			euclid.push_back(context->inv_mod(element));
+		}
+	}
+	{
+		Timer t(names[1].c_str());
+		for (const auto& element : elements) {
+			itoh_tsujii.push_back(context->inv_itoh_tsujii(element));
+		}
+	}
+	std::cout << "Both ways of inverting in " << name << " matching";
+	std::cout << (euclid == itoh_tsujii ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_field<2>(Polynomial<GF1<2>>{{1, 1, 0, 1}}, "GF(2^3)", 100);
+	test_field<5>(Polynomial<GF1<5>>{{3, 0, 1}}, "GF(5^2)", 100);
+	test_field<5>(Polynomial<GF1<5>>{{1, 4, 2, 3, 3, 4, 1}}, "GF(5^6)", 100);
+	test_field<7>(Polynomial<GF1<7>>{{3, 1}}, "GF(7)", 20);
+	test_field<65521>(Polynomial<GF1<65521>>{{65504, 0, 0, 0, 1}}, "GF(65521^4)", 50);
+	test_field<2>(GF2n<64, 0x1b>::modulus(), "GF(2^64)", 10);
+	time_fermat_inverse(1000);
+	time_inverses<5>(Polynomial<GF1<5>>{{1, 4, 2, 3, 3, 4, 1}}, "GF(5^6)", 1000);
+	time_inverses<2>(GF2n<127, 0x3>::modulus(), "GF(2^127)", 100);
+	return 0;
+}
@@ -0,0 +1,227 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+// Over GF(p) itself, an extension should be exactly GF_Poly.
+void test_against_gf_poly(size_t iterations) {
+	Polynomial<GF1<5>> irreducible{{1, 4, 2, 3, 3, 4, 1}};
+	const Ext_Context<GF1<5>, 6> * context = Ext_Context<GF1<5>, 6>::get(irreducible);
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		Polynomial<GF1<5>> a_poly = random_poly<5>(6, seed);
+		Polynomial<GF1<5>> b_poly = random_poly<5>(9, seed);
+		GF_Poly<5> a_flat{irreducible, a_poly}, b_flat{irreducible, b_poly};
+		GF_Ext<GF1<5>, 6> a{context, a_poly}, b{context, b_poly};
+		succeeded &= a_flat.to_string() == a.to_string();
+		succeeded &= b_flat.to_string() == b.to_string();
+		succeeded &= (a_flat * b_flat).to_string() == (a * b).to_string();
+		succeeded &= (a_flat - b_flat).to_string() == (a - b).to_string();
+		succeeded &= a_flat.pow_u(1000).to_string() == a.pow_u(1000).to_string();
+		if (!a.is_zero()) {
+			succeeded &= a_flat.inv().to_string() == a.inv().to_string();
+		}
+	}
+	std::cout << "GF_Ext<GF1<5>, 6> matching GF_Poly<5>";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// Field axioms in a tower with p^n elements, plus x^(p^n) = x.
+template<typename Ext>
+void test_axioms(const typename Ext::Context * context, const std::function<Ext(uint64_t&)>& random, uint64_t order, const char * name, size_t iterations) {
+	uint64_t seed = 0x2545f4914f6cdd1d;
+	Ext one_v = one<Ext>(context);
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		Ext a = random(seed);
+		Ext b = random(seed);
+		Ext c = random(seed);
+		succeeded &= a * (b + c) == a * b + a * c;
+		succeeded &= (a * b) * c == a * (b * c);
+		succeeded &= a * b == b * a;
+		succeeded &= a.pow_u(order) == a;
+		if (!a.is_zero()) {
+			succeeded &= a * a.inv() == one_v;
+			succeeded &= a.pow_u(order - 1) == one_v;
+			succeeded &= (b / a) * a == b;
+		}
+	}
+	try {
+		zero<Ext>(context).inv();
+		succeeded = false;
+	} catch (const std::domain_error&) {}
+	std::cout << "Field axioms in " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// GF((5^2)^3) two ways: over GF<5, GF_Poly<5>> and over GF_Ext<GF1<5>, 2>.
+// x^3 - c is irreducible over GF(25) exactly when c isn't a cube, i.e. when
+// c^8 isn't 1.
+void test_towers() {
+	using F25 = GF<5, GF_Poly<5>>;
+	Polynomial<GF1<5>> quadratic{{3, 0, 1}};
+	F25 c{quadratic, {{1, 1}}};
+	while (c.pow_u(8) == one<F25>(&quadratic)) {
+		c += one<F25>(&quadratic);
+	}
+	Polynomial<F25> cubic{{-c, F25{quadratic}, F25{quadratic}, one<F25>(&quadratic)}};
+	using Tower = GF_Ext<F25, 3>;
+	test_axioms<Tower>(Tower::Context::get(cubic), [&](uint64_t& seed) {
+		std::vector<F25> coeffs;
+		for (size_t i = 0; i < 3; i++) {
+			coeffs.emplace_back(quadratic, random_poly<5>(2, seed));
+		}
+		return Tower{cubic, coeffs};
+	}, 15625, "GF((5^2)^3) over GF<5, GF_Poly<5>>", 100);
+
+	using E25 = GF_Ext<GF1<5>, 2>;
+	const E25::Context * inner = E25::Context::get(quadratic);
+	E25 e{inner, c.get_val().to_poly()};
+	Polynomial<E25> nested_cubic{{-e, E25{inner}, E25{inner}, one<E25>(inner)}};
+	using Nested = GF_Ext<E25, 3>;
+	test_axioms<Nested>(Nested::Context::get(nested_cubic), [&](uint64_t& seed) {
+		std::vector<E25> coeffs;
+		for (size_t i = 0; i < 3; i++) {
+			coeffs.emplace_back(inner, random_poly<5>(2, seed));
+		}
+		return Nested{nested_cubic, coeffs};
+	}, 15625, "GF((5^2)^3) over GF_Ext<GF1<5>, 2>", 100);
+
+	// x^2 + 2 and x^2 + 3 both give GF(25), and x^3 - 2 prints the same over
+	// both, but they're still different extensions.
+	Polynomial<GF1<5>> other_quadratic{{2, 0, 1}};
+	Polynomial<F25> binomial{{F25{quadratic, {{3}}}, F25{quadratic}, F25{quadratic}, one<F25>(&quadratic)}};
+	Polynomial<F25> other_binomial{{F25{other_quadratic, {{3}}}, F25{other_quadratic}, F25{other_quadratic}, one<F25>(&other_quadratic)}};
+	bool succeeded = Tower::Context::get(binomial) != Tower::Context::get(other_binomial);
+	succeeded &= Tower::Context::get(binomial) == Tower::Context::get(binomial);
+	try {
+		Tower{binomial} + Tower{other_binomial};
+		succeeded = false;
+	} catch (const std::domain_error&) {}
+	// Zero in each of them is all zeros, but they still aren't equal.
+	succeeded &= !(Tower{binomial} == Tower{other_binomial});
+	// Default-constructed elements count as zero but can't do anything that
+	// needs the modulus.
+	E25 empty;
+	succeeded &= empty.is_zero() && !(empty == E25{inner});
+	try {
+		empty.to_identity();
+		succeeded = false;
+	} catch (const std::domain_error&) {}
+	std::cout << "Telling apart extensions of different base fields";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// The usual tower for pairings, with p = 3 mod 4:
+//
+//     GF(p^2) = GF(p)[u] / (u^2 + 1)
+//     GF(p^6) = GF(p^2)[v] / (v^3 - (u + k))
+//     GF(p^12) = GF(p^6)[w] / (w^2 - v)
+//
+// where u + k is neither a square nor a cube in GF(p^2). Then w^6 = u + k,
+// so w is a root of x^12 - 2k x^6 + k^2 + 1, which is the flat version.
+constexpr uint32_t pairing_p = 65519;
+using Fp = GF1<pairing_p>;
+using Fp2 = GF_Ext<Fp, 2>;
+using Fp6 = GF_Ext<Fp2, 3>;
+using Fp12 = GF_Ext<Fp6, 2>;
+
+GF_Poly<pairing_p> flatten(const Fp12& a, const GF_Poly<pairing_p>& w, uint64_t k) {
+	GF_Poly<pairing_p> v = w * w;
+	GF_Poly<pairing_p> u = w.pow_u(6) - GF_Poly<pairing_p>{w.get_context(), {{k}}};
+	GF_Poly<pairing_p> out{w.get_context()};
+	GF_Poly<pairing_p> w_power{w.get_context(), {{1}}};
+	for (const Fp6& c : a.get_val()) {
+		GF_Poly<pairing_p> v_power{w.get_context(), {{1}}};
+		for (const Fp2& d : c.get_val()) {
+			out += (GF_Poly<pairing_p>{w.get_context(), {{d.get_val()[0]}}} + u * d.get_val()[1]) * v_power * w_power;
+			v_power *= v;
+		}
+		w_power *= w;
+	}
+	return out;
+}
+
+void test_pairing_tower(size_t iterations, size_t timing_iterations) {
+	const uint64_t q2 = static_cast<uint64_t>(pairing_p) * pairing_p;
+	const Fp2::Context * fp2 = Fp2::Context::get(Polynomial<Fp>{{1, 0, 1}});
+	uint64_t k = 1;
+	while (true) {
+		Fp2 xi{fp2, {{k, 1}}};
+		if (!(xi.pow_u((q2 - 1) / 2) == one<Fp2>(fp2)) && !(xi.pow_u((q2 - 1) / 3) == one<Fp2>(fp2))) {
+			break;
+		}
+		k++;
+	}
+	Fp2 xi{fp2, {{k, 1}}};
+	const Fp6::Context * fp6 = Fp6::Context::get(Polynomial<Fp2>{{-xi, Fp2{fp2}, Fp2{fp2}, one<Fp2>(fp2)}});
+	Fp6 v{fp6, {{Fp2{fp2}, one<Fp2>(fp2)}}};
+	const Fp12::Context * fp12 = Fp12::Context::get(Polynomial<Fp6>{{-v, Fp6{fp6}, one<Fp6>(fp6)}});
+
+	std::vector<Fp> flat_modulus(13, Fp{0});
+	flat_modulus[0] = Fp{k * k + 1};
+	flat_modulus[6] = -Fp{2 * k};
+	flat_modulus[12] = Fp{1};
+	const Field_Context<pairing_p> * flat = Field_Context<pairing_p>::get(flat_modulus);
+	GF_Poly<pairing_p> w{flat, {{0, 1}}};
+
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	auto random = [&]() {
+		std::vector<Fp6> c;
+		for (size_t i = 0; i < 2; i++) {
+			std::vector<Fp2> d;
+			for (size_t j = 0; j < 3; j++) {
+				d.emplace_back(fp2, random_poly<pairing_p>(2, seed));
+			}
+			c.emplace_back(fp6, d);
+		}
+		return Fp12{fp12, c};
+	};
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		Fp12 a = random();
+		Fp12 b = random();
+		GF_Poly<pairing_p> a_flat = flatten(a, w, k);
+		GF_Poly<pairing_p> b_flat = flatten(b, w, k);
+		succeeded &= flatten(a * b, w, k) == a_flat * b_flat;
+		succeeded &= flatten(a.inv(), w, k) == a_flat.inv();
+	}
+	std::cout << "GF(((p^2)^3)^2) matching GF(p^12)";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+
+	Fp12 a = random();
+	Fp12 step = random();
+	GF_Poly<pairing_p> a_flat = flatten(a, w, k);
+	GF_Poly<pairing_p> step_flat = flatten(step, w, k);
+	{
+		Timer t("Multiplying in GF(p^12) with GF_Poly");
+		for (size_t i = 0; i < timing_iterations; i++) {
+			a_flat *= step_flat;
+		}
+	}
+	{
+		Timer t("Multiplying in GF(((p^2)^3)^2) with GF_Ext");
+		for (size_t i = 0; i < timing_iterations; i++) {
+			a *= step;
+		}
+	}
+	std::cout << "Both ways of multiplying in GF(p^12) matching";
+	std::cout << (flatten(a, w, k) == a_flat ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_against_gf_poly(300);
+	test_towers();
+	test_pairing_tower(100, 20000);
+	return 0;
+}
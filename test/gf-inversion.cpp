@@ -0,0 +1,159 @@
+// Low enough that inverses in GF(2^128) go through the half GCD.
+#define POLYNOMIAL_HALF_GCD_INVERSE_THRESHOLD 128
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <algorithm>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+// The matrix of an element built the slow way, as a polynomial in lambda.
+template<uint32_t p>
+Matrix<GF1<p>> horner_matrix(const Field_Context<p> * context, const Polynomial<GF1<p>>& vals) {
+	Matrix<GF1<p>> out{GF1<p>{0}, context->degree()};
+	for (size_t i = vals.degree(); i <= vals.degree(); i--) {
+		out *= context->get_companion();
+		out += context->get_identity() * vals[i];
+	}
+	return out;
+}
+
+template<uint32_t p>
+void test_inverses(const Polynomial<GF1<p>>& irreducible, const char * name, size_t iterations) {
+	const Field_Context<p> * context = Field_Context<p>::get(irreducible);
+	size_t n = context->degree();
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		Polynomial<GF1<p>> poly = random_poly<p>(2 * n + 1, seed);
+		GF_Mat<p> a{context, poly};
+		GF_Poly<p> b{context, poly};
+		succeeded &= a.get_val() == horner_matrix(context, poly);
+		if (a == GF_Mat<p>{context}) {
+			continue;
+		}
+		GF_Mat<p> a_inv = a.inv();
+		succeeded &= a_inv.get_val() == a.get_val().inv();
+		succeeded &= a_inv.to_string() == b.inv().to_string();
+		succeeded &= (a * a_inv).to_string() == GF_Mat<p>::one(&irreducible).to_string();
+	}
+	try {
+		GF_Mat<p>{context}.inv();
+		succeeded = false;
+	} catch (const std::domain_error&) {}
+	std::cout << "Extended Euclidean inverses over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// x^128 + x^7 + x^2 + x + 1, the modulus GCM uses.
+Polynomial<GF1<2>> gcm_modulus() {
+	std::vector<GF1<2>> coeffs(129, GF1<2>{0});
+	for (size_t i : {0, 1, 2, 7, 128}) {
+		coeffs[i] = GF1<2>{1};
+	}
+	return coeffs;
+}
+
+// Through both contexts, checked against the plain extended Euclidean
+// algorithm.
+void test_half_gcd_inverses(size_t iterations) {
+	const Polynomial<GF1<2>> irreducible = gcm_modulus();
+	const Field_Context<2> * context = Field_Context<2>::get(irreducible);
+	uint64_t seed = 0x2545f4914f6cdd1d;
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		Polynomial<GF1<2>> poly = random_poly<2>(128, seed);
+		poly[0] = GF1<2>{1};
+		GF_Poly<2> a{context, poly};
+		GF_Ext<GF1<2>, 128> b{irreducible, poly};
+		GF_Poly<2> a_inv = a.inv();
+		GF_Ext<GF1<2>, 128> b_inv = b.inv();
+		std::vector<GF1<2>> expected = euclid_inverse_mod(poly, irreducible).to_vector();
+		expected.resize(128, GF1<2>{0});
+		succeeded &= a_inv.get_val() == expected;
+		succeeded &= std::equal(expected.begin(), expected.end(), b_inv.get_val().begin());
+		GF_Poly<2> one_v{context};
+		one_v.to_identity();
+		succeeded &= a * a_inv == one_v;
+	}
+	std::cout << "Half GCD inverses over GF(2^128)";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+template<typename Repr>
+void test_batch_inversion(const std::string& name) {
+	Polynomial<GF1<5>> irreducible{{1, 4, 2, 3, 3, 4, 1}};
+	uint64_t seed = 31337;
+	std::vector<GF<5, Repr>> values, inverses;
+	for (size_t i = 0; i < 100; i++) {
+		Polynomial<GF1<5>> poly = random_poly<5>(6, seed);
+		poly[0] = GF1<5>{1};
+		values.emplace_back(irreducible, poly);
+	}
+	inverses.assign(values.size(), zero<GF<5, Repr>>(&irreducible));
+	batch_inv(std::span<const GF<5, Repr>>{values}, std::span<GF<5, Repr>>{inverses});
+	bool succeeded = true;
+	for (size_t i = 0; i < values.size(); i++) {
+		succeeded &= inverses[i].to_string() == values[i].inv().to_string();
+	}
+	std::cout << "Batch inversion of GF<5, " << name << ">";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+template<uint32_t p>
+void time_inverses(const Polynomial<GF1<p>>& irreducible, const std::string& name, size_t iterations) {
+	const Field_Context<p> * context = Field_Context<p>::get(irreducible);
+	uint64_t seed = 7;
+	std::vector<GF_Mat<p>> elements;
+	for (size_t i = 0; i < iterations; i++) {
+		Polynomial<GF1<p>> poly = random_poly<p>(context->degree(), seed);
+		poly[0] = GF1<p>{1};
+		elements.emplace_back(context, poly);
+	}
+	std::vector<Matrix<GF1<p>>> matrix_inverses;
+	std::vector<GF_Mat<p>> inverses;
+	std::string names[2] = {
+		"Inverting in " + name + " with Gauss-Jordan",
+		"Inverting in " + name + " with the extended Euclidean algorithm"
+	};
+	{
+		Timer t(names[0].c_str());
+		for (const auto& element : elements) {
+			matrix_inverses.push_back(element.get_val().inv());
+		}
+	}
+	{
+		Timer t(names[1].c_str());
+		for (const auto& element : elements) {
+			inverses.push_back(element.inv());
+		}
+	}
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		succeeded &= inverses[i].get_val() == matrix_inverses[i];
+	}
+	std::cout << "Both ways of inverting in " << name << " matching";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_inverses<2>(Polynomial<GF1<2>>{{1, 1, 0, 1}}, "GF(2^3)", 100);
+	test_inverses<5>(Polynomial<GF1<5>>{{3, 0, 1}}, "GF(5^2)", 100);
+	test_inverses<5>(Polynomial<GF1<5>>{{1, 4, 2, 3, 3, 4, 1}}, "GF(5^6)", 300);
+	test_inverses<7>(Polynomial<GF1<7>>{{3, 1}}, "GF(7)", 20);
+	test_inverses<2>(GF2n<64, 0x1b>::modulus(), "GF(2^64)", 10);
+	test_half_gcd_inverses(100);
+	test_batch_inversion<GF_Mat<5>>("GF_Mat<5>");
+	test_batch_inversion<GF_Poly<5>>("GF_Poly<5>");
+	time_inverses<5>(Polynomial<GF1<5>>{{1, 4, 2, 3, 3, 4, 1}}, "GF(5^6)", 2000);
+	time_inverses<2>(GF2n<64, 0x1b>::modulus(), "GF(2^64)", 50);
+	return 0;
+}
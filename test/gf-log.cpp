@@ -0,0 +1,155 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+template<uint32_t p>
+Polynomial<GF1<p>> index_to_poly(uint64_t index, size_t n) {
+	std::vector<GF1<p>> coeffs;
+	for (size_t i = 0; i < n; i++) {
+		coeffs.emplace_back(index % p);
+		index /= p;
+	}
+	return coeffs;
+}
+
+// Every sum, difference, product and inverse in a small field against the
+// matrix representation.
+template<uint32_t p>
+void test_against_gf_mat(const Polynomial<GF1<p>>& irreducible, const char * name) {
+	size_t n = irreducible.degree();
+	size_t q = 1;
+	for (size_t i = 0; i < n; i++) {
+		q *= p;
+	}
+	bool succeeded = true;
+	std::vector<GF<p>> mat_elements;
+	std::vector<GF<p, GF_Log<p>>> log_elements;
+	for (size_t i = 0; i < q; i++) {
+		mat_elements.emplace_back(irreducible, index_to_poly<p>(i, n));
+		log_elements.emplace_back(irreducible, index_to_poly<p>(i, n));
+		succeeded &= mat_elements.back().to_string() == log_elements.back().to_string();
+	}
+	// x itself, which is a constant when n = 1.
+	Polynomial<GF1<p>> x{{0, 1}};
+	succeeded &= GF<p>{irreducible, x}.to_string() == GF<p, GF_Log<p>>{irreducible, x}.to_string();
+	for (size_t i = 0; i < q; i++) {
+		for (size_t j = 0; j < q; j++) {
+			succeeded &= (mat_elements[i] * mat_elements[j]).to_string() == (log_elements[i] * log_elements[j]).to_string();
+			succeeded &= (mat_elements[i] + mat_elements[j]).to_string() == (log_elements[i] + log_elements[j]).to_string();
+			succeeded &= (mat_elements[i] - mat_elements[j]).to_string() == (log_elements[i] - log_elements[j]).to_string();
+		}
+		succeeded &= (-mat_elements[i]).to_string() == (-log_elements[i]).to_string();
+		succeeded &= (GF1<p>{p - 1} * mat_elements[i]).to_string() == (GF1<p>{p - 1} * log_elements[i]).to_string();
+		if (i != 0) {
+			succeeded &= mat_elements[i].inv().to_string() == log_elements[i].inv().to_string();
+			succeeded &= (mat_elements[i]^-7).to_string() == (log_elements[i]^-7).to_string();
+		}
+	}
+	std::cout << "GF<" << p << ", GF_Log<" << p << ">> matching GF<" << p << "> over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// GF(5^6) is too big to try every pair, so this checks the field axioms on
+// random elements instead.
+void test_random_elements(size_t iterations) {
+	Polynomial<GF1<5>> irreducible{{1, 4, 2, 3, 3, 4, 1}};
+	using F = GF<5, GF_Log<5>>;
+	F zero_v = zero<F>(&irreducible);
+	F one_v = one<F>(&irreducible);
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		F a{irreducible, index_to_poly<5>(next_random(seed) % 15625, 6)};
+		F b{irreducible, index_to_poly<5>(next_random(seed) % 15625, 6)};
+		F c{irreducible, index_to_poly<5>(next_random(seed) % 15625, 6)};
+		succeeded &= a * (b + c) == a * b + a * c;
+		succeeded &= (a + b) + c == a + (b + c);
+		succeeded &= a - a == zero_v;
+		succeeded &= (a^15625) == a;
+		if (!(a == zero_v)) {
+			succeeded &= a * a.inv() == one_v;
+			succeeded &= (a^-3) * (a^3) == one_v;
+		}
+	}
+	std::cout << "GF_Log field axioms over GF(5^6)";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void test_bad_polynomials() {
+	bool succeeded = true;
+	try {
+		// (x + 1)(x^2 + 1) over GF(3).
+		GF_Log<3> a{Polynomial<GF1<3>>{{1, 1, 1, 1}}};
+		succeeded = false;
+	} catch (const std::invalid_argument&) {}
+	try {
+		// x^31 + x^3 + 1 is irreducible, but GF(2^31) is too big for tables.
+		std::vector<GF1<2>> coeffs(32, GF1<2>{0});
+		coeffs[0] = coeffs[3] = coeffs[31] = 1;
+		GF_Log<2> a{Polynomial<GF1<2>>{coeffs}};
+		succeeded = false;
+	} catch (const std::length_error&) {}
+	// Default-constructed elements are zero without a table.
+	GF_Log<3> empty;
+	succeeded &= (-empty).get_log() == GF_Log<3>::Table::zero_log;
+	succeeded &= (empty * GF1<3>{2}).get_log() == GF_Log<3>::Table::zero_log;
+	std::cout << "GF_Log with reducible and huge polynomials";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void time_against_gf_mat(size_t iterations) {
+	Polynomial<GF1<5>> irreducible{{1, 4, 2, 3, 3, 4, 1}};
+	uint64_t seed = 7;
+	std::vector<Polynomial<GF1<5>>> polys;
+	for (size_t i = 0; i < iterations; i++) {
+		polys.push_back(index_to_poly<5>(next_random(seed) % 15624 + 1, 6));
+	}
+	GF<5> mat_product{irreducible, {{1}}};
+	GF<5> mat_sum{irreducible};
+	GF<5, GF_Log<5>> log_product{irreducible, {{1}}};
+	GF<5, GF_Log<5>> log_sum{irreducible};
+	std::vector<GF<5>> mat_elements;
+	std::vector<GF<5, GF_Log<5>>> log_elements;
+	for (const auto& poly : polys) {
+		mat_elements.emplace_back(irreducible, poly);
+		log_elements.emplace_back(irreducible, poly);
+	}
+	{
+		Timer t("Multiplying, inverting and adding in GF(5^6) with GF_Mat");
+		for (const auto& element : mat_elements) {
+			mat_product *= element;
+			mat_sum += element.inv();
+		}
+	}
+	{
+		Timer t("Multiplying, inverting and adding in GF(5^6) with GF_Log");
+		for (const auto& element : log_elements) {
+			log_product *= element;
+			log_sum += element.inv();
+		}
+	}
+	std::cout << "GF_Log and GF_Mat results matching";
+	bool succeeded = mat_product.to_string() == log_product.to_string()
+		&& mat_sum.to_string() == log_sum.to_string();
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_against_gf_mat<2>(Polynomial<GF1<2>>{{1, 1, 0, 1}}, "x^3 + x + 1");
+	test_against_gf_mat<3>(Polynomial<GF1<3>>{{2, 2, 0, 0, 1}}, "x^4 + 2x + 2");
+	test_against_gf_mat<5>(Polynomial<GF1<5>>{{1, 1, 0, 1}}, "x^3 + x + 1");
+	test_against_gf_mat<7>(Polynomial<GF1<7>>{{3, 1}}, "x + 3");
+	test_random_elements(10000);
+	test_bad_polynomials();
+	time_against_gf_mat(2000);
+	return 0;
+}
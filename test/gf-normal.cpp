@@ -0,0 +1,153 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+// Random products, sums, powers and inverses against the matrix
+// representation, plus going back and forth between the two.
+template<uint32_t p>
+void test_against_gf_mat(const Polynomial<GF1<p>>& irreducible, const char * name, size_t iterations) {
+	size_t n = irreducible.degree();
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		Polynomial<GF1<p>> a_poly = random_poly<p>(n, seed);
+		Polynomial<GF1<p>> b_poly = random_poly<p>(n + 3, seed);
+		GF<p> a_mat{irreducible, a_poly}, b_mat{irreducible, b_poly};
+		GF<p, GF_Normal<p>> a{irreducible, a_poly}, b{irreducible, b_poly};
+		succeeded &= a_mat.to_string() == a.to_string();
+		succeeded &= b_mat.to_string() == b.to_string();
+		succeeded &= (a_mat * b_mat).to_string() == (a * b).to_string();
+		succeeded &= (a_mat + b_mat).to_string() == (a + b).to_string();
+		succeeded &= (a_mat - b_mat).to_string() == (a - b).to_string();
+		succeeded &= (GF1<p>{2} * a_mat).to_string() == (GF1<p>{2} * a).to_string();
+		succeeded &= (a_mat^5).to_string() == (a^5).to_string();
+		succeeded &= a_mat.pow_u(p * p + 3).to_string() == a.pow_u(p * p + 3).to_string();
+		succeeded &= a_mat.frobenius(1).to_string() == a.frobenius(1).to_string();
+		succeeded &= GF_Normal<p>{a_mat.get_val()}.to_gf_mat() == a_mat.get_val();
+		succeeded &= GF_Normal<p>{a.get_val().to_gf_poly()} == a.get_val();
+		if (!(a_mat == zero<GF<p>>(&irreducible))) {
+			succeeded &= a_mat.inv().to_string() == a.inv().to_string();
+			succeeded &= (a_mat^-3).to_string() == (a^-3).to_string();
+		}
+	}
+	succeeded &= one<GF<p, GF_Normal<p>>>(&irreducible).to_string() == one<GF<p>>(&irreducible).to_string();
+	std::cout << "GF<" << p << ", GF_Normal<" << p << ">> matching GF<" << p << "> over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// In a normal basis, the Frobenius map should just rotate the coordinates.
+template<uint32_t p>
+void test_rotation(const Polynomial<GF1<p>>& irreducible, const char * name) {
+	const Field_Context<p> * context = Field_Context<p>::get(irreducible);
+	size_t n = context->degree();
+	uint64_t seed = 12345;
+	bool succeeded = true;
+	for (size_t i = 0; i < 20; i++) {
+		GF_Normal<p> a{context, random_poly<p>(n, seed)};
+		for (size_t k = 0; k <= n; k++) {
+			const std::vector<GF1<p>>& before = a.get_val();
+			std::vector<GF1<p>> after = a.frobenius(k).get_val();
+			for (size_t j = 0; j < n; j++) {
+				succeeded &= after[(j + k) % n] == before[j];
+			}
+			succeeded &= a.frobenius(k).to_gf_poly().get_val() == context->frobenius(a.to_gf_poly().get_val(), k);
+		}
+	}
+	std::cout << "Frobenius maps as rotations over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// GF(2^4) and GF(5^6) have optimal normal bases of type I, GF(2^3) has one
+// of type II, and GF(2^8) doesn't have one at all.
+template<uint32_t p>
+void test_optimal(const Polynomial<GF1<p>>& irreducible, const char * name, bool expected) {
+	const Normal_Basis<p> * basis = Normal_Basis<p>::get(Field_Context<p>::get(irreducible));
+	std::cout << "Normal basis of " << name << " has " << basis->complexity() << " nonzero products\n";
+	std::cout << "Finding " << (expected ? "an" : "no") << " optimal normal basis for " << name;
+	std::cout << (basis->is_optimal() == expected ? " succeeded!\n" : " failed!\n");
+}
+
+template<uint32_t p>
+void time_frobenius(const Polynomial<GF1<p>>& irreducible, const std::string& name, size_t iterations) {
+	const Field_Context<p> * context = Field_Context<p>::get(irreducible);
+	uint64_t seed = 7;
+	Polynomial<GF1<p>> poly = random_poly<p>(context->degree(), seed);
+	GF_Poly<p> a_poly{context, poly};
+	GF_Normal<p> a_normal{context, poly};
+	a_poly.frobenius();
+	std::string names[2] = {
+		"Frobenius maps in " + name + " with GF_Poly",
+		"Frobenius maps in " + name + " with GF_Normal"
+	};
+	{
+		Timer t(names[0].c_str());
+		for (size_t i = 0; i < iterations; i++) {
+			a_poly = a_poly.frobenius(i);
+		}
+	}
+	{
+		Timer t(names[1].c_str());
+		for (size_t i = 0; i < iterations; i++) {
+			a_normal = a_normal.frobenius(i);
+		}
+	}
+	std::cout << "Both ways of taking Frobenius maps in " << name << " matching";
+	std::cout << (a_poly.to_string() == a_normal.to_string() ? " succeeded!\n" : " failed!\n");
+}
+
+template<uint32_t p>
+void time_products(const Polynomial<GF1<p>>& irreducible, const std::string& name, size_t iterations) {
+	const Field_Context<p> * context = Field_Context<p>::get(irreducible);
+	uint64_t seed = 11;
+	Polynomial<GF1<p>> poly = random_poly<p>(context->degree(), seed);
+	Polynomial<GF1<p>> step = random_poly<p>(context->degree(), seed);
+	GF_Poly<p> a_poly{context, poly}, step_poly{context, step};
+	GF_Normal<p> a_normal{context, poly}, step_normal{context, step};
+	std::string names[2] = {
+		"Multiplying in " + name + " with GF_Poly",
+		"Multiplying in " + name + " with GF_Normal"
+	};
+	{
+		Timer t(names[0].c_str());
+		for (size_t i = 0; i < iterations; i++) {
+			a_poly *= step_poly;
+		}
+	}
+	{
+		Timer t(names[1].c_str());
+		for (size_t i = 0; i < iterations; i++) {
+			a_normal *= step_normal;
+		}
+	}
+	std::cout << "Both ways of multiplying in " << name << " matching";
+	std::cout << (a_poly.to_string() == a_normal.to_string() ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_against_gf_mat<2>(Polynomial<GF1<2>>{{1, 1, 0, 1}}, "GF(2^3)", 100);
+	test_against_gf_mat<2>(Polynomial<GF1<2>>{{1, 1, 0, 0, 1}}, "GF(2^4)", 100);
+	test_against_gf_mat<5>(Polynomial<GF1<5>>{{3, 0, 1}}, "GF(5^2)", 100);
+	test_against_gf_mat<5>(Polynomial<GF1<5>>{{1, 4, 2, 3, 3, 4, 1}}, "GF(5^6)", 300);
+	test_against_gf_mat<5>(Polynomial<GF1<5>>{{1, 4, 3, 1}}, "GF(5^3)", 100);
+	test_against_gf_mat<7>(Polynomial<GF1<7>>{{3, 1}}, "GF(7)", 20);
+	test_rotation<5>(Polynomial<GF1<5>>{{1, 4, 2, 3, 3, 4, 1}}, "GF(5^6)");
+	test_rotation<65521>(Polynomial<GF1<65521>>{{65504, 0, 0, 0, 1}}, "GF(65521^4)");
+	test_rotation<2>(GF2n<64, 0x1b>::modulus(), "GF(2^64)");
+	test_optimal<2>(Polynomial<GF1<2>>{{1, 1, 0, 0, 1}}, "GF(2^4)", true);
+	test_optimal<5>(Polynomial<GF1<5>>{{1, 4, 2, 3, 3, 4, 1}}, "GF(5^6)", true);
+	test_optimal<2>(Polynomial<GF1<2>>{{1, 1, 0, 1}}, "GF(2^3)", true);
+	test_optimal<2>(Polynomial<GF1<2>>{{1, 1, 0, 1, 1, 0, 0, 0, 1}}, "GF(2^8)", false);
+	time_frobenius<2>(GF2n<64, 0x1b>::modulus(), "GF(2^64)", 10000);
+	time_frobenius<5>(Polynomial<GF1<5>>{{1, 4, 2, 3, 3, 4, 1}}, "GF(5^6)", 100000);
+	time_products<5>(Polynomial<GF1<5>>{{1, 4, 2, 3, 3, 4, 1}}, "GF(5^6)", 100000);
+	return 0;
+}
@@ -0,0 +1,191 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+template<uint32_t p>
+Polynomial<GF1<p>> index_to_poly(uint64_t index, size_t n) {
+	std::vector<GF1<p>> coeffs;
+	for (size_t i = 0; i < n; i++) {
+		coeffs.emplace_back(index % p);
+		index /= p;
+	}
+	return coeffs;
+}
+
+// Every sum, difference, product and inverse in a small field against the
+// matrix representation, with the elements built both ways.
+template<uint32_t p, uint32_t n>
+void test_against_gf_mat(const Polynomial<GF1<p>>& irreducible, const char * name) {
+	using Packed = GF_Packed<p, n>;
+	const typename Packed::Table * table = Packed::Table::get(irreducible);
+	uint32_t q = Packed::Table::q;
+	bool succeeded = true;
+	std::vector<GF<p>> mat_elements;
+	std::vector<GF<p, Packed>> packed_elements;
+	for (uint32_t i = 0; i < q; i++) {
+		mat_elements.emplace_back(irreducible, index_to_poly<p>(i, n));
+		packed_elements.emplace_back(irreducible, index_to_poly<p>(i, n));
+		succeeded &= mat_elements.back().to_string() == packed_elements.back().to_string();
+		succeeded &= packed_elements.back().get_val() == Packed::from_index(table, i);
+		succeeded &= packed_elements.back().get_val().get_index() == i;
+	}
+	for (uint32_t i = 0; i < q; i++) {
+		for (uint32_t j = 0; j < q; j++) {
+			succeeded &= (mat_elements[i] * mat_elements[j]).to_string() == (packed_elements[i] * packed_elements[j]).to_string();
+			succeeded &= (mat_elements[i] + mat_elements[j]).to_string() == (packed_elements[i] + packed_elements[j]).to_string();
+			succeeded &= (mat_elements[i] - mat_elements[j]).to_string() == (packed_elements[i] - packed_elements[j]).to_string();
+		}
+		succeeded &= (-mat_elements[i]).to_string() == (-packed_elements[i]).to_string();
+		succeeded &= (GF1<p>{p - 1} * mat_elements[i]).to_string() == (GF1<p>{p - 1} * packed_elements[i]).to_string();
+		succeeded &= mat_elements[i].frobenius(1).to_string() == packed_elements[i].frobenius(1).to_string();
+		if (i != 0) {
+			succeeded &= mat_elements[i].inv().to_string() == packed_elements[i].inv().to_string();
+			succeeded &= (mat_elements[i]^-7).to_string() == (packed_elements[i]^-7).to_string();
+		}
+	}
+	std::cout << "GF<" << p << ", GF_Packed<" << p << ", " << n << ">> matching GF<" << p << "> over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// Fields too big to try every pair, including ones where the coefficients
+// are too wide for the grouped index tables.
+template<uint32_t p, uint32_t n>
+void test_random_elements(const Polynomial<GF1<p>>& irreducible, const char * name, size_t iterations) {
+	using F = GF<p, GF_Packed<p, n>>;
+	uint32_t q = GF_Packed<p, n>::Table::q;
+	F zero_v = zero<F>(&irreducible);
+	F one_v = one<F>(&irreducible);
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		Polynomial<GF1<p>> a_poly = index_to_poly<p>(next_random(seed) % q, n);
+		Polynomial<GF1<p>> b_poly = index_to_poly<p>(next_random(seed) % q, n);
+		F a{irreducible, a_poly}, b{irreducible, b_poly};
+		F c{irreducible, index_to_poly<p>(next_random(seed) % q, n)};
+		GF<p> a_mat{irreducible, a_poly}, b_mat{irreducible, b_poly};
+		succeeded &= (a_mat * b_mat).to_string() == (a * b).to_string();
+		succeeded &= (a_mat - b_mat).to_string() == (a - b).to_string();
+		succeeded &= a * (b + c) == a * b + a * c;
+		succeeded &= (a + b) + c == a + (b + c);
+		succeeded &= a - a == zero_v;
+		succeeded &= a.pow_u(q) == a;
+		// An exponent that doesn't fit in 32 bits.
+		GF_Packed<p, n> packed{irreducible, a_poly};
+		uint64_t big = (uint64_t{1} << 32) + 1;
+		succeeded &= packed.pow_u(big) == packed.pow_u(big % (q - 1));
+		if (!(a == zero_v)) {
+			succeeded &= a * a.inv() == one_v;
+			succeeded &= (a^-3) * (a^3) == one_v;
+		}
+	}
+	std::cout << "GF_Packed field axioms over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void test_bad_polynomials() {
+	bool succeeded = true;
+	try {
+		// x^3 + x + 1 is irreducible, but it doesn't have degree 2.
+		GF_Packed<5, 2> a{Polynomial<GF1<5>>{{1, 1, 0, 1}}};
+		succeeded = false;
+	} catch (const std::invalid_argument&) {}
+	try {
+		GF_Packed<2, 3>{Polynomial<GF1<2>>{{1, 1, 0, 1}}} + GF_Packed<2, 3>{Polynomial<GF1<2>>{{1, 0, 1, 1}}};
+		succeeded = false;
+	} catch (const std::domain_error&) {}
+	try {
+		Polynomial<GF1<3>> irreducible{{2, 2, 0, 0, 1}};
+		zero<GF<3, GF_Packed<3, 4>>>(&irreducible).inv();
+		succeeded = false;
+	} catch (const std::domain_error&) {}
+	std::cout << "GF_Packed with the wrong polynomials and zero";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// Summing x^3 + x over every element of GF(3^8), first by building each
+// element out of a polynomial and then by sweeping over the indices.
+void time_sweep() {
+	Polynomial<GF1<3>> irreducible{{2, 0, 2, 0, 0, 0, 0, 0, 1}};
+	const uint32_t q = 6561;
+	GF<3, GF_Log<3>> log_sum{irreducible};
+	GF_Packed<3, 8> packed_sum{irreducible};
+	{
+		Timer t("Sweeping over GF(3^8) with GF_Log");
+		for (uint32_t i = 0; i < q; i++) {
+			GF<3, GF_Log<3>> x{irreducible, index_to_poly<3>(i, 8)};
+			log_sum += (x^3) + x;
+		}
+	}
+	{
+		Timer t("Sweeping over GF(3^8) with GF_Packed");
+		const GF_Packed<3, 8>::Table * table = GF_Packed<3, 8>::Table::get(irreducible);
+		for (uint32_t i = 0; i < q; i++) {
+			GF_Packed<3, 8> x = GF_Packed<3, 8>::from_index(table, i);
+			packed_sum += (x^3) + x;
+		}
+	}
+	std::cout << "Both sweeps over GF(3^8) matching";
+	std::cout << (log_sum.to_string() == packed_sum.to_string() ? " succeeded!\n" : " failed!\n");
+}
+
+void time_against_gf_log(size_t iterations) {
+	Polynomial<GF1<5>> irreducible{{1, 4, 2, 3, 3, 4, 1}};
+	uint64_t seed = 7;
+	std::vector<Polynomial<GF1<5>>> polys;
+	for (size_t i = 0; i < iterations; i++) {
+		polys.push_back(index_to_poly<5>(next_random(seed) % 15624 + 1, 6));
+	}
+	GF<5, GF_Log<5>> log_product{irreducible, {{1}}};
+	GF<5, GF_Log<5>> log_sum{irreducible};
+	GF<5, GF_Packed<5, 6>> packed_product{irreducible, {{1}}};
+	GF<5, GF_Packed<5, 6>> packed_sum{irreducible};
+	std::vector<GF<5, GF_Log<5>>> log_elements;
+	std::vector<GF<5, GF_Packed<5, 6>>> packed_elements;
+	for (const auto& poly : polys) {
+		log_elements.emplace_back(irreducible, poly);
+		packed_elements.emplace_back(irreducible, poly);
+	}
+	{
+		Timer t("Multiplying, inverting and adding in GF(5^6) with GF_Log");
+		for (const auto& element : log_elements) {
+			log_product *= element;
+			log_sum += element.inv() + element;
+		}
+	}
+	{
+		Timer t("Multiplying, inverting and adding in GF(5^6) with GF_Packed");
+		for (const auto& element : packed_elements) {
+			packed_product *= element;
+			packed_sum += element.inv() + element;
+		}
+	}
+	std::cout << "GF_Packed and GF_Log results matching";
+	bool succeeded = log_product.to_string() == packed_product.to_string()
+		&& log_sum.to_string() == packed_sum.to_string();
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_against_gf_mat<2, 4>(Polynomial<GF1<2>>{{1, 1, 0, 0, 1}}, "x^4 + x + 1");
+	test_against_gf_mat<3, 3>(Polynomial<GF1<3>>{{1, 2, 0, 1}}, "x^3 + 2x + 1");
+	test_against_gf_mat<5, 2>(Polynomial<GF1<5>>{{3, 0, 1}}, "x^2 + 3");
+	test_against_gf_mat<7, 2>(Polynomial<GF1<7>>{{3, 1, 1}}, "x^2 + x + 3");
+	test_against_gf_mat<11, 1>(Polynomial<GF1<11>>{{3, 1}}, "x + 3");
+	test_random_elements<5, 6>(Polynomial<GF1<5>>{{1, 4, 2, 3, 3, 4, 1}}, "GF(5^6)", 10000);
+	test_random_elements<2, 16>(Polynomial<GF1<2>>{{1, 0, 1, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1}}, "GF(2^16)", 10000);
+	test_random_elements<3, 10>(Polynomial<GF1<3>>{{1, 0, 2, 0, 0, 0, 0, 0, 0, 0, 1}}, "GF(3^10)", 10000);
+	test_random_elements<65521, 1>(Polynomial<GF1<65521>>{{0, 1}}, "GF(65521)", 10000);
+	test_bad_polynomials();
+	time_sweep();
+	time_against_gf_log(200000);
+	return 0;
+}
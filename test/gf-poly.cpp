@@ -0,0 +1,139 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+// Random products, sums and inverses against the matrix representation.
+template<uint32_t p>
+void test_against_gf_mat(const Polynomial<GF1<p>>& irreducible, const char * name, size_t iterations) {
+	size_t n = irreducible.degree();
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		Polynomial<GF1<p>> a_poly = random_poly<p>(n, seed);
+		Polynomial<GF1<p>> b_poly = random_poly<p>(n + 3, seed);
+		GF<p> a_mat{irreducible, a_poly}, b_mat{irreducible, b_poly};
+		GF<p, GF_Poly<p>> a{irreducible, a_poly}, b{irreducible, b_poly};
+		succeeded &= a_mat.to_string() == a.to_string();
+		succeeded &= b_mat.to_string() == b.to_string();
+		succeeded &= (a_mat * b_mat).to_string() == (a * b).to_string();
+		succeeded &= (a_mat + b_mat).to_string() == (a + b).to_string();
+		succeeded &= (a_mat - b_mat).to_string() == (a - b).to_string();
+		succeeded &= (GF1<p>{2} * a_mat).to_string() == (GF1<p>{2} * a).to_string();
+		succeeded &= (a_mat^5).to_string() == (a^5).to_string();
+		if (!(a_mat == zero<GF<p>>(&irreducible))) {
+			succeeded &= a_mat.inv().to_string() == a.inv().to_string();
+			succeeded &= (a_mat^-3).to_string() == (a^-3).to_string();
+		}
+	}
+	std::cout << "GF<" << p << ", GF_Poly<" << p << ">> matching GF<" << p << "> over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// Big enough degrees that the products go through Karatsuba, checked
+// against GF2n.
+template<unsigned int n, uint64_t poly>
+void test_against_gf2n(const char * name, size_t iterations) {
+	using F = GF2n<n, poly>;
+	Polynomial<GF1<2>> irreducible = F::modulus();
+	uint64_t seed = 0x2545f4914f6cdd1d;
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		Polynomial<GF1<2>> a_poly = random_poly<2>(n, seed);
+		Polynomial<GF1<2>> b_poly = random_poly<2>(n, seed);
+		GF<2, F> a_bits{irreducible, a_poly}, b_bits{irreducible, b_poly};
+		GF<2, GF_Poly<2>> a{irreducible, a_poly}, b{irreducible, b_poly};
+		succeeded &= (a_bits * b_bits).to_string() == (a * b).to_string();
+		if (!(a_bits == zero<GF<2, F>>(&irreducible))) {
+			succeeded &= a_bits.inv().to_string() == a.inv().to_string();
+		}
+	}
+	std::cout << "GF_Poly matching GF2n over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// Products in fields big enough to go through Karatsuba, Toom-3 and the NTT,
+// checked against the schoolbook product in the Field_Context. Multiplying
+// doesn't care whether the modulus is irreducible, so it's just random.
+void test_large_degrees() {
+	uint64_t seed = 31337;
+	bool succeeded = true;
+	for (size_t n : {1, 2, 31, 32, 33, 64, 100, 257, 600}) {
+		const Field_Context<7> * context = Field_Context<7>::get(random_monic<7>(n, seed));
+		GF_Poly<7> a{context, random_poly<7>(n, seed)};
+		GF_Poly<7> b{context, random_poly<7>(n, seed)};
+		succeeded &= (a * b).get_val() == context->mul_mod(a.get_val(), b.get_val());
+	}
+	std::cout << "GF_Poly multiplication for large degrees";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void test_different_fields() {
+	bool succeeded = false;
+	GF_Poly<5> a{Polynomial<GF1<5>>{{1, 1, 0, 1}}, Polynomial<GF1<5>>{{1, 2}}};
+	GF_Poly<5> b{Polynomial<GF1<5>>{{2, 0, 1}}, Polynomial<GF1<5>>{{1, 2}}};
+	try {
+		a * b;
+	} catch (const std::domain_error&) {
+		succeeded = true;
+	}
+	// Scaling the irreducible polynomial doesn't change the field.
+	GF_Poly<5> c{Polynomial<GF1<5>>{{2, 2, 0, 2}}, Polynomial<GF1<5>>{{1, 2}}};
+	succeeded &= a * c == c * a;
+	std::cout << "GF_Poly with different irreducible polynomials";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+template<uint32_t p>
+void time_against_gf_mat(const Polynomial<GF1<p>>& irreducible, const std::string& name, size_t iterations) {
+	uint64_t seed = 7;
+	std::vector<GF<p>> mat_elements;
+	std::vector<GF<p, GF_Poly<p>>> poly_elements;
+	for (size_t i = 0; i < iterations; i++) {
+		Polynomial<GF1<p>> poly = random_poly<p>(irreducible.degree(), seed);
+		poly[0] = GF1<p>{1};
+		mat_elements.emplace_back(irreducible, poly);
+		poly_elements.emplace_back(irreducible, poly);
+	}
+	GF<p> mat_product = one<GF<p>>(&irreducible);
+	GF<p, GF_Poly<p>> poly_product = one<GF<p, GF_Poly<p>>>(&irreducible);
+	std::string names[2] = {
+		"Multiplying in " + name + " with GF_Mat",
+		"Multiplying in " + name + " with GF_Poly"
+	};
+	{
+		Timer t(names[0].c_str());
+		for (const auto& element : mat_elements) {
+			mat_product *= element;
+		}
+	}
+	{
+		Timer t(names[1].c_str());
+		for (const auto& element : poly_elements) {
+			poly_product *= element;
+		}
+	}
+	std::cout << "GF_Poly and GF_Mat products matching in " << name;
+	std::cout << (mat_product.to_string() == poly_product.to_string() ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_large_degrees();
+	test_against_gf_mat<2>(Polynomial<GF1<2>>{{1, 1, 0, 1}}, "x^3 + x + 1", 1000);
+	test_against_gf_mat<5>(Polynomial<GF1<5>>{{1, 4, 2, 3, 3, 4, 1}}, "a degree 6 polynomial", 1000);
+	test_against_gf_mat<7>(Polynomial<GF1<7>>{{3, 1}}, "x + 3", 100);
+	test_against_gf2n<64, 0x1b>("x^64 + x^4 + x^3 + x + 1", 300);
+	test_against_gf2n<127, 0x3>("x^127 + x + 1", 100);
+	test_different_fields();
+	time_against_gf_mat<5>(Polynomial<GF1<5>>{{1, 4, 2, 3, 3, 4, 1}}, "GF(5^6)", 20000);
+	time_against_gf_mat<2>(GF2n<64, 0x1b>::modulus(), "GF(2^64)", 50);
+	return 0;
+}
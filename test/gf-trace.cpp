@@ -0,0 +1,167 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+// The trace and norm the slow way, as a + a^p + ... and a^(1 + p + ...).
+template<uint32_t p, typename Repr>
+void test_against_powers(const Polynomial<GF1<p>>& irreducible, const std::string& name, size_t iterations) {
+	using F = GF<p, Repr>;
+	size_t n = irreducible.degree();
+	uint32_t p_power = 1;
+	uint32_t norm_power = 0;
+	for (size_t i = 0; i < n; i++) {
+		norm_power += p_power;
+		p_power *= p;
+	}
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		F a{irreducible, random_poly<p>(n, seed)};
+		F trace = zero<F>(&irreducible);
+		F conjugate = a;
+		for (size_t j = 0; j < n; j++) {
+			trace += conjugate;
+			conjugate = conjugate.pow_u(p);
+		}
+		F norm = a.pow_u(norm_power);
+		succeeded &= trace.is_in_subfield(1) && norm.is_in_subfield(1);
+		succeeded &= trace.template to_subfield<1>() == a.trace();
+		succeeded &= norm.template to_subfield<1>() == a.norm();
+	}
+	succeeded &= zero<F>(&irreducible).norm() == GF1<p>{0};
+	succeeded &= one<F>(&irreducible).norm() == GF1<p>{1};
+	succeeded &= one<F>(&irreducible).trace() == GF1<p>{n % p};
+	std::cout << "Traces and norms in " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// GF2n doesn't have pow_u for exponents this big, so the trace gets checked
+// with squarings instead.
+void test_gf2n(size_t iterations) {
+	using G = GF2n<64, 0x1b>;
+	Polynomial<GF1<2>> irreducible = G::modulus();
+	using F = GF<2, G>;
+	uint64_t seed = 0x2545f4914f6cdd1d;
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		F a{irreducible, random_poly<2>(64, seed)};
+		F trace = zero<F>(&irreducible);
+		F conjugate = a;
+		for (size_t j = 0; j < 64; j++) {
+			trace += conjugate;
+			conjugate *= conjugate;
+		}
+		succeeded &= trace.template to_subfield<1>() == a.trace();
+		succeeded &= F{irreducible, a.get_val().to_poly()}.trace() == GF<2, GF_Poly<2>>{irreducible, a.get_val().to_poly()}.trace();
+		succeeded &= a.norm() == (a == zero<F>(&irreducible) ? GF1<2>{0} : GF1<2>{1});
+	}
+	std::cout << "Traces and norms in GF(2^64) with GF2n";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// a^((p^n - 1) / (p^d - 1)) is always in GF(p^d), and going down to GF(p^d)
+// has to respect sums and products.
+template<uint32_t p, size_t d>
+void test_subfield(const Polynomial<GF1<p>>& irreducible, const std::string& name, size_t iterations) {
+	using F = GF<p, GF_Poly<p>>;
+	const Field_Context<p> * context = Field_Context<p>::get(irreducible);
+	size_t n = irreducible.degree();
+	uint64_t q = 1, q_d = 1;
+	for (size_t i = 0; i < n; i++) {
+		q *= p;
+	}
+	for (size_t i = 0; i < d; i++) {
+		q_d *= p;
+	}
+	uint32_t power = static_cast<uint32_t>((q - 1) / (q_d - 1));
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = context->get_subfield(d).modulus.degree() == d;
+	for (size_t i = 0; i < iterations; i++) {
+		F a = F{irreducible, random_poly<p>(n, seed)}.pow_u(power);
+		F b = F{irreducible, random_poly<p>(n, seed)}.pow_u(power);
+		succeeded &= a.is_in_subfield(d) && b.is_in_subfield(d);
+		GF<p> a_down = a.template to_subfield<d>();
+		GF<p> b_down = b.template to_subfield<d>();
+		succeeded &= (a * b).template to_subfield<d>() == a_down * b_down;
+		succeeded &= (a + b).template to_subfield<d>() == a_down + b_down;
+		succeeded &= context->from_subfield(a_down.get_val().to_poly().to_vector(), d) == a.get_val().get_val();
+	}
+	F x{irreducible, {{0, 1}}};
+	if (d < n) {
+		succeeded &= !x.is_in_subfield(d);
+		try {
+			x.template to_subfield<d>();
+			succeeded = false;
+		} catch (const std::domain_error&) {}
+	}
+	try {
+		x.is_in_subfield(n + 1);
+		succeeded = false;
+	} catch (const std::invalid_argument&) {}
+	std::cout << "Going down to GF(" << p << "^" << d << ") from " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void time_trace(size_t iterations) {
+	Polynomial<GF1<5>> irreducible{{1, 4, 2, 3, 3, 4, 1}};
+	using F = GF<5, GF_Poly<5>>;
+	uint64_t seed = 7;
+	std::vector<F> elements;
+	for (size_t i = 0; i < iterations; i++) {
+		elements.emplace_back(irreducible, random_poly<5>(6, seed));
+	}
+	F slow_trace = zero<F>(&irreducible);
+	F slow_norm = zero<F>(&irreducible);
+	GF1<5> fast_trace{0};
+	GF1<5> fast_norm{0};
+	{
+		Timer t("Traces and norms in GF(5^6) with powers");
+		for (const auto& a : elements) {
+			F conjugate = a;
+			for (size_t j = 0; j < 6; j++) {
+				slow_trace += conjugate;
+				conjugate = conjugate.frobenius();
+			}
+			slow_norm += a.pow_u(3906);
+		}
+	}
+	{
+		Timer t("Traces and norms in GF(5^6) with trace and norm");
+		for (const auto& a : elements) {
+			fast_trace += a.trace();
+			fast_norm += a.norm();
+		}
+	}
+	std::cout << "Both ways of taking traces and norms matching";
+	bool succeeded = slow_trace.to_subfield<1>() == fast_trace
+		&& slow_norm.to_subfield<1>() == fast_norm;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	Polynomial<GF1<5>> gf5_6{{1, 4, 2, 3, 3, 4, 1}};
+	test_against_powers<5, GF_Mat<5>>(gf5_6, "GF(5^6) with GF_Mat", 50);
+	test_against_powers<5, GF_Poly<5>>(gf5_6, "GF(5^6) with GF_Poly", 200);
+	test_against_powers<5, GF_Log<5>>(gf5_6, "GF(5^6) with GF_Log", 200);
+	test_against_powers<5, GF_Packed<5, 6>>(gf5_6, "GF(5^6) with GF_Packed", 200);
+	test_against_powers<5, GF_Normal<5>>(gf5_6, "GF(5^6) with GF_Normal", 200);
+	test_against_powers<2, GF_Packed<2, 4>>(Polynomial<GF1<2>>{{1, 1, 0, 0, 1}}, "GF(2^4) with GF_Packed", 50);
+	test_against_powers<7, GF_Poly<7>>(Polynomial<GF1<7>>{{3, 1}}, "GF(7) with GF_Poly", 20);
+	test_against_powers<65521, GF_Poly<65521>>(Polynomial<GF1<65521>>{{65504, 0, 1}}, "GF(65521^2) with GF_Poly", 200);
+	test_gf2n(100);
+	test_subfield<5, 2>(gf5_6, "GF(5^6)", 100);
+	test_subfield<5, 3>(gf5_6, "GF(5^6)", 100);
+	test_subfield<5, 6>(gf5_6, "GF(5^6)", 10);
+	test_subfield<2, 4>(Polynomial<GF1<2>>{{1, 1, 0, 1, 1, 0, 0, 0, 1}}, "GF(2^8)", 100);
+	time_trace(20000);
+	return 0;
+}
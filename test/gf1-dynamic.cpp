@@ -0,0 +1,167 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+// Every operation should give exactly what GF1<p> gives.
+template<uint32_t p>
+void test_against_gf1(size_t iterations) {
+	GF1_Context ctx{p};
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		uint64_t x = next_random(seed);
+		uint64_t y = next_random(seed);
+		int pow = static_cast<int>(next_random(seed) % 2001) - 1000;
+		GF1<p> a{x}, b{y};
+		GF1_Dyn c{ctx, x}, d{ctx, y};
+		succeeded &= (c + d).get_val() == (a + b).get_val();
+		succeeded &= (c - d).get_val() == (a - b).get_val();
+		succeeded &= (-c).get_val() == (-a).get_val();
+		succeeded &= (c * d).get_val() == (a * b).get_val();
+		if (b.get_val() != 0) {
+			succeeded &= (c / d).get_val() == (a / b).get_val();
+			succeeded &= (d^pow).get_val() == (b^pow).get_val();
+		}
+	}
+	std::cout << "GF1_Dyn matching GF1<" << p << ">";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void test_matrix_inverse(uint32_t p, size_t mat_size) {
+	auto ctx = std::make_shared<GF1_Context>(p);
+	uint64_t seed = 12345;
+	Matrix<GF1_Dyn> m{zero<GF1_Dyn>(ctx.get()), mat_size, ctx};
+	for (size_t row = 0; row < mat_size; row++) {
+		for (size_t col = 0; col < mat_size; col++) {
+			m(row, col) = GF1_Dyn{ctx.get(), next_random(seed)};
+		}
+	}
+	Matrix<GF1_Dyn> identity{zero<GF1_Dyn>(ctx.get()), mat_size, ctx};
+	identity.to_identity();
+	std::cout << "Inverting a " << mat_size << "x" << mat_size << " matrix over GF1_Dyn(" << p << ")";
+	std::cout << (m * m.inv() == identity ? " succeeded!\n" : " failed!\n");
+}
+
+// (x + 1)(x - 1) = x^2 - 1, where the polynomials mix elements that have a
+// context with ones that don't.
+void test_polynomial() {
+	GF1_Context ctx{13};
+	Polynomial<GF1_Dyn> a{{GF1_Dyn{ctx, 1}, 1}};
+	Polynomial<GF1_Dyn> b{{GF1_Dyn{ctx, 12}, 1}};
+	Polynomial<GF1_Dyn> expected{{GF1_Dyn{ctx, 12}, 0, 1}};
+	Polynomial<GF1_Dyn> product = a * b;
+	bool succeeded = product.degree() == 2;
+	for (size_t i = 0; i <= 2; i++) {
+		succeeded &= product[i] == expected[i];
+	}
+	std::cout << "Multiplying polynomials over GF1_Dyn(13)";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// The whole point: one type, lots of primes picked at runtime. Fermat's
+// little theorem should hold for all of them.
+void test_prime_sweep() {
+	size_t num_primes = 0;
+	bool succeeded = true;
+	uint64_t seed = 42;
+	for (uint32_t p = 4294967295u; num_primes < 200; p -= 2) {
+		if (!is_prime(p)) {
+			continue;
+		}
+		num_primes++;
+		GF1_Context ctx{p};
+		GF1_Dyn a{ctx, next_random(seed) % (p - 1) + 1};
+		succeeded &= a.pow_u(p - 1) == one<GF1_Dyn>(&ctx);
+		succeeded &= a * a.inv() == one<GF1_Dyn>(&ctx);
+	}
+	std::cout << "Fermat's little theorem for " << num_primes << " primes near 2^32";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void test_errors() {
+	bool succeeded = true;
+	try {
+		GF1_Context ctx{4294967295u};
+		succeeded = false;
+	} catch (const std::invalid_argument&) {}
+	for (uint32_t modulus : {0u, 1u}) {
+		try {
+			GF1_Context ctx{modulus};
+			succeeded = false;
+		} catch (const std::invalid_argument&) {}
+	}
+	GF1_Context ctx_5{5}, ctx_7{7};
+	try {
+		GF1_Dyn{ctx_5, 1} + GF1_Dyn{ctx_7, 1};
+		succeeded = false;
+	} catch (const std::domain_error&) {}
+	try {
+		GF1_Dyn{1} - GF1_Dyn{2};
+		succeeded = false;
+	} catch (const std::domain_error&) {}
+	GF1_Context other_ctx_5{5};
+	succeeded &= GF1_Dyn{ctx_5, 3} + GF1_Dyn{other_ctx_5, 4} == GF1_Dyn{ctx_5, 2};
+	std::cout << "Mismatched contexts and bad moduli";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// Should be within a small factor of GF1<p>.
+template<uint32_t p>
+void time_against_gf1(size_t mat_size) {
+	auto ctx = std::make_shared<GF1_Context>(p);
+	uint64_t seed = 777;
+	Matrix<GF1<p, Barrett_Reduction>> a{GF1<p, Barrett_Reduction>{0}, mat_size};
+	Matrix<GF1_Dyn> b{zero<GF1_Dyn>(ctx.get()), mat_size, ctx};
+	for (size_t row = 0; row < mat_size; row++) {
+		for (size_t col = 0; col < mat_size; col++) {
+			uint64_t v = next_random(seed);
+			a(row, col) = v;
+			b(row, col) = GF1_Dyn{ctx.get(), v};
+		}
+	}
+	std::string gf1_name = "Multiplying " + std::to_string(mat_size) + "x" + std::to_string(mat_size) + " matrices over GF1<" + std::to_string(p) + ", Barrett_Reduction>";
+	std::string dyn_name = "Multiplying " + std::to_string(mat_size) + "x" + std::to_string(mat_size) + " matrices over GF1_Dyn(" + std::to_string(p) + ")";
+	Matrix<GF1<p, Barrett_Reduction>> a_squared{a};
+	Matrix<GF1_Dyn> b_squared{b};
+	{
+		Timer t(gf1_name.c_str());
+		a_squared = a * a;
+	}
+	{
+		Timer t(dyn_name.c_str());
+		b_squared = b * b;
+	}
+	bool succeeded = true;
+	for (size_t row = 0; row < mat_size; row++) {
+		for (size_t col = 0; col < mat_size; col++) {
+			succeeded &= a_squared(row, col).get_val() == b_squared(row, col).get_val();
+		}
+	}
+	std::cout << "GF1_Dyn and GF1<" << p << "> matrix products matching";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_against_gf1<2>(1000);
+	test_against_gf1<13>(10000);
+	test_against_gf1<65521>(10000);
+	test_against_gf1<4294967291>(10000);
+	test_matrix_inverse(251, 32);
+	test_matrix_inverse(4294967291u, 64);
+	test_polynomial();
+	test_prime_sweep();
+	test_errors();
+	time_against_gf1<65521>(128);
+	time_against_gf1<4294967291>(128);
+	return 0;
+}
@@ -0,0 +1,119 @@
+#include "../include/gf1-kernels.hpp"
+#include "../include/matrix.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+template<typename T>
+std::vector<T> random_elements(size_t n, uint64_t& seed) {
+	std::vector<T> out;
+	out.reserve(n);
+	for (size_t i = 0; i < n; i++) {
+		out.emplace_back(next_random(seed));
+	}
+	return out;
+}
+
+// Compares every kernel against doing the same thing one element at a time.
+template<uint32_t p, template<uint32_t> typename Reduction>
+bool test_kernels_for_size(size_t n, uint64_t& seed) {
+	using GF1s = GF1<p, Reduction>;
+	auto a = random_elements<GF1s>(n, seed);
+	auto b = random_elements<GF1s>(n, seed);
+	GF1s c = random_elements<GF1s>(1, seed)[0];
+	std::vector<GF1s> sum(n), diff(n), scaled{a}, axpy_out{a};
+	kernels::add<GF1s>(sum, a, b);
+	kernels::sub<GF1s>(diff, a, b);
+	kernels::scale<GF1s>(scaled, c);
+	kernels::axpy<GF1s>(axpy_out, c, b);
+	GF1s dot = kernels::dot<GF1s>(a, b);
+	GF1s expected_dot = 0;
+	bool succeeded = true;
+	for (size_t i = 0; i < n; i++) {
+		expected_dot += a[i] * b[i];
+		succeeded &= sum[i] == a[i] + b[i];
+		succeeded &= diff[i] == a[i] - b[i];
+		succeeded &= scaled[i] == a[i] * c;
+		succeeded &= axpy_out[i] == a[i] + c * b[i];
+	}
+	succeeded &= dot == expected_dot;
+	return succeeded;
+}
+
+// GF1_Accumulator should give the same thing as reducing after every step.
+template<uint32_t p, template<uint32_t> typename Reduction>
+bool test_accumulator(size_t n, uint64_t& seed) {
+	using GF1s = GF1<p, Reduction>;
+	auto a = random_elements<GF1s>(n, seed);
+	auto b = random_elements<GF1s>(n, seed);
+	GF1s initial = random_elements<GF1s>(1, seed)[0];
+	GF1_Accumulator<p, Reduction> acc{initial};
+	GF1s expected = initial;
+	for (size_t i = 0; i < n; i++) {
+		acc.add_product(a[i], b[i]);
+		expected += a[i] * b[i];
+	}
+	return acc.result() == expected;
+}
+
+template<uint32_t p, template<uint32_t> typename Reduction>
+void test_kernels(const char * policy_name) {
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t n : {0, 1, 7, 15, 16, 17, 31, 32, 33, 100, 1000, 20000}) {
+		succeeded &= test_kernels_for_size<p, Reduction>(n, seed);
+		succeeded &= test_accumulator<p, Reduction>(n, seed);
+	}
+	std::cout << "Kernels and accumulator for GF1<" << p << ", " << policy_name << ">";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+template<uint32_t p>
+void test_all_policies() {
+	test_kernels<p, Modulo_Reduction>("Modulo_Reduction");
+	test_kernels<p, Barrett_Reduction>("Barrett_Reduction");
+	test_kernels<p, Montgomery_Reduction>("Montgomery_Reduction");
+}
+
+// Row operations are what Matrix::inv spends its time on, so make sure the
+// inverse still comes out right, and time it while we're here.
+template<uint32_t p>
+void test_matrix_inverse(size_t mat_size) {
+	std::string name = "Inverting a " + std::to_string(mat_size) + "x" + std::to_string(mat_size) + " matrix over GF(" + std::to_string(p) + ")";
+	uint64_t seed = 12345;
+	Matrix<GF1<p>> m{GF1<p>{0}, mat_size};
+	for (size_t row = 0; row < mat_size; row++) {
+		auto values = random_elements<GF1<p>>(mat_size, seed);
+		for (size_t col = 0; col < mat_size; col++) {
+			m(row, col) = values[col];
+		}
+	}
+	Matrix<GF1<p>> identity{GF1<p>{0}, mat_size};
+	identity.to_identity();
+	bool succeeded;
+	{
+		Timer t(name.c_str());
+		succeeded = m * m.inv() == identity;
+	}
+	std::cout << name << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_all_policies<13>();
+	test_all_policies<251>();
+	test_all_policies<65521>();
+	test_all_policies<4294967291>();
+	test_matrix_inverse<13>(64);
+	test_matrix_inverse<251>(128);
+	test_matrix_inverse<65521>(128);
+	test_matrix_inverse<4294967291>(128);
+	return 0;
+}
@@ -0,0 +1,143 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+template<typename GF1s>
+std::vector<GF1s> naive_product(const Polynomial<GF1s>& a, const Polynomial<GF1s>& b) {
+	const auto& a_coeffs = a.get_coeffs();
+	const auto& b_coeffs = b.get_coeffs();
+	if (a_coeffs.empty() || b_coeffs.empty()) {
+		return {};
+	}
+	std::vector<GF1s> out(a_coeffs.size() + b_coeffs.size() - 1, GF1s{0});
+	for (size_t i = 0; i < a_coeffs.size(); i++) {
+		for (size_t j = 0; j < b_coeffs.size(); j++) {
+			out[i + j] += a_coeffs[i] * b_coeffs[j];
+		}
+	}
+	while (!out.empty() && out.back() == GF1s{0}) {
+		out.pop_back();
+	}
+	return out;
+}
+
+// Sizes around powers of two, so products land just under, on, and just
+// over a transform size, plus lopsided ones and squares.
+template<uint32_t p, template<uint32_t> typename Reduction = Modulo_Reduction>
+void test_against_schoolbook(const std::string& name) {
+	using GF1s = GF1<p, Reduction>;
+	const size_t sizes[] = {1, 50, 64, 65, 127, 128, 129, 192, 200, 255, 256, 257, 300, 513, 1100};
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t a_size : sizes) {
+		for (size_t b_size : sizes) {
+			Polynomial<GF1s> a = random_full_poly<GF1s>(a_size, seed, p);
+			Polynomial<GF1s> b = random_full_poly<GF1s>(b_size, seed, p);
+			succeeded &= (a * b).to_vector() == naive_product(a, b);
+		}
+		Polynomial<GF1s> a = random_full_poly<GF1s>(a_size, seed, p);
+		succeeded &= (a * a).to_vector() == naive_product(a, a);
+	}
+	std::cout << "NTT products matching schoolbook over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// Every coefficient at p - 1 makes the integer coefficients of the product
+// as big as they can get, which is the worst case for the CRT.
+template<uint32_t p>
+void test_largest_coefficients(size_t n) {
+	std::vector<GF1<p>> coeffs(n, GF1<p>{p - 1});
+	Polynomial<GF1<p>> a{coeffs};
+	std::vector<GF1<p>> product = (a * a).to_vector();
+	bool succeeded = product.size() == 2 * n - 1;
+	for (size_t k = 0; k < product.size() && succeeded; k++) {
+		uint64_t terms = std::min(k, 2 * n - 2 - k) + 1;
+		succeeded = product[k] == GF1<p>{terms};
+	}
+	std::cout << "Squaring (p - 1)(1 + x + ... + x^" << n - 1 << ") over GF(" << p << ")";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+template<uint32_t p>
+bool check_root_of_unity(uint64_t n) {
+	GF1<p> root = root_of_unity<p>(n);
+	if (!(root.pow_u(static_cast<uint32_t>(n)) == GF1<p>{1})) {
+		return false;
+	}
+	// Primitive means no smaller power that divides n gets to one.
+	for (uint64_t d = 1; d < n; d++) {
+		if (n % d == 0 && root.pow_u(static_cast<uint32_t>(d)) == GF1<p>{1}) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void test_roots_of_unity() {
+	bool succeeded = primitive_root(998244353) == 3 && primitive_root(65537) == 3;
+	succeeded &= primitive_root(2) == 1 && primitive_root(7) == 3;
+	succeeded &= check_root_of_unity<998244353>(1 << 10) && check_root_of_unity<998244353>(119);
+	succeeded &= check_root_of_unity<2013265921>(1 << 20) && check_root_of_unity<2013265921>(15);
+	succeeded &= check_root_of_unity<65521>(65520) && check_root_of_unity<7>(6);
+	succeeded &= two_adicity(998244353 - 1) == 23 && two_adicity(2013265921 - 1) == 27;
+	try {
+		root_of_unity<998244353>(1 << 24);
+		succeeded = false;
+	} catch (const std::domain_error&) {}
+	try {
+		root_of_unity<65521>(0);
+		succeeded = false;
+	} catch (const std::invalid_argument&) {}
+	std::cout << "Roots of unity";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+template<uint32_t p>
+void time_products(size_t n, size_t iterations) {
+	uint64_t seed = 7;
+	Polynomial<GF1<p>> a = random_full_poly<GF1<p>>(n, seed, p);
+	Polynomial<GF1<p>> b = random_full_poly<GF1<p>>(n, seed, p);
+	std::vector<GF1<p>> slow, fast;
+	std::string names[2] = {
+		"Multiplying polynomials with " + std::to_string(n) + " coefficients over GF(" + std::to_string(p) + ") with schoolbook",
+		"Multiplying polynomials with " + std::to_string(n) + " coefficients over GF(" + std::to_string(p) + ") with operator*"
+	};
+	{
+		Timer t(names[0].c_str());
+		for (size_t i = 0; i < iterations; i++) {
+			slow = naive_product(a, b);
+		}
+	}
+	{
+		Timer t(names[1].c_str());
+		for (size_t i = 0; i < iterations; i++) {
+			fast = (a * b).to_vector();
+		}
+	}
+	std::cout << "Both ways of multiplying matching";
+	std::cout << (slow == fast ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_roots_of_unity();
+	test_against_schoolbook<998244353>("GF(998244353)");
+	test_against_schoolbook<2013265921, Montgomery_Reduction>("GF(2^31 - 2^27 + 1) in Montgomery form");
+	test_against_schoolbook<65537, Barrett_Reduction>("GF(65537) with Barrett reduction");
+	test_against_schoolbook<65521>("GF(65521) through the CRT");
+	test_against_schoolbook<4294967291>("GF(2^32 - 5) through the CRT");
+	test_against_schoolbook<2>("GF(2) through the CRT");
+	test_largest_coefficients<4294967291>(3000);
+	test_largest_coefficients<998244353>(3000);
+	time_products<998244353>(10000, 3);
+	time_products<4294967291>(10000, 3);
+	return 0;
+}
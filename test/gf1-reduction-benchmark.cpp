@@ -0,0 +1,76 @@
+#include "../include/finite-field.hpp"
+#include "../include/matrix.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+
+using namespace cherry;
+
+// Fills a matrix with xorshift garbage so the compiler can't fold anything.
+template<typename T>
+void fill_matrix(Matrix<T>& m, uint32_t seed) {
+	for (size_t row = 0; row < m.get_num_rows(); row++) {
+		for (size_t col = 0; col < m.get_num_cols(); col++) {
+			m(row, col) = seed;
+			seed ^= seed << 13;
+			seed ^= seed >> 17;
+			seed ^= seed << 5;
+		}
+	}
+}
+
+template<uint32_t p, template<uint32_t> typename Reduction>
+uint64_t benchmark_policy(const char * policy_name) {
+	using GF1s = GF1<p, Reduction>;
+	const size_t mat_size = 64;
+	const uint32_t num_pows = 200000;
+	std::string name = std::string{"GF1<"} + std::to_string(p) + ", " + policy_name + ">";
+	uint64_t checksum = 0;
+	{
+		std::string timer_name = name + " matrix multiply";
+		Timer t(timer_name.c_str());
+		Matrix<GF1s> a{GF1s{0}, mat_size};
+		Matrix<GF1s> b{GF1s{0}, mat_size};
+		fill_matrix(a, 0xdeadbeef);
+		fill_matrix(b, 0x12345678);
+		Matrix<GF1s> c = a * b;
+		c = c * a;
+		checksum += c.trace().get_val();
+	}
+	{
+		std::string timer_name = name + " pow_u";
+		Timer t(timer_name.c_str());
+		GF1s acc = 1;
+		for (uint32_t i = 2; i < num_pows; i++) {
+			acc += GF1s{i}.pow_u(i * 2654435761u);
+		}
+		checksum += acc.get_val();
+	}
+	return checksum;
+}
+
+template<uint32_t p>
+void benchmark_all_policies() {
+	std::cout << "p = " << p << " (" << sizeof(MAX_TYPE(p)) << " byte storage)\n";
+	uint64_t modulo = benchmark_policy<p, Modulo_Reduction>("Modulo_Reduction");
+	uint64_t barrett = benchmark_policy<p, Barrett_Reduction>("Barrett_Reduction");
+	uint64_t montgomery = benchmark_policy<p, Montgomery_Reduction>("Montgomery_Reduction");
+	if (modulo == barrett && modulo == montgomery) {
+		std::cout << "All reduction policies agree for p = " << p << "\n\n";
+	} else {
+		std::cout << "Reduction policies disagree for p = " << p << ": "
+			<< modulo << " " << barrett << " " << montgomery << "\n\n";
+	}
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	benchmark_all_policies<13>();
+	benchmark_all_policies<251>();
+	benchmark_all_policies<65521>();
+	benchmark_all_policies<4294967291>();
+	return 0;
+}
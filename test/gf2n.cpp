@@ -0,0 +1,154 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+template<typename T>
+T random_element(uint64_t& seed) {
+	typename T::Limbs bits;
+	for (auto& limb : bits) {
+		limb = next_random(seed);
+	}
+	return T{bits};
+}
+
+Polynomial<GF1<2>> bits_to_poly(uint64_t bits, size_t n) {
+	std::vector<GF1<2>> coeffs;
+	for (size_t i = 0; i < n; i++) {
+		coeffs.emplace_back((bits >> i) & 1);
+	}
+	return coeffs;
+}
+
+// Every product and inverse in GF(2^8) against the matrix representation.
+void test_against_gf_mat() {
+	using AES = GF2n<8, 0x1b>;
+	Polynomial<GF1<2>> irreducible = AES::modulus();
+	bool succeeded = true;
+	std::vector<GF<2>> mat_elements;
+	std::vector<GF<2, AES>> gf2n_elements;
+	for (uint64_t i = 0; i < 256; i++) {
+		mat_elements.emplace_back(irreducible, bits_to_poly(i, 8));
+		gf2n_elements.emplace_back(irreducible, bits_to_poly(i, 8));
+		succeeded &= mat_elements.back().to_string() == gf2n_elements.back().to_string();
+	}
+	for (size_t i = 0; i < 256; i++) {
+		for (size_t j = 0; j < 256; j += 7) {
+			succeeded &= (mat_elements[i] * mat_elements[j]).to_string() == (gf2n_elements[i] * gf2n_elements[j]).to_string();
+			succeeded &= (mat_elements[i] + mat_elements[j]).to_string() == (gf2n_elements[i] + gf2n_elements[j]).to_string();
+		}
+		if (i != 0) {
+			succeeded &= mat_elements[i].inv().to_string() == gf2n_elements[i].inv().to_string();
+		}
+	}
+	// 0x53 and 0xca are inverses in the AES field.
+	succeeded &= AES{{0x53}} * AES{{0xca}} == AES{{1}};
+	std::cout << "GF<2, GF2n<8, 0x1b>> matching GF<2>";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+template<unsigned int n, uint64_t poly>
+void test_field(const char * name, size_t iterations) {
+	using F = GF2n<n, poly>;
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	F one_v = one<F>();
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		F a = random_element<F>(seed);
+		F b = random_element<F>(seed);
+		F c = random_element<F>(seed);
+		succeeded &= a * (b + c) == a * b + a * c;
+		succeeded &= (a * b) * c == a * (b * c);
+		succeeded &= (a + b) * (a + b) == a * a + b * b;
+		if (!(a == zero<F>())) {
+			succeeded &= a * a.inv() == one_v;
+			succeeded &= (a^-3) * (a^3) == one_v;
+		}
+		// The Frobenius map has order n.
+		F frobenius = a;
+		for (unsigned int j = 0; j < n; j++) {
+			frobenius *= frobenius;
+		}
+		succeeded &= frobenius == a;
+	}
+	std::cout << "GF2n over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void test_portable_clmul() {
+	uint64_t seed = 42;
+	bool succeeded = true;
+	for (size_t i = 0; i < 100000; i++) {
+		uint64_t a = next_random(seed);
+		uint64_t b = next_random(seed);
+		uint64_t lo, hi, portable_lo, portable_hi;
+		clmul::mul_64(a, b, lo, hi);
+		clmul::portable_64(a, b, portable_lo, portable_hi);
+		succeeded &= lo == portable_lo && hi == portable_hi;
+	}
+	uint64_t lo, hi;
+	clmul::portable_64(~uint64_t{0}, ~uint64_t{0}, lo, hi);
+	succeeded &= lo == 0x5555555555555555 && hi == 0x5555555555555555;
+	std::cout << "Portable carry-less multiply";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void test_wrong_modulus() {
+	bool succeeded = false;
+	try {
+		GF<2, GF2n<8, 0x1b>> a{bits_to_poly(0x11d, 9)};
+	} catch (const std::invalid_argument&) {
+		succeeded = true;
+	}
+	std::cout << "GF2n with the wrong modulus";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void time_against_gf_mat(size_t iterations) {
+	using F = GF2n<32, 0x8d>;
+	Polynomial<GF1<2>> irreducible = F::modulus();
+	uint64_t seed = 7;
+	GF<2> mat_product{irreducible, {{1}}};
+	GF<2, F> gf2n_product{irreducible, {{1}}};
+	std::vector<Polynomial<GF1<2>>> polys;
+	for (size_t i = 0; i < iterations; i++) {
+		polys.push_back(bits_to_poly(next_random(seed) & 0xffffffff, 32));
+	}
+	{
+		Timer t("Multiplying in GF(2^32) with GF_Mat");
+		for (const auto& poly : polys) {
+			mat_product *= GF<2>{irreducible, poly};
+		}
+	}
+	{
+		Timer t("Multiplying in GF(2^32) with GF2n");
+		for (const auto& poly : polys) {
+			gf2n_product *= GF<2, F>{irreducible, poly};
+		}
+	}
+	std::cout << "GF2n and GF_Mat products matching";
+	std::cout << (mat_product.to_string() == gf2n_product.to_string() ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_portable_clmul();
+	test_against_gf_mat();
+	test_field<8, 0x1b>("x^8 + x^4 + x^3 + x + 1", 1000);
+	test_field<16, 0x7205>("x^16 + x^14 + x^13 + x^12 + x^9 + x^2 + 1", 1000);
+	test_field<63, 0x3>("x^63 + x + 1", 1000);
+	test_field<64, 0x1b>("x^64 + x^4 + x^3 + x + 1", 1000);
+	test_field<64, 0xb610a9f7f9270f4f>("a dense degree 64 polynomial", 1000);
+	test_field<127, 0x3>("x^127 + x + 1", 300);
+	test_field<128, 0x87>("x^128 + x^7 + x^2 + x + 1", 300);
+	test_wrong_modulus();
+	time_against_gf_mat(200);
+	return 0;
+}
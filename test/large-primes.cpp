@@ -0,0 +1,173 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+template<size_t N>
+Big_Uint<N> random_big(uint64_t& seed) {
+	Big_Uint<N> out;
+	for (auto& limb : out.limbs) {
+		limb = next_random(seed);
+	}
+	return out;
+}
+
+// Checks GF1_64 against doing everything with 128-bit integers and %.
+template<uint64_t p>
+void test_gf1_64(size_t iterations) {
+	using u128 = unsigned __int128;
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		uint64_t x = next_random(seed) % p;
+		uint64_t y = next_random(seed) % p;
+		GF1_64<p> a = x, b = y;
+		succeeded &= (a + b).get_val() == static_cast<uint64_t>((static_cast<u128>(x) + y) % p);
+		succeeded &= (a - b).get_val() == static_cast<uint64_t>((static_cast<u128>(x) + p - y) % p);
+		succeeded &= (a * b).get_val() == static_cast<uint64_t>(static_cast<u128>(x) * y % p);
+		succeeded &= (-a).get_val() == (p - x) % p;
+		if (y != 0) {
+			succeeded &= (a / b) * b == a;
+			succeeded &= (b^-5) * (b^5) == GF1_64<p>{1};
+		}
+	}
+	std::cout << "GF1_64<" << p << ">";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// With p small enough, GF1_Big has to agree with GF1_64 no matter how many
+// limbs it uses.
+template<uint64_t p, size_t N>
+void test_gf1_big_against_gf1_64(size_t iterations) {
+	constexpr Big_Uint<N> big_p{p};
+	uint64_t seed = 12345;
+	bool succeeded = true;
+	for (size_t i = 0; i < iterations; i++) {
+		uint64_t x = next_random(seed) % p;
+		uint64_t y = next_random(seed) % p;
+		GF1_64<p> a = x, b = y;
+		GF1_Big<N, big_p> c = x, d = y;
+		succeeded &= (c + d).get_val() == Big_Uint<N>{(a + b).get_val()};
+		succeeded &= (c - d).get_val() == Big_Uint<N>{(a - b).get_val()};
+		succeeded &= (c * d).get_val() == Big_Uint<N>{(a * b).get_val()};
+		succeeded &= (-c).get_val() == Big_Uint<N>{(-a).get_val()};
+		if (y != 0) {
+			succeeded &= d.inv().get_val() == Big_Uint<N>{b.inv().get_val()};
+		}
+	}
+	std::cout << "GF1_Big<" << N << ", " << p << "> matching GF1_64";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// Field axioms and Fermat's little theorem for primes that don't fit in 64
+// bits.
+template<size_t N, Big_Uint<N> p>
+void test_gf1_big(const char * name, size_t iterations) {
+	using GF = GF1_Big<N, p>;
+	Big_Uint<N> p_minus_1 = p;
+	p_minus_1.limbs[0] -= 1;
+	uint64_t seed = 777;
+	bool succeeded = true;
+	GF one_v = 1;
+	for (size_t i = 0; i < iterations; i++) {
+		GF a = random_big<N>(seed);
+		GF b = random_big<N>(seed);
+		GF c = random_big<N>(seed);
+		succeeded &= a * (b + c) == a * b + a * c;
+		succeeded &= (a - b) + b == a;
+		succeeded &= a + (-a) == GF{0};
+		succeeded &= a * a.inv() == one_v;
+		succeeded &= a.pow_big(p_minus_1) == one_v;
+		succeeded &= (a^3) == a * a * a;
+		succeeded &= (a^-2) * a * a == one_v;
+	}
+	// -1 should print as p - 1.
+	succeeded &= (-one_v).get_val() == p_minus_1;
+	succeeded &= GF::is_probable_prime();
+	std::cout << "GF1_Big over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+template<size_t N, Big_Uint<N> p>
+void test_matrix_and_polynomial(const char * name, size_t mat_size) {
+	using GF = GF1_Big<N, p>;
+	uint64_t seed = 4242;
+	Matrix<GF> m{GF{0}, mat_size};
+	for (size_t row = 0; row < mat_size; row++) {
+		for (size_t col = 0; col < mat_size; col++) {
+			m(row, col) = GF{random_big<N>(seed)};
+		}
+	}
+	Matrix<GF> identity{GF{0}, mat_size};
+	identity.to_identity();
+	bool succeeded;
+	std::string timer_name = "Inverting a " + std::to_string(mat_size) + "x" + std::to_string(mat_size) + " matrix over " + name;
+	{
+		Timer t(timer_name.c_str());
+		succeeded = m * m.inv() == identity;
+	}
+	std::cout << timer_name << (succeeded ? " succeeded!\n" : " failed!\n");
+
+	// (x + a)(x - a) = x^2 - a^2
+	GF a{random_big<N>(seed)};
+	Polynomial<GF> plus{{a, 1}};
+	Polynomial<GF> minus{{-a, 1}};
+	Polynomial<GF> product = plus * minus;
+	succeeded = product.degree() == 2 && product[0] == -(a * a) && product[1] == GF{0} && product[2] == GF{1};
+	std::cout << "Multiplying polynomials over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void test_big_uint() {
+	auto from_hex = Big_Uint<2>::from_string("0x1_0000000000000000");
+	auto from_dec = Big_Uint<2>::from_string("18446744073709551616");
+	bool succeeded = from_hex == from_dec && from_hex.limbs[1] == 1 && from_hex.limbs[0] == 0;
+	succeeded &= from_dec.to_string() == "18446744073709551616";
+	try {
+		Big_Uint<1>::from_string("18446744073709551616");
+		succeeded = false;
+	} catch (const std::length_error&) {}
+	// 2^128 + 1 = 59649589127497217 * 5704689200685129054721 gets past the
+	// compile time check, but not the runtime one.
+	constexpr auto fermat_7 = Big_Uint<3>::from_string("340282366920938463463374607431768211457");
+	succeeded &= !GF1_Big<3, fermat_7>::is_probable_prime();
+	std::cout << "Big_Uint parsing and printing";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+constexpr auto mersenne_127 = Big_Uint<2>::from_string("0x7fffffffffffffffffffffffffffffff");
+constexpr auto p_256 = Big_Uint<4>::from_string(
+	"0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff"
+);
+constexpr auto curve_25519 = Big_Uint<4>::from_string(
+	"0x7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed"
+);
+// 2^512 - 569, the largest 512-bit prime.
+constexpr auto largest_512 = Big_Uint<8>::from_string(
+	"0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff"
+	"fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffdc7"
+);
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_big_uint();
+	test_gf1_64<4294967311>(10000);
+	test_gf1_64<1000000000000000003>(10000);
+	test_gf1_64<18446744073709551557u>(10000);
+	test_gf1_big_against_gf1_64<18446744073709551557u, 1>(2000);
+	test_gf1_big_against_gf1_64<18446744073709551557u, 2>(2000);
+	test_gf1_big_against_gf1_64<1000000000000000003, 3>(2000);
+	test_gf1_big<2, mersenne_127>("2^127 - 1", 200);
+	test_gf1_big<4, p_256>("the P-256 prime", 100);
+	test_gf1_big<4, curve_25519>("2^255 - 19", 100);
+	test_gf1_big<8, largest_512>("2^512 - 569", 20);
+	test_matrix_and_polynomial<4, p_256>("the P-256 prime", 32);
+	return 0;
+}
@@ -0,0 +1,190 @@
+#include "../include/gf.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+
+using namespace cherry;
+
+// SplitMix64. Xorshift is linear over GF(2), so a matrix made from its bits
+// never has rank more than 64.
+uint64_t next_splitmix(uint64_t& seed) {
+	seed += 0x9e3779b97f4a7c15;
+	uint64_t z = seed;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+	return z ^ (z >> 31);
+}
+
+Matrix<GF1<2>> random_matrix(size_t rows, size_t cols, uint64_t& seed) {
+	Matrix<GF1<2>> out{GF1<2>{0}, rows, cols};
+	for (size_t row = 0; row < rows; row++) {
+		for (size_t col = 0; col < cols; col++) {
+			out(row, col) = next_splitmix(seed) & 1;
+		}
+	}
+	return out;
+}
+
+// Lower unitriangular times upper unitriangular, shuffled a bit, is always
+// invertible.
+Matrix<GF1<2>> random_invertible(size_t n, uint64_t& seed) {
+	Matrix<GF1<2>> lower = random_matrix(n, n, seed);
+	Matrix<GF1<2>> upper = random_matrix(n, n, seed);
+	for (size_t row = 0; row < n; row++) {
+		for (size_t col = 0; col < n; col++) {
+			if (col > row) {
+				lower(row, col) = 0;
+			} else if (col < row) {
+				upper(row, col) = 0;
+			}
+		}
+		lower(row, row) = 1;
+		upper(row, row) = 1;
+	}
+	Matrix<GF1<2>> out = lower * upper;
+	for (size_t row = 0; row + 1 < n; row += 3) {
+		out.ero_swap(row, row + 1);
+	}
+	return out;
+}
+
+bool matches(const Matrix_GF2& packed, const Matrix<GF1<2>>& unpacked) {
+	return packed == Matrix_GF2{unpacked} && packed.to_matrix() == unpacked;
+}
+
+void test_arithmetic() {
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t n : {1, 7, 8, 9, 63, 64, 65, 100, 130}) {
+		auto a = random_matrix(n, n + 3, seed);
+		auto b = random_matrix(n, n + 3, seed);
+		auto c = random_matrix(n + 3, 2 * n + 1, seed);
+		Matrix_GF2 pa{a}, pb{b}, pc{c};
+		succeeded &= matches(pa, a);
+		succeeded &= matches(pa + pb, a + b);
+		succeeded &= matches(pa - pb, a - b);
+		succeeded &= matches(pa * pc, a * c);
+		succeeded &= pa.trace() == a.trace();
+		pa.ero_subtract_scaled_row_from_r1(0, n - 1, GF1<2>{1}, n / 2);
+		a.ero_subtract_scaled_row_from_r1(0, n - 1, GF1<2>{1}, n / 2);
+		pa.ero_swap(0, n - 1);
+		a.ero_swap(0, n - 1);
+		pa.ero_scale(n / 2, GF1<2>{0}, n / 3);
+		a.ero_scale(n / 2, GF1<2>{0}, n / 3);
+		succeeded &= matches(pa, a);
+		pa(n - 1, n + 2) = GF1<2>{1};
+		a(n - 1, n + 2) = GF1<2>{1};
+		succeeded &= matches(pa, a);
+	}
+	std::cout << "Matrix_GF2 arithmetic and row operations";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void test_inverse_and_rref() {
+	uint64_t seed = 31337;
+	bool succeeded = true;
+	for (size_t n : {1, 2, 7, 8, 9, 33, 64, 65, 100, 200}) {
+		auto a = random_invertible(n, seed);
+		Matrix_GF2 pa{a};
+		Matrix_GF2 identity{GF1<2>{0}, n};
+		identity.to_identity();
+		Matrix_GF2 inverse = pa.inv();
+		succeeded &= inverse * pa == identity && pa * inverse == identity;
+		succeeded &= matches(inverse, a.inv());
+		succeeded &= pa.rank() == n;
+		succeeded &= (pa^-3) * (pa^3) == identity;
+
+		// [A | B] reduces to [I | A^-1 B].
+		auto b = random_matrix(n, n, seed);
+		Matrix<GF1<2>> augmented{GF1<2>{0}, n, 2 * n};
+		for (size_t row = 0; row < n; row++) {
+			for (size_t col = 0; col < n; col++) {
+				augmented(row, col) = a(row, col);
+				augmented(row, n + col) = b(row, col);
+			}
+		}
+		succeeded &= matches(Matrix_GF2{augmented}.rref(), augmented.rref());
+	}
+	std::cout << "Matrix_GF2 inverses and rref";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void test_singular() {
+	uint64_t seed = 2718;
+	bool succeeded = true;
+	// Rank r matrices as invertible * (first r rows of I) * invertible.
+	for (size_t r : {0, 1, 5, 50, 99}) {
+		size_t n = 100;
+		Matrix_GF2 m{GF1<2>{0}, n};
+		if (r > 0) {
+			Matrix_GF2 left{random_invertible(n, seed)}, right{random_invertible(n, seed)};
+			Matrix_GF2 projection{GF1<2>{0}, n};
+			for (size_t i = 0; i < r; i++) {
+				projection(i, i) = GF1<2>{1};
+			}
+			m = left * projection * right;
+		}
+		succeeded &= m.rank() == r;
+		try {
+			m.inv();
+			succeeded = false;
+		} catch (const std::domain_error&) {}
+		// Every row of the rref after the first r has to be zero.
+		Matrix_GF2 reduced = m.rref();
+		succeeded &= reduced.rank() == r;
+		for (size_t row = r; row < n; row++) {
+			for (size_t col = 0; col < n; col++) {
+				succeeded &= reduced(row, col) == GF1<2>{0};
+			}
+		}
+	}
+	std::cout << "Matrix_GF2 rank and rref of singular matrices";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void time_against_matrix(size_t n) {
+	uint64_t seed = 99;
+	auto a = random_invertible(n, seed);
+	auto b = random_matrix(n, n, seed);
+	Matrix_GF2 pa{a}, pb{b};
+	std::string size = std::to_string(n) + "x" + std::to_string(n);
+	std::string names[4] = {
+		"Multiplying " + size + " Matrix<GF1<2>>",
+		"Multiplying " + size + " Matrix_GF2",
+		"Inverting " + size + " Matrix<GF1<2>>",
+		"Inverting " + size + " Matrix_GF2"
+	};
+	Matrix<GF1<2>> product{GF1<2>{0}, n}, inverse{GF1<2>{0}, n};
+	Matrix_GF2 packed_product{GF1<2>{0}, n}, packed_inverse{GF1<2>{0}, n};
+	{
+		Timer t(names[0].c_str());
+		product = a * b;
+	}
+	{
+		Timer t(names[1].c_str());
+		packed_product = pa * pb;
+	}
+	{
+		Timer t(names[2].c_str());
+		inverse = a.inv();
+	}
+	{
+		Timer t(names[3].c_str());
+		packed_inverse = pa.inv();
+	}
+	bool succeeded = matches(packed_product, product) && matches(packed_inverse, inverse);
+	std::cout << "Matrix_GF2 matching Matrix<GF1<2>> for " << size;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_arithmetic();
+	test_inverse_and_rref();
+	test_singular();
+	time_against_matrix(512);
+	return 0;
+}
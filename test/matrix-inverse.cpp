@@ -12,7 +12,9 @@ int main() {
 	std::cout << "--------------------------------------------------------------------------------\n";
 	Polynomial<GF1<5>> irreducible_poly{{1, 4, 3, 1}};
 	GF<5> a{irreducible_poly, {{3, 2, 1}}};
-	auto b = a.inv();
-	std::cout << (a * b).get_val().get_val();
+	// GF<p> inverts with the extended Euclidean algorithm now, so invert the
+	// matrix directly to see the steps.
+	auto b = a.get_val().get_val().inv();
+	std::cout << a.get_val().get_val() * b;
 	return 0;
 }
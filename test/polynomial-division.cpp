@@ -0,0 +1,201 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+template<typename R>
+bool check_divmod(const Polynomial<R>& a, const Polynomial<R>& b) {
+	auto [q, r] = divmod(a, b);
+	bool succeeded = (q * b + r).to_vector() == a.to_vector();
+	succeeded &= r.get_coeffs().size() < b.get_coeffs().size();
+	succeeded &= (a / b).to_vector() == q.to_vector();
+	succeeded &= (a % b).to_vector() == r.to_vector();
+	return succeeded;
+}
+
+// Sizes on both sides of POLYNOMIAL_NEWTON_DIVISION_THRESHOLD, and of four
+// times it, for the quotient and the divisor.
+template<uint32_t p>
+void test_divmod(const std::string& name) {
+	const size_t sizes[] = {1, 2, 10, 255, 256, 257, 1023, 1024, 1300};
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t b_size : sizes) {
+		for (size_t q_size : sizes) {
+			Polynomial<GF1<p>> b = random_full_poly<p>(b_size, seed);
+			Polynomial<GF1<p>> q = random_full_poly<p>(q_size, seed);
+			Polynomial<GF1<p>> r = random_full_poly<p>(b_size - 1, seed);
+			Polynomial<GF1<p>> a = q * b + r;
+			succeeded &= check_divmod(a, b);
+			auto [q2, r2] = divmod(a, b);
+			succeeded &= q2.to_vector() == q.to_vector() && r2.to_vector() == r.to_vector();
+			// Dividing something smaller just gives it back.
+			succeeded &= check_divmod(r, b);
+		}
+	}
+	Polynomial<GF1<p>> a = random_full_poly<p>(100, seed);
+	Polynomial<GF1<p>> b = random_full_poly<p>(40, seed);
+	Polynomial<GF1<p>> c{ a };
+	c /= b;
+	succeeded &= c.to_vector() == (a / b).to_vector();
+	c = a;
+	c %= b;
+	succeeded &= c.to_vector() == (a % b).to_vector();
+	// Trailing zeros on the divisor don't count.
+	std::vector<GF1<p>> padded = b.to_vector();
+	padded.push_back(GF1<p>{0});
+	succeeded &= (a % Polynomial<GF1<p>>{padded}).to_vector() == (a % b).to_vector();
+	std::cout << "Dividing polynomials over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// GF<p> and float coefficients, neither of which has GF1's accumulator.
+void test_other_fields() {
+	Polynomial<GF1<5>> irreducible{{1, 4, 3, 1}};
+	using F = GF<5, GF_Poly<5>>;
+	uint64_t seed = 12345;
+	auto random_f = [&]() {
+		return F{irreducible, {{next_random(seed) % 5, next_random(seed) % 5, next_random(seed) % 5}}};
+	};
+	bool succeeded = true;
+	for (size_t sizes : {3, 20, 300}) {
+		std::vector<F> a_coeffs, b_coeffs;
+		for (size_t i = 0; i < 2 * sizes; i++) {
+			a_coeffs.push_back(random_f());
+		}
+		for (size_t i = 0; i < sizes; i++) {
+			b_coeffs.push_back(random_f());
+		}
+		a_coeffs.back() = b_coeffs.back() = one<F>(&irreducible);
+		succeeded &= check_divmod(Polynomial<F>{a_coeffs}, Polynomial<F>{b_coeffs});
+	}
+	// (x^3 - 2x + 5) = (x - 3)(x^2 + 3x + 7) + 26
+	Polynomial<double> a{{5, -2, 0, 1}};
+	Polynomial<double> b{{-3, 1}};
+	auto [q, r] = divmod(a, b);
+	succeeded &= q.to_vector() == std::vector<double>{7, 3, 1};
+	succeeded &= r.to_vector() == std::vector<double>{26};
+	std::cout << "Dividing polynomials over GF(5^3) and doubles";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void test_inverse_series() {
+	uint64_t seed = 99;
+	bool succeeded = true;
+	for (size_t n : {1, 5, 256, 257, 600, 3000}) {
+		Polynomial<GF1<998244353>> f = random_full_poly<998244353>(n / 2 + 3, seed);
+		f[0] = GF1<998244353>{next_random(seed) % 998244352 + 1};
+		Polynomial<GF1<998244353>> g = inverse_series(f, n);
+		std::vector<GF1<998244353>> product = (f * g).to_vector();
+		product.resize(n, GF1<998244353>{0});
+		std::vector<GF1<998244353>> identity(n, GF1<998244353>{0});
+		identity[0] = 1;
+		succeeded &= product == identity && g.get_coeffs().size() <= n;
+	}
+	try {
+		inverse_series(Polynomial<GF1<7>>{{0, 1}}, 4);
+		succeeded = false;
+	} catch (const std::domain_error&) {}
+	try {
+		Polynomial<GF1<7>>{{1, 2}} / Polynomial<GF1<7>>{{0, 0}};
+		succeeded = false;
+	} catch (const std::domain_error&) {}
+	std::cout << "Power series inverses";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// Small and large moduli, and inputs much longer than 2 deg(m), which get
+// reduced a piece at a time.
+template<uint32_t p>
+void test_poly_modulus() {
+	uint64_t seed = 4242;
+	bool succeeded = true;
+	for (size_t m_size : {size_t{2}, size_t{9}, size_t{257}, size_t{600}}) {
+		Polynomial<GF1<p>> m = random_full_poly<p>(m_size, seed);
+		Poly_Modulus<GF1<p>> modulus{ m };
+		succeeded &= modulus.degree() == m_size - 1;
+		for (size_t a_size : {size_t{1}, m_size, 2 * m_size - 1, 7 * m_size + 3}) {
+			Polynomial<GF1<p>> a = random_full_poly<p>(a_size, seed);
+			succeeded &= modulus.reduce(a).to_vector() == (a % m).to_vector();
+			auto [q, r] = modulus.divmod(a);
+			succeeded &= q.to_vector() == (a / m).to_vector() && r.to_vector() == (a % m).to_vector();
+		}
+		Polynomial<GF1<p>> a = random_full_poly<p>(m_size - 1, seed);
+		Polynomial<GF1<p>> b = random_full_poly<p>(m_size - 1, seed);
+		succeeded &= modulus.mul_mod(a, b).to_vector() == ((a * b) % m).to_vector();
+		Polynomial<GF1<p>> power = modulus.reduce(Polynomial<GF1<p>>{{1}});
+		for (size_t i = 0; i < 13; i++) {
+			power = (power * a) % m;
+		}
+		succeeded &= modulus.pow_mod(a, 13).to_vector() == power.to_vector();
+	}
+	std::cout << "Reducing with Poly_Modulus over GF(" << p << ")";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void time_division(size_t n, size_t iterations) {
+	constexpr uint32_t p = 998244353;
+	uint64_t seed = 7;
+	Polynomial<GF1<p>> a = random_full_poly<p>(2 * n, seed);
+	Polynomial<GF1<p>> b = random_full_poly<p>(n, seed);
+	const auto& a_coeffs = a.get_coeffs();
+	const auto& b_coeffs = b.get_coeffs();
+	std::vector<GF1<p>> q_slow, r_slow;
+	Polynomial<GF1<p>> q_fast, r_fast;
+	std::string names[3] = {
+		"Dividing " + std::to_string(2 * n) + " coefficients by " + std::to_string(n) + " with long division",
+		"Dividing " + std::to_string(2 * n) + " coefficients by " + std::to_string(n) + " with divmod",
+		"Reducing " + std::to_string(2 * n) + " coefficients by " + std::to_string(n) + " with Poly_Modulus"
+	};
+	{
+		Timer t(names[0].c_str());
+		for (size_t i = 0; i < iterations; i++) {
+			Polynomial_Divider<GF1<p>>::schoolbook(
+				a_coeffs.data(), a_coeffs.size(), b_coeffs.data(), b_coeffs.size(),
+				cherry::inv(b_coeffs.back()), q_slow, r_slow
+			);
+		}
+	}
+	{
+		Timer t(names[1].c_str());
+		for (size_t i = 0; i < iterations; i++) {
+			std::tie(q_fast, r_fast) = divmod(a, b);
+		}
+	}
+	Poly_Modulus<GF1<p>> modulus{ b };
+	Polynomial<GF1<p>> r_modulus;
+	{
+		Timer t(names[2].c_str());
+		for (size_t i = 0; i < iterations; i++) {
+			r_modulus = modulus.reduce(a);
+		}
+	}
+	while (!r_slow.empty() && r_slow.back() == GF1<p>{0}) {
+		r_slow.pop_back();
+	}
+	bool succeeded = q_slow == q_fast.to_vector() && r_slow == r_fast.to_vector();
+	succeeded &= r_modulus.to_vector() == r_slow;
+	std::cout << "Every way of dividing matching";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_divmod<65521>("GF(65521)");
+	test_divmod<998244353>("GF(998244353)");
+	test_divmod<2>("GF(2)");
+	test_other_fields();
+	test_inverse_series();
+	test_poly_modulus<65521>();
+	test_poly_modulus<998244353>();
+	time_division(1000, 20);
+	time_division(10000, 2);
+	return 0;
+}
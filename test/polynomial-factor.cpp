@@ -0,0 +1,264 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+template<typename R>
+Polynomial<R> multiply_out(const std::vector<std::pair<Polynomial<R>, size_t>>& factors, const Polynomial<R>& start) {
+	Polynomial<R> out{ start };
+	for (const auto& [factor, multiplicity] : factors) {
+		for (size_t i = 0; i < multiplicity; i++) {
+			out *= factor;
+		}
+	}
+	return out;
+}
+
+// Trial division by every monic polynomial of degree at most half of f's,
+// which is only quick for tiny fields. Bigger ones just check that factoring
+// f again doesn't split it.
+template<uint32_t p>
+bool is_irreducible(const Polynomial<GF1<p>>& f) {
+	if (p > 5) {
+		auto factors = factor(f);
+		return factors.size() == 1 && factors[0].second == 1;
+	}
+	size_t n = f.degree();
+	for (size_t d = 1; 2 * d <= n; d++) {
+		uint64_t count = 1;
+		for (size_t i = 0; i < d; i++) {
+			count *= p;
+		}
+		for (uint64_t index = 0; index < count; index++) {
+			std::vector<GF1<p>> coeffs;
+			uint64_t digits = index;
+			for (size_t i = 0; i < d; i++) {
+				coeffs.emplace_back(digits % p);
+				digits /= p;
+			}
+			coeffs.emplace_back(1);
+			if ((f % Polynomial<GF1<p>>{coeffs}).get_coeffs().empty()) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Products of small random polynomials, some of them repeated, including
+// multiplicities that are multiples of p.
+template<uint32_t p>
+void test_small_field() {
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t trial = 0; trial < 60; trial++) {
+		Polynomial<GF1<p>> f{{ 3 % p == 0 ? 1 : 3 }};
+		size_t pieces = 1 + next_random(seed) % 4;
+		for (size_t i = 0; i < pieces; i++) {
+			Polynomial<GF1<p>> piece = random_monic<p>(1 + next_random(seed) % 5, seed);
+			size_t power = 1 + next_random(seed) % std::min<uint64_t>(p + 2, 7);
+			for (size_t j = 0; j < power; j++) {
+				f *= piece;
+			}
+		}
+		auto factors = factor(f);
+		succeeded &= multiply_out(factors, Polynomial<GF1<p>>{{ f.get_coeffs().back() }}).to_vector() == f.to_vector();
+		for (size_t i = 0; i < factors.size(); i++) {
+			succeeded &= is_irreducible(factors[i].first) && factors[i].first.get_coeffs().back() == GF1<p>{1};
+			// Irreducible factors past degree 1 don't have any roots.
+			succeeded &= factors[i].first.degree() == 1 || roots(factors[i].first).empty();
+			succeeded &= i == 0 || factors[i - 1].first.degree() <= factors[i].first.degree();
+			for (size_t j = 0; j < i; j++) {
+				succeeded &= factors[i].first.to_vector() != factors[j].first.to_vector();
+			}
+		}
+	}
+	std::cout << "Factoring products of small polynomials over GF(" << p << ")";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// x^(p^k) - x is the product of every monic irreducible polynomial whose
+// degree divides k, and there are (1 / d) sum over e | d of mu(d / e) p^e of
+// them with degree d.
+template<uint32_t p>
+void test_field_polynomial(size_t k, const std::vector<size_t>& irreducible_counts) {
+	uint64_t q = 1;
+	for (size_t i = 0; i < k; i++) {
+		q *= p;
+	}
+	std::vector<GF1<p>> coeffs(q + 1, GF1<p>{0});
+	coeffs[q] = 1;
+	coeffs[1] = -GF1<p>{1};
+	auto factors = factor(Polynomial<GF1<p>>{coeffs});
+	std::vector<size_t> counts(k + 1, 0);
+	bool succeeded = true;
+	for (const auto& [f, multiplicity] : factors) {
+		succeeded &= multiplicity == 1 && k % f.degree() == 0;
+		counts[f.degree()]++;
+	}
+	succeeded &= counts == irreducible_counts;
+	std::cout << "Factoring x^(" << p << "^" << k << ") - x";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// A random polynomial over a big prime field, which goes through
+// Cantor-Zassenhaus instead of Berlekamp.
+void test_large_prime() {
+	constexpr uint32_t p = 998244353;
+	uint64_t seed = 1234;
+	bool succeeded = true;
+	for (size_t degree : {1, 2, 20, 150}) {
+		Polynomial<GF1<p>> f = random_monic<p>(degree, seed);
+		Polynomial<GF1<p>> g = random_monic<p>(degree / 2 + 1, seed);
+		Polynomial<GF1<p>> h = f * g * g * Polynomial<GF1<p>>{{5, 1}} * Polynomial<GF1<p>>{{7, 1}};
+		auto factors = factor(h);
+		succeeded &= multiply_out(factors, Polynomial<GF1<p>>{{1}}).to_vector() == h.to_vector();
+		for (const auto& [factor, multiplicity] : factors) {
+			// Irreducible means no further split, and a linear factor means a root.
+			succeeded &= cherry::factor(factor).size() == 1;
+			if (factor.degree() == 1) {
+				succeeded &= (h % factor).get_coeffs().empty();
+			}
+		}
+		std::vector<GF1<p>> found = roots(h);
+		succeeded &= std::count(found.begin(), found.end(), GF1<p>{p - 5}) == 1;
+		succeeded &= std::count(found.begin(), found.end(), GF1<p>{p - 7}) == 1;
+		for (const GF1<p>& root : found) {
+			succeeded &= h.eval(root) == GF1<p>{0};
+		}
+	}
+	try {
+		factor(Polynomial<GF1<p>>{{0, 0}});
+		succeeded = false;
+	} catch (const std::domain_error&) {}
+	succeeded &= factor(Polynomial<GF1<p>>{{4}}).empty() && roots(Polynomial<GF1<p>>{{4}}).empty();
+	// 3 generates GF(p)*, so it isn't a square and x^2 - 3 has no roots.
+	Polynomial<GF1<p>> no_roots{{p - 3, 0, 1}};
+	succeeded &= roots(no_roots).empty();
+	succeeded &= roots(no_roots * Polynomial<GF1<p>>{{5, 1}}).size() == 1;
+	std::cout << "Factoring polynomials over GF(" << p << ")";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// An irreducible polynomial over GF(p) splits into n linear factors over
+// GF(p^n), and every element of GF(q) is a root of x^q - x (which only gets
+// checked when that's not too many roots).
+template<uint32_t p, typename Repr>
+void test_extension_field(const Polynomial<GF1<p>>& irreducible, const std::string& name) {
+	using F = GF<p, Repr>;
+	size_t n = irreducible.degree();
+	std::vector<F> lifted;
+	for (const auto& c : irreducible.get_coeffs()) {
+		lifted.emplace_back(irreducible, Polynomial<GF1<p>>{{ c }});
+	}
+	Polynomial<F> f{ lifted };
+	auto factors = factor(f);
+	bool succeeded = factors.size() == n;
+	for (const auto& [factor, multiplicity] : factors) {
+		succeeded &= factor.degree() == 1 && multiplicity == 1;
+	}
+	Polynomial<F> product = multiply_out(factors, Polynomial<F>{{ one<F>(&irreducible) }});
+	succeeded &= product.to_vector() == f.to_vector();
+	uint64_t q = 1;
+	for (size_t i = 0; i < n; i++) {
+		q *= p;
+	}
+	if (q <= 1000) {
+		std::vector<F> field_poly(q + 1, zero<F>(&irreducible));
+		field_poly[q] = one<F>(&irreducible);
+		field_poly[1] = -one<F>(&irreducible);
+		succeeded &= roots(Polynomial<F>{field_poly}).size() == q;
+	}
+	// (x^2 - x)^p (x - 1) has to go through a pth root.
+	Polynomial<F> x_minus_one{{ -one<F>(&irreducible), one<F>(&irreducible) }};
+	Polynomial<F> x{{ zero<F>(&irreducible), one<F>(&irreducible) }};
+	Polynomial<F> g = x_minus_one;
+	for (size_t i = 0; i < p; i++) {
+		g *= x * x_minus_one;
+	}
+	factors = factor(g);
+	succeeded &= factors.size() == 2;
+	succeeded &= factors[0].second + factors[1].second == 2 * p + 1;
+	std::cout << "Factoring polynomials over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// The roots of x^3 + 4x^2 + 2x + 3 in GF(5^6), the way vietas-formulas.cpp
+// used to find them and with roots.
+void time_roots() {
+	Polynomial<GF1<5>> irreducible{{1, 4, 2, 3, 3, 4, 1}};
+	using F = GF<5, GF_Mat<5>>;
+	std::vector<F> lifted;
+	for (uint64_t c : {3, 2, 4, 1}) {
+		lifted.emplace_back(irreducible, Polynomial<GF1<5>>{{ c }});
+	}
+	Polynomial<F> f{ lifted };
+	std::vector<F> slow, fast;
+	{
+		Timer t("Finding roots in GF(5^6) by trying every element");
+		std::vector<GF1<5>> coeffs(6, GF1<5>{0});
+		for (uint64_t i = 0; i < 15625; i++) {
+			uint64_t digits = i;
+			for (auto& c : coeffs) {
+				c = digits % 5;
+				digits /= 5;
+			}
+			F candidate{irreducible, Polynomial<GF1<5>>{coeffs}};
+			if (f.eval(candidate, &irreducible) == zero<F>(&irreducible)) {
+				slow.push_back(candidate);
+			}
+		}
+	}
+	{
+		Timer t("Finding roots in GF(5^6) with roots");
+		fast = roots(f);
+	}
+	bool succeeded = slow.size() == fast.size();
+	for (const F& root : fast) {
+		succeeded &= std::count(slow.begin(), slow.end(), root) == 1;
+	}
+	std::cout << "Both ways of finding roots matching";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void time_factoring(size_t degree) {
+	constexpr uint32_t p = 998244353;
+	uint64_t seed = 99;
+	Polynomial<GF1<p>> f = random_monic<p>(degree, seed);
+	std::string name = "Factoring a random polynomial of degree " + std::to_string(degree) + " over GF(998244353)";
+	std::vector<std::pair<Polynomial<GF1<p>>, size_t>> factors;
+	{
+		Timer t(name.c_str());
+		factors = factor(f);
+	}
+	std::cout << "Multiplying the factors back together";
+	std::cout << (multiply_out(factors, Polynomial<GF1<p>>{{1}}).to_vector() == f.to_vector() ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_small_field<2>();
+	test_small_field<3>();
+	test_small_field<5>();
+	test_small_field<65521>();
+	test_field_polynomial<2>(4, {0, 2, 1, 0, 3});
+	test_field_polynomial<3>(6, {0, 3, 3, 8, 0, 0, 116});
+	test_field_polynomial<5>(2, {0, 5, 10});
+	test_large_prime();
+	test_extension_field<5, GF_Poly<5>>({{1, 4, 3, 1}}, "GF(5^3)");
+	test_extension_field<5, GF_Mat<5>>({{1, 4, 2, 3, 3, 4, 1}}, "GF(5^6)");
+	test_extension_field<2, GF_Poly<2>>({{1, 1, 0, 1, 1, 0, 0, 0, 1}}, "GF(2^8)");
+	test_extension_field<3, GF_Log<3>>({{1, 2, 0, 1}}, "GF(3^3) in log form");
+	time_roots();
+	time_factoring(200);
+	time_factoring(1000);
+	return 0;
+}
@@ -0,0 +1,184 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace cherry;
+
+// The Euclidean algorithm straight from the definition, made monic.
+template<typename R>
+Polynomial<R> naive_gcd(Polynomial<R> a, Polynomial<R> b) {
+	while (!b.get_coeffs().empty()) {
+		Polynomial<R> r = a % b;
+		a = std::move(b);
+		b = std::move(r);
+	}
+	if (!a.get_coeffs().empty()) {
+		a *= cherry::inv(a.get_coeffs().back());
+	}
+	return a;
+}
+
+template<typename R>
+bool check_xgcd(const Polynomial<R>& a, const Polynomial<R>& b) {
+	auto [g, s, t] = xgcd(a, b);
+	bool succeeded = g.to_vector() == naive_gcd(a, b).to_vector();
+	succeeded &= g.to_vector() == gcd(a, b).to_vector();
+	succeeded &= (s * a + t * b).to_vector() == g.to_vector();
+	size_t na = a.get_coeffs().size();
+	size_t nb = b.get_coeffs().size();
+	size_t ng = g.get_coeffs().size();
+	if (na > ng && nb > ng) {
+		succeeded &= s.get_coeffs().size() < nb - ng + 1;
+		succeeded &= t.get_coeffs().size() < na - ng + 1;
+	}
+	return succeeded;
+}
+
+// Sizes on both sides of POLYNOMIAL_HALF_GCD_THRESHOLD, with a common factor
+// of a few different sizes so the remainder sequence stops early.
+template<uint32_t p>
+void test_gcd(const std::string& name) {
+	const size_t sizes[] = {1, 2, 10, 127, 128, 129, 300, 1000};
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t a_size : sizes) {
+		for (size_t b_size : sizes) {
+			for (size_t common_size : {size_t{1}, size_t{3}, size_t{70}}) {
+				Polynomial<GF1<p>> common = random_full_poly<p>(common_size, seed);
+				Polynomial<GF1<p>> a = random_full_poly<p>(a_size, seed) * common;
+				Polynomial<GF1<p>> b = random_full_poly<p>(b_size, seed) * common;
+				succeeded &= check_xgcd(a, b);
+			}
+		}
+	}
+	std::cout << "GCDs of polynomials over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// Zeros, constants, and one polynomial dividing the other.
+void test_edge_cases() {
+	using P = Polynomial<GF1<7>>;
+	bool succeeded = true;
+	auto [g, s, t] = xgcd(P{}, P{});
+	succeeded &= g.get_coeffs().empty() && s.get_coeffs().empty() && t.get_coeffs().empty();
+	P a{{3, 0, 2}};
+	std::tie(g, s, t) = xgcd(a, P{});
+	succeeded &= g.to_vector() == P{{5, 0, 1}}.to_vector();
+	succeeded &= (s * a).to_vector() == g.to_vector() && t.get_coeffs().empty();
+	std::tie(g, s, t) = xgcd(P{}, a);
+	succeeded &= g.to_vector() == P{{5, 0, 1}}.to_vector() && (t * a).to_vector() == g.to_vector();
+	succeeded &= gcd(a, P{{4}}).to_vector() == P{{1}}.to_vector();
+	succeeded &= gcd(a * P{{1, 1}}, a).to_vector() == P{{5, 0, 1}}.to_vector();
+	succeeded &= check_xgcd(a * P{{1, 1}}, a) && check_xgcd(a, a);
+	// Trailing zeros don't count.
+	succeeded &= gcd(P{{0, 1, 0, 0}}, P{{0, 0, 1}}).to_vector() == P{{0, 1}}.to_vector();
+	std::cout << "GCDs of zeros, constants and multiples";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// GF<p> coefficients, which don't have GF1's accumulator.
+void test_extension_field() {
+	Polynomial<GF1<5>> irreducible{{1, 4, 3, 1}};
+	using F = GF<5, GF_Poly<5>>;
+	uint64_t seed = 31337;
+	auto random_f = [&](size_t n) {
+		std::vector<F> coeffs;
+		for (size_t i = 0; i < n; i++) {
+			coeffs.push_back(F{irreducible, {{next_random(seed) % 5, next_random(seed) % 5, next_random(seed) % 5}}});
+		}
+		coeffs.back() = one<F>(&irreducible);
+		return Polynomial<F>{coeffs};
+	};
+	bool succeeded = true;
+	for (size_t n : {2, 20, 200}) {
+		Polynomial<F> common = random_f(n / 2 + 1);
+		succeeded &= check_xgcd(random_f(n) * common, random_f(n + 5) * common);
+	}
+	std::cout << "GCDs of polynomials over GF(5^3)";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+template<uint32_t p>
+void test_inverse_mod() {
+	uint64_t seed = 2718;
+	bool succeeded = true;
+	for (size_t m_size : {2, 10, 200, 1500}) {
+		Polynomial<GF1<p>> m = random_full_poly<p>(m_size, seed);
+		Polynomial<GF1<p>> a = random_full_poly<p>(m_size + 7, seed);
+		if (naive_gcd(a, m).get_coeffs().size() != 1) {
+			continue;
+		}
+		Polynomial<GF1<p>> a_inv = inverse_mod(a, m);
+		succeeded &= a_inv.get_coeffs().size() < m.get_coeffs().size();
+		succeeded &= ((a * a_inv) % m).to_vector() == Polynomial<GF1<p>>{{1}}.to_vector();
+		try {
+			inverse_mod(a * m, m * m);
+			succeeded = false;
+		} catch (const std::domain_error&) {}
+	}
+	try {
+		inverse_mod(Polynomial<GF1<p>>{{1, 1}}, Polynomial<GF1<p>>{});
+		succeeded = false;
+	} catch (const std::domain_error&) {}
+	std::cout << "Inverses mod polynomials over GF(" << p << ")";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void time_gcd(size_t n, size_t iterations) {
+	constexpr uint32_t p = 998244353;
+	uint64_t seed = 7;
+	Polynomial<GF1<p>> common = random_full_poly<p>(n / 10, seed);
+	Polynomial<GF1<p>> a = random_full_poly<p>(n, seed) * common;
+	Polynomial<GF1<p>> b = random_full_poly<p>(n - 1, seed) * common;
+	Polynomial<GF1<p>> slow, fast;
+	std::tuple<Polynomial<GF1<p>>, Polynomial<GF1<p>>, Polynomial<GF1<p>>> extended;
+	std::string size = std::to_string(a.get_coeffs().size());
+	std::string names[3] = {
+		"GCD of two polynomials with about " + size + " coefficients with the Euclidean algorithm",
+		"GCD of two polynomials with about " + size + " coefficients with gcd",
+		"GCD of two polynomials with about " + size + " coefficients with xgcd"
+	};
+	{
+		Timer t(names[0].c_str());
+		for (size_t i = 0; i < iterations; i++) {
+			slow = naive_gcd(a, b);
+		}
+	}
+	{
+		Timer t(names[1].c_str());
+		for (size_t i = 0; i < iterations; i++) {
+			fast = gcd(a, b);
+		}
+	}
+	{
+		Timer t(names[2].c_str());
+		for (size_t i = 0; i < iterations; i++) {
+			extended = xgcd(a, b);
+		}
+	}
+	bool succeeded = slow.to_vector() == fast.to_vector();
+	succeeded &= std::get<0>(extended).to_vector() == fast.to_vector();
+	std::cout << "Every way of finding the GCD matching";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_gcd<998244353>("GF(998244353)");
+	test_gcd<65521>("GF(65521)");
+	test_gcd<2>("GF(2)");
+	test_edge_cases();
+	test_extension_field();
+	test_inverse_mod<998244353>();
+	test_inverse_mod<3>();
+	time_gcd(1000, 10);
+	time_gcd(10000, 1);
+	return 0;
+}
@@ -0,0 +1,154 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+// The schoolbook product the long way, straight from the coefficients.
+template<uint32_t p>
+std::vector<GF1<p>> naive_product(const Polynomial<GF1<p>>& a, const Polynomial<GF1<p>>& b) {
+	const auto& a_coeffs = a.get_coeffs();
+	const auto& b_coeffs = b.get_coeffs();
+	if (a_coeffs.empty() || b_coeffs.empty()) {
+		return {};
+	}
+	std::vector<GF1<p>> out(a_coeffs.size() + b_coeffs.size() - 1, GF1<p>{0});
+	for (size_t i = 0; i < a_coeffs.size(); i++) {
+		for (size_t j = 0; j < b_coeffs.size(); j++) {
+			out[i + j] += a_coeffs[i] * b_coeffs[j];
+		}
+	}
+	while (!out.empty() && out.back() == GF1<p>{0}) {
+		out.pop_back();
+	}
+	return out;
+}
+
+// Compound operators and multiply_into against the operators that make new
+// polynomials, including when the output is one of the inputs and when the
+// result is too big to stay inline.
+void test_in_place(size_t iterations) {
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	Polynomial<GF1<65521>> out;
+	for (size_t i = 0; i < iterations; i++) {
+		Polynomial<GF1<65521>> a = random_poly<65521>(next_random(seed) % 40, seed);
+		Polynomial<GF1<65521>> b = random_poly<65521>(next_random(seed) % 40, seed);
+		Polynomial<GF1<65521>> sum = a + b;
+		Polynomial<GF1<65521>> difference = a - b;
+		Polynomial<GF1<65521>> product = a * b;
+		succeeded &= product.to_vector() == naive_product(a, b);
+		succeeded &= (sum - b).to_vector() == a.to_vector();
+		succeeded &= (difference + b).to_vector() == a.to_vector();
+		multiply_into(out, a, b);
+		succeeded &= out.to_vector() == product.to_vector();
+		Polynomial<GF1<65521>> c{ a };
+		c += b;
+		succeeded &= c.to_vector() == sum.to_vector();
+		c = a;
+		c -= b;
+		succeeded &= c.to_vector() == difference.to_vector();
+		c = a;
+		c *= b;
+		succeeded &= c.to_vector() == product.to_vector();
+		c = a;
+		multiply_into(c, c, c);
+		succeeded &= c.to_vector() == naive_product(a, a);
+		c = a;
+		c -= c;
+		succeeded &= c.get_coeffs().empty();
+	}
+	std::cout << "In-place polynomial arithmetic over GF(65521)";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// GF<p> can't make a zero without the irreducible polynomial, so adding
+// polynomials over it used to be off limits.
+void test_without_zero() {
+	Polynomial<GF1<5>> irreducible{{1, 4, 3, 1}};
+	using F = GF<5, GF_Poly<5>>;
+	F a{irreducible, {{1, 2}}};
+	F b{irreducible, {{3, 0, 4}}};
+	Polynomial<F> f{{a, b}};
+	Polynomial<F> g{{b, a, a}};
+	Polynomial<F> sum = f + g;
+	Polynomial<F> difference = f - f;
+	Polynomial<F> product = f * g;
+	bool succeeded = sum.get_coeffs().size() == 3;
+	succeeded &= sum.get_coeffs()[0] == a + b && sum.get_coeffs()[2] == a;
+	succeeded &= difference.get_coeffs().empty();
+	succeeded &= product.get_coeffs().size() == 4;
+	succeeded &= product.get_coeffs()[1] == a * a + b * b;
+	std::cout << "Adding and multiplying polynomials over GF<5, GF_Poly<5>>";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+void test_small_vector() {
+	Small_Vector<std::string, 2> v;
+	bool succeeded = v.is_inline() && v.capacity() == 2;
+	v.push_back("a");
+	v.push_back("b");
+	succeeded &= v.is_inline();
+	v.push_back(v[0]);
+	succeeded &= !v.is_inline() && v.size() == 3 && v[2] == "a";
+	Small_Vector<std::string, 2> moved{ std::move(v) };
+	succeeded &= v.empty() && v.is_inline() && moved.size() == 3;
+	Small_Vector<std::string, 2> small{ "x" };
+	Small_Vector<std::string, 2> small_moved{ std::move(small) };
+	succeeded &= small_moved.is_inline() && small_moved[0] == "x";
+	small_moved.swap(moved);
+	succeeded &= small_moved.size() == 3 && moved.size() == 1 && moved[0] == "x";
+	moved.resize(4, "y");
+	succeeded &= moved.size() == 4 && moved.back() == "y";
+	moved.resize(1);
+	succeeded &= moved.size() == 1 && moved == Small_Vector<std::string, 2>{ "x" };
+	try {
+		moved.at(1);
+		succeeded = false;
+	} catch (const std::out_of_range&) {}
+	std::cout << "Small_Vector storage";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// Multiplying degree 5 polynomials over and over, the way GF(p^6) does.
+void time_multiply_into(size_t iterations) {
+	uint64_t seed = 7;
+	std::vector<Polynomial<GF1<5>>> as, bs;
+	for (size_t i = 0; i < 64; i++) {
+		as.push_back(random_poly<5>(6, seed));
+		bs.push_back(random_poly<5>(6, seed));
+	}
+	Polynomial<GF1<5>> total_new;
+	Polynomial<GF1<5>> total_into;
+	{
+		Timer t("Multiplying small polynomials with operator*");
+		for (size_t i = 0; i < iterations; i++) {
+			total_new += as[i % 64] * bs[(i / 64) % 64];
+		}
+	}
+	{
+		Timer t("Multiplying small polynomials with multiply_into");
+		Polynomial<GF1<5>> product;
+		for (size_t i = 0; i < iterations; i++) {
+			multiply_into(product, as[i % 64], bs[(i / 64) % 64]);
+			total_into += product;
+		}
+	}
+	std::cout << "Both ways of multiplying small polynomials matching";
+	std::cout << (total_new.to_vector() == total_into.to_vector() ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_in_place(500);
+	test_without_zero();
+	test_small_vector();
+	time_multiply_into(1000000);
+	return 0;
+}
@@ -0,0 +1,132 @@
+#include "../include/gf.hpp"
+#include "random-values.hpp"
+#include "simple-timer.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace cherry;
+
+template<typename R>
+std::vector<R> naive_product(const Polynomial<R>& a, const Polynomial<R>& b) {
+	const auto& a_coeffs = a.get_coeffs();
+	const auto& b_coeffs = b.get_coeffs();
+	if (a_coeffs.empty() || b_coeffs.empty()) {
+		return {};
+	}
+	R z = a_coeffs[0] - a_coeffs[0];
+	std::vector<R> out(a_coeffs.size() + b_coeffs.size() - 1, z);
+	for (size_t i = 0; i < a_coeffs.size(); i++) {
+		for (size_t j = 0; j < b_coeffs.size(); j++) {
+			out[i + j] += a_coeffs[i] * b_coeffs[j];
+		}
+	}
+	while (!out.empty() && out.back() == z) {
+		out.pop_back();
+	}
+	return out;
+}
+
+// Sizes on both sides of both thresholds, balanced and not.
+template<typename R>
+void test_against_schoolbook(uint64_t modulus, const std::string& name) {
+	const size_t sizes[] = {1, 2, 7, 31, 32, 33, 63, 100, 255, 256, 257, 700, 1000};
+	uint64_t seed = 0x9e3779b97f4a7c15;
+	bool succeeded = true;
+	for (size_t a_size : sizes) {
+		for (size_t b_size : sizes) {
+			Polynomial<R> a = random_full_poly<R>(a_size, seed, modulus);
+			Polynomial<R> b = random_full_poly<R>(b_size, seed, modulus);
+			succeeded &= (a * b).to_vector() == naive_product(a, b);
+		}
+	}
+	std::cout << "Karatsuba and Toom-3 matching schoolbook over " << name;
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+// Polynomials over GF(5^3), where the coefficients can't make their own
+// zeros, and over 2 x 2 matrices, where they don't commute.
+void test_other_rings() {
+	Polynomial<GF1<5>> irreducible{{1, 4, 3, 1}};
+	using F = GF<5, GF_Poly<5>>;
+	uint64_t seed = 12345;
+	auto random_f = [&]() {
+		return F{irreducible, {{next_random(seed) % 5, next_random(seed) % 5, next_random(seed) % 5}}};
+	};
+	std::vector<F> a_coeffs, b_coeffs;
+	for (size_t i = 0; i < 300; i++) {
+		a_coeffs.push_back(random_f());
+	}
+	for (size_t i = 0; i < 280; i++) {
+		b_coeffs.push_back(random_f());
+	}
+	a_coeffs.back() = b_coeffs.back() = one<F>(&irreducible);
+	Polynomial<F> a{a_coeffs}, b{b_coeffs};
+	bool succeeded = (a * b).to_vector() == naive_product(a, b);
+
+	auto random_matrix = [&]() {
+		Matrix<GF1<7>> out{GF1<7>{0}, 2};
+		for (size_t i = 0; i < 2; i++) {
+			for (size_t j = 0; j < 2; j++) {
+				out(i, j) = GF1<7>{next_random(seed) % 7};
+			}
+		}
+		return out;
+	};
+	std::vector<Matrix<GF1<7>>> c_coeffs, d_coeffs;
+	for (size_t i = 0; i < 100; i++) {
+		c_coeffs.push_back(random_matrix());
+		d_coeffs.push_back(random_matrix());
+	}
+	Matrix<GF1<7>> identity{GF1<7>{0}, 2};
+	identity.to_identity();
+	c_coeffs.back() = d_coeffs.back() = identity;
+	Polynomial<Matrix<GF1<7>>> c{c_coeffs}, d{d_coeffs};
+	succeeded &= (c * d).to_vector() == naive_product(c, d);
+	succeeded &= (d * c).to_vector() == naive_product(d, c);
+	std::cout << "Fast products over GF(5^3) and 2 x 2 matrices";
+	std::cout << (succeeded ? " succeeded!\n" : " failed!\n");
+}
+
+template<uint32_t p>
+void time_products(size_t n, size_t iterations) {
+	uint64_t seed = 7;
+	Polynomial<GF1<p>> a = random_full_poly<GF1<p>>(n, seed, p);
+	Polynomial<GF1<p>> b = random_full_poly<GF1<p>>(n, seed, p);
+	std::vector<GF1<p>> slow, fast;
+	std::string names[2] = {
+		"Multiplying polynomials with " + std::to_string(n) + " coefficients over GF(" + std::to_string(p) + ") with schoolbook",
+		"Multiplying polynomials with " + std::to_string(n) + " coefficients over GF(" + std::to_string(p) + ") with operator*"
+	};
+	{
+		Timer t(names[0].c_str());
+		for (size_t i = 0; i < iterations; i++) {
+			slow = naive_product(a, b);
+		}
+	}
+	{
+		Timer t(names[1].c_str());
+		for (size_t i = 0; i < iterations; i++) {
+			fast = (a * b).to_vector();
+		}
+	}
+	std::cout << "Both ways of multiplying matching";
+	std::cout << (slow == fast ? " succeeded!\n" : " failed!\n");
+}
+
+int main() {
+	Timer t(__FILE__);
+	std::cout << "--------------------------------------------------------------------------------\n";
+	std::cout << __FILE__ << "\n";
+	std::cout << "--------------------------------------------------------------------------------\n";
+	test_against_schoolbook<GF1<65521>>(65521, "GF(65521)");
+	test_against_schoolbook<GF1<2>>(2, "GF(2)");
+	test_against_schoolbook<GF1<3>>(3, "GF(3)");
+	test_against_schoolbook<GF1_64<18446744073709551557ull>>(18446744073709551557ull, "GF(2^64 - 59)");
+	test_other_rings();
+	time_products<65521>(64, 2000);
+	time_products<65521>(1000, 50);
+	time_products<65521>(4000, 5);
+	time_products<2>(1000, 50);
+	return 0;
+}
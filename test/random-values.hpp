@@ -0,0 +1,52 @@
+#pragma once
+#include "../include/gf.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The library's xorshift, so every run of a test sees the same values for
+// the same seed.
+using cherry::next_random;
+
+// n coefficients, each anything mod p.
+template<uint32_t p>
+std::vector<cherry::GF1<p>> random_coeffs(size_t n, uint64_t& seed) {
+	std::vector<cherry::GF1<p>> coeffs;
+	for (size_t i = 0; i < n; i++) {
+		coeffs.emplace_back(next_random(seed) % p);
+	}
+	return coeffs;
+}
+
+// The same as a polynomial, which can come out shorter once it's trimmed.
+template<uint32_t p>
+cherry::Polynomial<cherry::GF1<p>> random_poly(size_t n, uint64_t& seed) {
+	return random_coeffs<p>(n, seed);
+}
+
+// n coefficients mod modulus with a nonzero one on top, so nothing gets
+// trimmed. R has to be constructible from the integers mod modulus.
+template<typename R>
+cherry::Polynomial<R> random_full_poly(size_t n, uint64_t& seed, uint64_t modulus) {
+	std::vector<R> coeffs;
+	for (size_t i = 0; i < n; i++) {
+		coeffs.emplace_back(next_random(seed) % modulus);
+	}
+	if (n > 0) {
+		coeffs.back() = R(1 + next_random(seed) % (modulus - 1));
+	}
+	return coeffs;
+}
+
+template<uint32_t p>
+cherry::Polynomial<cherry::GF1<p>> random_full_poly(size_t n, uint64_t& seed) {
+	return random_full_poly<cherry::GF1<p>>(n, seed, p);
+}
+
+// A random monic polynomial of the given degree.
+template<uint32_t p>
+cherry::Polynomial<cherry::GF1<p>> random_monic(size_t degree, uint64_t& seed) {
+	std::vector<cherry::GF1<p>> coeffs = random_coeffs<p>(degree, seed);
+	coeffs.emplace_back(1);
+	return coeffs;
+}
@@ -10,8 +10,7 @@ public:
 	Polynomial_Test(
 		const Polynomial<GF1<p>>& poly
 	) :
-		irreducible_poly(poly),
-		zero_element(zero<GFs>(&irreducible_poly))
+		irreducible_poly(poly)
 	{}
 
 	void find_roots(const Polynomial<GF1<p>>& poly) {
@@ -19,26 +18,16 @@ public:
 		std::cout << poly << "\n"
 		"----------------------------------------\n";
 		#endif
-		roots.clear();
-		std::vector<GF1<p>> x_coeffs;
-		x_coeffs.reserve(irreducible_poly.degree());
-		uint64_t num_elements = p;
-		for (size_t i = 1; i < irreducible_poly.degree(); i++) {
-			num_elements *= p;
+		std::vector<GFs> lifted;
+		for (const auto& c : poly.get_coeffs()) {
+			lifted.emplace_back(irreducible_poly, Polynomial<GF1<p>>{{ c }});
 		}
+		roots = cherry::roots(Polynomial<GFs>{lifted});
 		#ifdef PRINT_STUFF
-		std::cout << "num_elements: " << num_elements << "\n";
-		#endif
-		for (uint64_t i = 0; i < num_elements; i++) {
-			set_coeffs(i, x_coeffs);
-			GFs x{irreducible_poly, Polynomial<GF1<p>>{x_coeffs}};
-			if (poly.eval(x, &irreducible_poly) == zero_element) {
-				roots.push_back(x);
-				#ifdef PRINT_STUFF
-				std::cout << x << "\n";
-				#endif
-			}
+		for (const auto& x : roots) {
+			std::cout << x << "\n";
 		}
+		#endif
 		#ifdef PRINT_STUFF
 		std::cout << "roots: " << roots.size() << "\n";
 		#endif
@@ -100,7 +89,6 @@ public:
 private:
 	std::vector<GFs> roots;
 	Polynomial<GF1<p>> irreducible_poly;
-	GFs zero_element;
 };
 
 int main() {